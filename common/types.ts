@@ -31,6 +31,20 @@ export interface ConfiguredComponent {
   isHoming?: boolean; // Runtime state, but can be part of config if needed
   pullMode?: number;
   debounceMs?: number;
+  interrupt?: boolean; // Digital inputs: capture edges in an ISR instead of polling
+  // Analog inputs: DMA sampling options
+  oversample?: number;
+  filter?: AnalogFilter;
+  filterWindow?: number;
+  deadband?: number;
+  adcReportIntervalMs?: number; // 0 = report on change
+  // Pulse counter inputs
+  edge?: CounterEdge;
+  glitchFilterNs?: number;
+  counterReportIntervalMs?: number; // Default 1000
+  // PWM outputs
+  frequency?: number;
+  resolution?: number;
 }
 
 /**
@@ -144,7 +158,9 @@ export interface BaseComponentConfig {
   name: string;
 }
 
-export type PinType = "digital" | "analog" | "pwm";
+export type PinType = "digital" | "analog" | "pwm" | "counter" | "frequency";
+export type AnalogFilter = "none" | "average" | "iir" | "median";
+export type CounterEdge = "rising" | "falling" | "both";
 export type PinMode = "input" | "output";
 // Assuming 0: NONE, 1: PULL_UP, 2: PULL_DOWN based on IOPinCard state and C++ enum order
 export type PullMode = 0 | 1 | 2;
@@ -156,6 +172,17 @@ export interface IoPinComponentConfig extends BaseComponentConfig {
   mode: PinMode;
   pullMode?: PullMode; // Default should be 0 (NONE) in firmware/handler
   debounceMs?: number; // Default should be 0 in firmware/handler
+  interrupt?: boolean; // Digital inputs only; default false (polled)
+  oversample?: number; // Analog inputs: raw conversions per filtered sample
+  filter?: AnalogFilter; // Analog inputs: default "none"
+  filterWindow?: number; // Average/median length, or IIR divisor
+  deadband?: number; // Analog inputs: minimum change to report (default 10)
+  adcReportIntervalMs?: number; // Analog inputs: fixed report period, 0 = on change (default)
+  edge?: CounterEdge; // Counter/frequency inputs: edges counted (default rising)
+  glitchFilterNs?: number; // Counter/frequency inputs: pulses shorter are ignored
+  counterReportIntervalMs?: number; // Counter/frequency inputs: report period (default 1000)
+  frequency?: number; // PWM outputs: Hz (default 5000)
+  resolution?: number; // PWM outputs: duty bits (default 8)
   initialValue?: number; // For outputs; for inputs, it might be last known or not part of config
 }
 
@@ -0,0 +1,490 @@
+// Host benchmarks for the protocol, dispatch and telemetry hot paths.
+//
+// Runs the real pin, servo and stepper handlers and periodic updates against
+// the native HAL simulators (src/hal/native), so a change to a handler shows
+// its cost here before it reaches a station. Each case is timed in batches;
+// the median batch is reported with its spread and the heap allocations
+// one operation makes ("allocsIncludeMalloc" says whether the malloc family
+// was counted, see src/system/allocation_counter.h).
+//
+// Build and run from firmware/ (the `bench` env extends `native`):
+//   pio run -e bench
+//   .pio/build/bench/program
+//
+// Options:
+//   --baseline <file>        compare against a baseline; exit 1 on regression
+//   --write-baseline <file>  save this run as the new baseline
+//   --threshold <percent>    allowed slowdown before a regression (default 10)
+//   --filter <text>          only run cases whose name contains <text>
+//
+// Results are printed as JSON on stdout; the table and comparison go to
+// stderr. Baselines are only comparable on the machine that recorded them,
+// so none is checked in: record one on the reference machine with
+//   .pio/build/bench/program --write-baseline .pio/bench-baseline.json
+// and pass it to --baseline on later runs there. Cases missing from the
+// baseline are reported as new; a baseline with no entries fails.
+//
+// The pin cases run updatePinValues on the simulated pins, so the ADC engine
+// is the native polled fallback (hal/native/pins_native.cpp).
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "hal/native/sim.h"
+#include "hardware/io_pin.h"
+#include "hardware/servo.h"
+#include "hardware/stepper.h"
+#include "system/allocation_counter.h"
+
+static const int BATCHES = 15;
+static const int WARMUP_BATCHES = 2;
+static const double BATCH_TARGET_NS = 20e6;  // Iterations per batch ~20 ms
+static const double DEFAULT_THRESHOLD_PCT = 10.0;
+
+struct BenchResult {
+  std::string name;
+  double nsPerOp;     // Median batch
+  double minNsPerOp;  // Fastest batch
+  double madPct;      // Median absolute deviation, % of the median
+  double allocsPerOp;
+};
+
+struct BenchCase {
+  std::string name;
+  std::function<void()> setup;  // Runs once before timing (may be empty)
+  std::function<void()> run;    // One operation
+};
+
+static volatile uint32_t sink = 0;
+static const uint32_t BENCH_CLIENT_ID = 1;
+
+// --- Fixtures ---
+
+// Replace every stepper with `count` idle ones, ids stepper_0..
+static void configureSteppers(size_t count) {
+  for (size_t i = 0; i < configuredSteppers.capacity(); i++) {
+    if (configuredSteppers.inUse(i)) {
+      cleanupStepper(configuredSteppers[i]);
+      configuredSteppers.release(&configuredSteppers[i]);
+    }
+  }
+  for (size_t i = 0; i < count; i++) {
+    StepperConfig *stepper = configuredSteppers.allocate();
+    stepper->id = ("stepper_" + std::to_string(i)).c_str();
+    stepper->name = stepper->id.c_str();
+    stepper->pulPin = 10 + i;
+    stepper->dirPin = 20 + i;
+    initializeStepper(*stepper);
+  }
+}
+
+static void configureServos(size_t count) {
+  for (size_t i = 0; i < configuredServos.capacity(); i++) {
+    if (configuredServos.inUse(i)) {
+      cleanupServo(configuredServos[i]);
+      configuredServos.release(&configuredServos[i]);
+    }
+  }
+  for (size_t i = 0; i < count; i++) {
+    ServoConfig *servo = configuredServos.allocate();
+    servo->id = ("servo_" + std::to_string(i)).c_str();
+    servo->name = servo->id.c_str();
+    servo->pin = 30 + i;
+    initializeServo(*servo);
+  }
+}
+
+// Replace every pin with `count` pins on GPIO 0.., ids pin_0..: half
+// digital inputs, a quarter analog inputs, a quarter digital outputs
+static void configurePins(size_t count) {
+  for (size_t i = 0; i < configuredPins.capacity(); i++) {
+    if (configuredPins.inUse(i)) {
+      cleanupPin(configuredPins[i]);
+      configuredPins.release(&configuredPins[i]);
+    }
+  }
+  for (size_t i = 0; i < count; i++) {
+    IoPinConfig *pin = configuredPins.allocate();
+    pin->id = ("pin_" + std::to_string(i)).c_str();
+    pin->name = pin->id.c_str();
+    pin->pin = i;
+    pin->pinType = i % 4 == 2 ? "analog" : "digital";
+    pin->mode = i % 4 == 3 ? "output" : "input";
+    initializePin(*pin);
+  }
+  updatePinValues();  // Rebuild the poll tables and report initial values
+}
+
+// Parse and dispatch one command, as handleWebSocketCommand does. The
+// parser works in place, so each run parses a fresh copy.
+static void parseAndDispatch(const std::string &json) {
+  static char buffer[INBOUND_COMMAND_MAX_BYTES + 1];
+  memcpy(buffer, json.c_str(), json.size() + 1);
+
+  StaticJsonDocument<512> doc;
+  if (deserializeJson(doc, buffer)) return;
+  const char *group = doc["componentGroup"];
+  if (!group) return;
+  if (strcmp(group, "servos") == 0) {
+    handleServoMessage(BENCH_CLIENT_ID, doc);
+  } else if (strcmp(group, "steppers") == 0) {
+    handleStepperMessage(BENCH_CLIENT_ID, doc);
+  }
+}
+
+// Alternate between two commands so moves are never ignored as duplicates
+static std::function<void()> alternating(const std::string &a,
+                                         const std::string &b) {
+  auto flip = std::make_shared<bool>(false);
+  return [a, b, flip]() {
+    *flip = !*flip;
+    parseAndDispatch(*flip ? a : b);
+  };
+}
+
+// --- Cases ---
+
+static std::vector<BenchCase> buildCases() {
+  std::vector<BenchCase> cases;
+
+  // Protocol: parse + dispatch per command type
+  const std::string stepperMoveA =
+      R"({"componentGroup":"steppers","action":"control","id":"stepper_0",)"
+      R"("command":"move","value":1000,"commandId":"bench-1"})";
+  const std::string stepperMoveB =
+      R"({"componentGroup":"steppers","action":"control","id":"stepper_0",)"
+      R"("command":"move","value":-1000,"commandId":"bench-2"})";
+  const std::string stepperStop =
+      R"({"componentGroup":"steppers","action":"control","id":"stepper_0",)"
+      R"("command":"stop"})";
+  const std::string stepperParams =
+      R"({"componentGroup":"steppers","action":"control","id":"stepper_0",)"
+      R"("command":"setParams","speed":20000,"acceleration":40000})";
+  const std::string servoMoveA =
+      R"({"componentGroup":"servos","action":"control","id":"servo_0",)"
+      R"("command":"move","angle":45,"commandId":"bench-3"})";
+  const std::string servoMoveB =
+      R"({"componentGroup":"servos","action":"control","id":"servo_0",)"
+      R"("command":"move","angle":135,"commandId":"bench-4"})";
+  const std::string unknownStepper =
+      R"({"componentGroup":"steppers","action":"control","id":"missing",)"
+      R"("command":"move","value":10})";
+
+  auto axes = []() {
+    configureSteppers(MAX_STEPPERS);
+    configureServos(MAX_SERVOS);
+  };
+  cases.push_back({"parse", axes, [stepperMoveA]() {
+                     static char buffer[INBOUND_COMMAND_MAX_BYTES + 1];
+                     memcpy(buffer, stepperMoveA.c_str(),
+                            stepperMoveA.size() + 1);
+                     StaticJsonDocument<512> doc;
+                     sink += (uint32_t)deserializeJson(doc, buffer).code();
+                   }});
+  cases.push_back({"dispatch.steppers.move", axes,
+                   alternating(stepperMoveA, stepperMoveB)});
+  cases.push_back({"dispatch.steppers.stop", axes,
+                   alternating(stepperStop, stepperStop)});
+  cases.push_back({"dispatch.steppers.setParams", axes,
+                   alternating(stepperParams, stepperParams)});
+  cases.push_back({"dispatch.steppers.notFound", axes,
+                   alternating(unknownStepper, unknownStepper)});
+  cases.push_back({"dispatch.servos.move", axes,
+                   alternating(servoMoveA, servoMoveB)});
+
+  // Reply and broadcast serialization
+  cases.push_back({"reply.stepperNotFound", axes, []() {
+                     sendStepperNotFoundError(BENCH_CLIENT_ID, "missing");
+                   }});
+  cases.push_back({"broadcast.stepperPosition", axes, []() {
+                     sendStepperPositionUpdate(configuredSteppers[0]);
+                   }});
+
+  // Telemetry: periodic stepper updates with N axes
+  for (size_t count : {(size_t)1, (size_t)4, MAX_STEPPERS}) {
+    std::string n = std::to_string(count);
+    auto setup = [count]() { configureSteppers(count); };
+    cases.push_back({"steppers.updatePositions.idle/" + n, setup,
+                     []() { updateStepperPositions(); }});
+    // Every axis reports: its last reported position is stale and the
+    // report interval has passed
+    cases.push_back({"steppers.updatePositions.report/" + n, setup, []() {
+                       for (auto &stepper : configuredSteppers) {
+                         stepper.currentPosition = -1;
+                         stepper.lastPositionReportTime =
+                             millis() - stepperPositionReportInterval;
+                       }
+                       updateStepperPositions();
+                     }});
+    cases.push_back({"steppers.updateLimits/" + n, setup,
+                     []() { updateStepperLimits(); }});
+  }
+
+  // Pin polling: updatePinValues with nothing to report, with one digital
+  // input toggling (one broadcast), and with every analog input due and
+  // changed
+  for (size_t count : {(size_t)8, (size_t)32, MAX_IO_PINS}) {
+    std::string n = std::to_string(count);
+    auto setup = [count]() { configurePins(count); };
+    cases.push_back({"pins.update.idle/" + n, setup,
+                     []() { updatePinValues(); }});
+    cases.push_back({"pins.update.toggle/" + n, setup, []() {
+                       static int level = 0;
+                       level = !level;
+                       simSetDigitalInput(0, level);
+                       updatePinValues();
+                     }});
+    cases.push_back({"pins.update.analog/" + n, setup, [count]() {
+                       static int value = 0;
+                       value = value ? 0 : 4095;
+                       for (size_t gpio = 2; gpio < count; gpio += 4) {
+                         simSetAnalogInput(gpio, value);
+                       }
+                       simAdvanceUs((uint64_t)analogInputReadInterval * 1000);
+                       updatePinValues();
+                     }});
+  }
+
+  // Id lookup in full pools: the last slot (worst hit) and a miss
+  auto fullPools = []() {
+    configureSteppers(MAX_STEPPERS);
+    configureServos(MAX_SERVOS);
+    configurePins(MAX_IO_PINS);
+  };
+  std::string lastStepper = "stepper_" + std::to_string(MAX_STEPPERS - 1);
+  std::string lastServo = "servo_" + std::to_string(MAX_SERVOS - 1);
+  std::string lastPin = "pin_" + std::to_string(MAX_IO_PINS - 1);
+  cases.push_back({"lookup.stepper.hit", fullPools, [lastStepper]() {
+                     sink += findStepperById(lastStepper.c_str()) != nullptr;
+                   }});
+  cases.push_back({"lookup.stepper.miss", fullPools, []() {
+                     sink += findStepperById("missing") != nullptr;
+                   }});
+  cases.push_back({"lookup.servo.hit", fullPools, [lastServo]() {
+                     sink += findServoById(lastServo.c_str()) != nullptr;
+                   }});
+  cases.push_back({"lookup.pin.hit", fullPools, [lastPin]() {
+                     sink += findPinById(lastPin.c_str()) != nullptr;
+                   }});
+  cases.push_back({"lookup.pin.miss", fullPools, []() {
+                     sink += findPinById("missing") != nullptr;
+                   }});
+
+  return cases;
+}
+
+// --- Measurement ---
+
+static double timeBatch(const std::function<void()> &run, uint64_t iterations) {
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; i++) run();
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+static double median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  size_t mid = values.size() / 2;
+  return values.size() % 2 ? values[mid]
+                           : (values[mid - 1] + values[mid]) / 2;
+}
+
+static BenchResult measure(const BenchCase &bench) {
+  if (bench.setup) bench.setup();
+
+  // Grow the batch until it takes long enough to time reliably
+  uint64_t iterations = 1;
+  while (iterations < (1ULL << 30)) {
+    double ns = timeBatch(bench.run, iterations);
+    if (ns >= BATCH_TARGET_NS / 10) {
+      iterations = std::max<uint64_t>(
+          1, (uint64_t)(iterations * BATCH_TARGET_NS / ns));
+      break;
+    }
+    iterations *= 10;
+  }
+
+  for (int i = 0; i < WARMUP_BATCHES; i++) timeBatch(bench.run, iterations);
+
+  std::vector<double> perOp;
+  uint32_t allocationsBefore = allocationCount();
+  for (int i = 0; i < BATCHES; i++) {
+    perOp.push_back(timeBatch(bench.run, iterations) / iterations);
+  }
+  uint32_t allocations = allocationCount() - allocationsBefore;
+
+  BenchResult result;
+  result.name = bench.name;
+  result.nsPerOp = median(perOp);
+  result.minNsPerOp = *std::min_element(perOp.begin(), perOp.end());
+  std::vector<double> deviations;
+  for (double ns : perOp) deviations.push_back(fabs(ns - result.nsPerOp));
+  result.madPct =
+      result.nsPerOp > 0 ? 100.0 * median(deviations) / result.nsPerOp : 0;
+  result.allocsPerOp = (double)allocations / ((double)iterations * BATCHES);
+  return result;
+}
+
+// --- Baseline ---
+
+static bool readFile(const char *path, std::string &out) {
+  FILE *file = fopen(path, "rb");
+  if (!file) return false;
+  char chunk[4096];
+  size_t read;
+  while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    out.append(chunk, read);
+  }
+  fclose(file);
+  return true;
+}
+
+static void writeResults(const std::vector<BenchResult> &results, FILE *out) {
+  DynamicJsonDocument doc(256 + results.size() * 192);
+  doc["allocsIncludeMalloc"] = allocationCountIncludesMalloc();
+  JsonArray benchmarks = doc.createNestedArray("benchmarks");
+  for (const BenchResult &result : results) {
+    JsonObject item = benchmarks.createNestedObject();
+    item["name"] = result.name.c_str();
+    item["nsPerOp"] = result.nsPerOp;
+    item["minNsPerOp"] = result.minNsPerOp;
+    item["madPct"] = result.madPct;
+    item["opsPerSec"] = result.nsPerOp > 0 ? 1e9 / result.nsPerOp : 0;
+    item["allocsPerOp"] = result.allocsPerOp;
+  }
+  String json;
+  serializeJsonPretty(doc, json);
+  fprintf(out, "%s\n", json.c_str());
+}
+
+// Compare against a baseline. A case regresses when it is slower by more
+// than the threshold or three times its own spread, whichever is larger,
+// or when it allocates more. Returns the number of regressions.
+static int compareBaseline(const std::vector<BenchResult> &results,
+                           const char *path, double thresholdPct) {
+  std::string text;
+  if (!readFile(path, text)) {
+    fprintf(stderr, "ERROR: Cannot read baseline %s\n", path);
+    return 1;
+  }
+  DynamicJsonDocument baseline(text.size() * 2 + 1024);
+  DeserializationError error = deserializeJson(baseline, text);
+  if (error) {
+    fprintf(stderr, "ERROR: Baseline %s: %s\n", path, error.c_str());
+    return 1;
+  }
+
+  if (baseline["benchmarks"].as<JsonArray>().size() == 0) {
+    fprintf(stderr, "ERROR: Baseline %s has no entries; record one with "
+                    "--write-baseline\n", path);
+    return 1;
+  }
+
+  int regressions = 0;
+  fprintf(stderr, "\n%-40s %12s %12s %9s %s\n", "benchmark", "baseline ns",
+          "ns/op", "change", "");
+  for (const BenchResult &result : results) {
+    JsonObject base;
+    for (JsonObject item : baseline["benchmarks"].as<JsonArray>()) {
+      if (result.name == item["name"].as<const char *>()) base = item;
+    }
+    if (base.isNull()) {
+      fprintf(stderr, "%-40s %12s %12.1f %9s new\n", result.name.c_str(), "-",
+              result.nsPerOp, "-");
+      continue;
+    }
+
+    double baseNs = base["nsPerOp"];
+    double baseAllocs = base["allocsPerOp"] | 0.0;
+    double changePct = baseNs > 0 ? 100.0 * (result.nsPerOp - baseNs) / baseNs
+                                  : 0;
+    double limitPct = std::max(thresholdPct, 3.0 * result.madPct);
+    const char *verdict = "";
+    if (changePct > limitPct) {
+      verdict = "REGRESSION";
+      regressions++;
+    } else if (result.allocsPerOp > baseAllocs + 0.01) {
+      verdict = "MORE ALLOCATIONS";
+      regressions++;
+    } else if (changePct < -limitPct) {
+      verdict = "faster";
+    }
+    fprintf(stderr, "%-40s %12.1f %12.1f %+8.1f%% %s\n", result.name.c_str(),
+            baseNs, result.nsPerOp, changePct, verdict);
+  }
+  fprintf(stderr, "%d regression(s) against %s\n", regressions, path);
+  return regressions;
+}
+
+int main(int argc, char **argv) {
+  const char *baselinePath = nullptr;
+  const char *writeBaselinePath = nullptr;
+  const char *filter = nullptr;
+  double thresholdPct = DEFAULT_THRESHOLD_PCT;
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+      baselinePath = argv[++i];
+    } else if (strcmp(argv[i], "--write-baseline") == 0 && hasValue) {
+      writeBaselinePath = argv[++i];
+    } else if (strcmp(argv[i], "--threshold") == 0 && hasValue) {
+      thresholdPct = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+      filter = argv[++i];
+    } else {
+      fprintf(stderr,
+              "usage: %s [--baseline file] [--write-baseline file] "
+              "[--threshold percent] [--filter text]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  // Handlers log and reply as on the device; the output is discarded but
+  // still formatted, like the device's log queue does
+  FILE *devNull = fopen("/dev/null", "w");
+  Serial.setOutput(devNull);
+  simSetTransportSink(nullptr);
+  halStepperInit();
+
+  std::vector<BenchResult> results;
+  fprintf(stderr, "%-40s %12s %12s %8s %10s\n", "benchmark", "ns/op",
+          "min ns/op", "mad %", "allocs/op");
+  for (const BenchCase &bench : buildCases()) {
+    if (filter && bench.name.find(filter) == std::string::npos) continue;
+    BenchResult result = measure(bench);
+    fprintf(stderr, "%-40s %12.1f %12.1f %8.2f %10.2f\n", result.name.c_str(),
+            result.nsPerOp, result.minNsPerOp, result.madPct,
+            result.allocsPerOp);
+    results.push_back(result);
+  }
+
+  writeResults(results, stdout);
+  if (writeBaselinePath) {
+    FILE *out = fopen(writeBaselinePath, "w");
+    if (!out) {
+      fprintf(stderr, "ERROR: Cannot write %s\n", writeBaselinePath);
+      return 1;
+    }
+    writeResults(results, out);
+    fclose(out);
+  }
+
+  int regressions = 0;
+  if (baselinePath) {
+    regressions = compareBaseline(results, baselinePath, thresholdPct);
+  }
+  if (devNull) fclose(devNull);
+  return regressions ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+#ifndef BINARY_FRAMES_H
+#define BINARY_FRAMES_H
+
+#include <stdint.h>
+
+// --- Binary WebSocket Frames ---
+// Bulk data is sent as binary WebSocket messages instead of JSON. Every frame
+// starts with a one-byte frame type and a one-byte format version; all
+// multi-byte fields are little-endian.
+
+enum BinaryFrameType : uint8_t {
+  BINARY_FRAME_ANALOG_STREAM = 0x01,  // Raw ADC samples for one pin
+  BINARY_FRAME_PIN_CAPTURE = 0x02,    // Triggered multi-pin capture upload
+  BINARY_FRAME_PIN_CAPTURE_DATA = 0x03,  // Frames of that upload
+};
+
+// Header of a BINARY_FRAME_ANALOG_STREAM frame. Followed by `idLength` bytes
+// of pin id (not null-terminated) and `sampleCount` uint16_t raw samples.
+struct __attribute__((packed)) AnalogStreamChunkHeader {
+  uint8_t frameType;           // BINARY_FRAME_ANALOG_STREAM
+  uint8_t version;             // ANALOG_STREAM_FRAME_VERSION
+  uint8_t gpio;                // GPIO number of the streamed pin
+  uint8_t idLength;            // Length of the pin id that follows
+  uint32_t sequence;           // Chunk counter for this stream
+  uint64_t startUs;            // esp_timer time of the first sample
+  uint32_t sampleRateMilliHz;  // Per-pin sample rate in mHz
+  uint16_t sampleCount;        // Samples in this chunk
+  uint16_t droppedChunks;      // Chunks dropped since the previous frame
+};
+
+const uint8_t ANALOG_STREAM_FRAME_VERSION = 1;
+
+// Header of a BINARY_FRAME_PIN_CAPTURE frame. Followed by one channel
+// descriptor per captured pin (digital channels first, in bit order):
+//   uint8_t gpio, uint8_t idLength, idLength bytes of pin id
+// The `frameCount` frames follow in BINARY_FRAME_PIN_CAPTURE_DATA frames, in
+// chronological order and without gaps. Each frame holds a uint32_t with one
+// bit per digital channel followed by one uint16_t raw value per analog
+// channel.
+struct __attribute__((packed)) PinCaptureHeader {
+  uint8_t frameType;        // BINARY_FRAME_PIN_CAPTURE
+  uint8_t version;          // PIN_CAPTURE_FRAME_VERSION
+  uint8_t digitalChannels;  // Channels packed into the per-frame bitfield
+  uint8_t analogChannels;   // uint16_t values per frame
+  uint32_t sampleRateHz;    // Frame rate
+  uint32_t frameCount;      // Frames in this upload
+  uint32_t triggerFrame;    // Index of the frame that fired the trigger
+  uint64_t startUs;         // esp_timer time of frame 0
+};
+
+// Header of a BINARY_FRAME_PIN_CAPTURE_DATA frame, followed by `frameCount`
+// capture frames. Data frames belong to the last BINARY_FRAME_PIN_CAPTURE
+// frame sent to the client.
+struct __attribute__((packed)) PinCaptureDataHeader {
+  uint8_t frameType;    // BINARY_FRAME_PIN_CAPTURE_DATA
+  uint8_t version;      // PIN_CAPTURE_FRAME_VERSION
+  uint16_t frameCount;  // Frames in this chunk
+  uint32_t firstFrame;  // Index of this chunk's first frame in the upload
+};
+
+const uint8_t PIN_CAPTURE_FRAME_VERSION = 2;
+
+#endif  // BINARY_FRAMES_H
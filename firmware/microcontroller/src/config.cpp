@@ -3,54 +3,89 @@
 // --- Network Configuration ---
 const char *ssid = "Everwood";
 const char *password = "Everwood-Staff";
+const char *firmwareVersion = "1.0.0";
+const char *mdnsHostPrefix = "everwood";
 
 // --- Global Configuration Constants ---
 const unsigned long analogInputReadInterval =
     100;  // Only poll analog inputs at this interval
+const unsigned long analogReportMinInterval =
+    20;  // At most 50 change reports per second per analog input
 const unsigned long stepperPositionReportInterval =
     100;  // Report position every 100ms if changed
 const unsigned long ipPrintDuration = 15000;
 const unsigned long ipPrintInterval = 1000;
+const unsigned long wifiConnectTimeout = 8000;
+const unsigned long wifiBackoffMin = 100;
+const unsigned long wifiBackoffMax = 30000;
+const bool udpTransportEnabled = true;
+const uint16_t udpTransportPort = 4210;
+const unsigned long udpResendInterval = 30;
+const uint8_t udpMaxResends = 5;
+const unsigned long udpPeerTimeout = 10000;
+uint32_t adcSampleRateHz = 20000;  // Lowest rate the ESP32 DMA mode supports
+
+// --- Task Layout ---
+// Control owns core 1; WiFi, AsyncTCP and everything that talks to the
+// network or the UART stay on core 0.
+const TaskSpec controlTaskSpec = {"control", 1, 5, 8192};
+const TaskSpec networkTaskSpec = {"network", 0, 3, 6144};
+const TaskSpec telemetryTaskSpec = {"telemetry", 0, 2, 6144};
+const TaskSpec loggingTaskSpec = {"logging", 0, 1, 3072};
+const unsigned long telemetryInterval = 1000;
+
+// --- Heap and Stack Health ---
+DoubleBuffer<HealthThresholds> healthThresholds({32768, 16384, 512});
+const unsigned long healthSampleInterval = 1000;
+
+// --- Control Tick Schedule ---
+// Budgets are the worst case expected on an ESP32 at 240 MHz; exceeding one
+// is reported, not enforced.
+const uint16_t controlTickHz = 2000;
+const SubsystemSpec prioritySubsystem = {"priority", 2000, 400};
+const SubsystemSpec limitsSubsystem = {"limits", 2000, 50};
+const SubsystemSpec commandsSubsystem = {"commands", 1000, 400};
+const SubsystemSpec pinsSubsystem = {"pins", 1000, 150};
+const SubsystemSpec steppersSubsystem = {"steppers", 500, 100};
+const SubsystemSpec servosSubsystem = {"servos", 200, 50};
+const SubsystemSpec snapshotSubsystem = {"snapshot", 50, 30};
 
 // --- Global Data Structures ---
-std::vector<IoPinConfig> configuredPins;
-std::vector<ServoConfig> configuredServos;
-std::vector<StepperConfig> configuredSteppers;
-std::map<String, unsigned long> lastPinReadTime;
+ComponentPool<IoPinConfig, MAX_IO_PINS> configuredPins;
+ComponentPool<ServoConfig, MAX_SERVOS> configuredServos;
+ComponentPool<StepperConfig, MAX_STEPPERS> configuredSteppers;
 
 // --- Servo Channel Tracking ---
 bool servoChannelUsed[MAX_SERVO_CHANNELS] = {
     false};  // All channels initially free
 
 // --- Helper Functions ---
-IoPinConfig *findPinById(const String &id) {
+IoPinConfig *findPinById(const char *id) {
   for (auto &pinConfig : configuredPins) {
     if (pinConfig.id == id) return &pinConfig;
   }
   return nullptr;
 }
 
-ServoConfig *findServoById(const String &id) {
+ServoConfig *findServoById(const char *id) {
   if (configuredServos.empty()) {
     Serial.println("DEBUG: No servos configured yet!");
     return nullptr;
   }
 
-  for (size_t i = 0; i < configuredServos.size(); i++) {
-    auto &servoConfig = configuredServos[i];
-
+  for (auto &servoConfig : configuredServos) {
     if (servoConfig.id == id) {
       return &servoConfig;
     }
   }
 
-  Serial.printf("DEBUG: No servo found with id='%s'\n", id.c_str());
+  Serial.printf("DEBUG: No servo found with id='%s'\n", id);
   // If we can't find it, dump all servo configurations to help diagnose
   debugPrintServoConfigurations();
   return nullptr;
 }
 
-StepperConfig *findStepperById(const String &id) {
+StepperConfig *findStepperById(const char *id) {
   for (auto &stepper : configuredSteppers) {
     if (stepper.id == id) {
       return &stepper;
@@ -59,6 +94,20 @@ StepperConfig *findStepperById(const String &id) {
   return nullptr;
 }
 
+AdcFilterType parseAdcFilterType(const char *name) {
+  if (!name) return ADC_FILTER_NONE;
+  if (strcmp(name, "average") == 0) return ADC_FILTER_MOVING_AVERAGE;
+  if (strcmp(name, "iir") == 0) return ADC_FILTER_IIR;
+  if (strcmp(name, "median") == 0) return ADC_FILTER_MEDIAN;
+  return ADC_FILTER_NONE;
+}
+
+CounterEdge parseCounterEdge(const char *name) {
+  if (name && strcmp(name, "falling") == 0) return COUNTER_EDGE_FALLING;
+  if (name && strcmp(name, "both") == 0) return COUNTER_EDGE_BOTH;
+  return COUNTER_EDGE_RISING;
+}
+
 // Allocate a free servo channel
 int allocateServoChannel() {
   // First, try to find a free channel
@@ -81,4 +130,31 @@ void releaseServoChannel(int channel) {
     servoChannelUsed[channel] = false;
     Serial.printf("DEBUG: Released servo channel %d\n", channel);
   }
+}
+
+// Allocate both channels of an LEDC timer pair for a PWM pin. Channels 2n and
+// 2n+1 share a timer, so a PWM pin with its own frequency must not share its
+// timer with a servo. Pairs are taken from the top; servos fill from 0.
+int allocatePwmChannelPair() {
+  int channelCount = min(LEDC_CHANNEL_COUNT, MAX_SERVO_CHANNELS);
+  for (int i = channelCount - 2; i >= 0; i -= 2) {
+    if (!servoChannelUsed[i] && !servoChannelUsed[i + 1]) {
+      servoChannelUsed[i] = true;
+      servoChannelUsed[i + 1] = true;
+      Serial.printf("DEBUG: Allocated PWM channel %d\n", i);
+      return i;
+    }
+  }
+
+  Serial.println("ERROR: No free PWM channel pairs available!");
+  return -1;
+}
+
+// Release a PWM channel pair
+void releasePwmChannelPair(int channel) {
+  if (channel >= 0 && channel + 1 < MAX_SERVO_CHANNELS) {
+    servoChannelUsed[channel] = false;
+    servoChannelUsed[channel + 1] = false;
+    Serial.printf("DEBUG: Released PWM channel %d\n", channel);
+  }
 }
\ No newline at end of file
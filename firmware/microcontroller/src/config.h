@@ -2,30 +2,101 @@
 #define CONFIG_H
 
 #include <Arduino.h>
-#include <Bounce2.h>
-#include <FastAccelStepper.h>
-#include <Servo.h>  // Using ServoESP32 library (header is still named Servo.h)
 
-#include <map>
-#include <vector>
+#include "hal/hal_ledc.h"
+#include "hal/hal_servo.h"
+#include "hal/hal_stepper.h"
+#include "util/component_pool.h"
+#include "util/double_buffer.h"
+#include "util/fixed_string.h"
 
 // --- Network Configuration ---
 extern const char* ssid;
 extern const char* password;
+extern const char* firmwareVersion;
+// mDNS hostname is "<prefix>-<last 3 MAC bytes>", e.g. everwood-a1b2c3.local
+extern const char* mdnsHostPrefix;
+
+// --- Component Storage ---
+// Components live in fixed pools (see util/component_pool.h) with inline
+// ids and names, so their addresses are stable and reconfiguring them never
+// allocates. Ids longer than COMPONENT_ID_MAX_CHARS are rejected on
+// configure; longer names are truncated.
+const size_t MAX_IO_PINS = 40;
+const size_t MAX_SERVOS = 16;
+const size_t MAX_STEPPERS = 8;
+const size_t COMPONENT_ID_MAX_CHARS = 40;
+const size_t COMPONENT_NAME_MAX_CHARS = 32;
+const size_t COMMAND_ID_MAX_CHARS = 48;
+typedef FixedString<COMPONENT_ID_MAX_CHARS> ComponentId;
+typedef FixedString<COMPONENT_NAME_MAX_CHARS> ComponentName;
+typedef FixedString<COMMAND_ID_MAX_CHARS> CommandId;
 
 // --- Pin Configuration ---
 enum PinPullMode { PULL_NONE = 0, PULL_UP = 1, PULL_DOWN = 2 };
 
+// Digital filter applied to oversampled analog input readings
+enum AdcFilterType {
+  ADC_FILTER_NONE = 0,
+  ADC_FILTER_MOVING_AVERAGE = 1,
+  ADC_FILTER_IIR = 2,
+  ADC_FILTER_MEDIAN = 3
+};
+
+// Pin role compiled from pinType and mode when a pin is initialized, so the
+// main loop dispatches on an enum instead of comparing Strings
+enum PinKind : uint8_t {
+  PIN_KIND_NONE = 0,
+  PIN_KIND_DIGITAL_INPUT,
+  PIN_KIND_DIGITAL_OUTPUT,
+  PIN_KIND_ANALOG_INPUT,
+  PIN_KIND_ANALOG_OUTPUT,
+  PIN_KIND_PWM_OUTPUT,
+  PIN_KIND_COUNTER,
+  PIN_KIND_FREQUENCY
+};
+
+// Edges counted by a hardware pulse counter input
+enum CounterEdge {
+  COUNTER_EDGE_RISING = 0,
+  COUNTER_EDGE_FALLING = 1,
+  COUNTER_EDGE_BOTH = 2
+};
+
 struct IoPinConfig {
-  String id;
-  String name;
+  ComponentId id;
+  ComponentName name;
   uint8_t pin;
-  String pinType;  // "digital", "analog", or "pwm"
-  String mode;     // "input" or "output"
+  FixedString<9> pinType;  // "digital", "analog", "pwm", "counter", "frequency"
+  FixedString<6> mode;     // "input" or "output"
   int lastValue;   // Last read or written value
   PinPullMode pullMode;
-  uint16_t debounceMs;
-  Bounce* debouncer;  // Only used for digital inputs
+  uint16_t debounceMs;  // Digital inputs: required stable time before a change
+  PinKind kind = PIN_KIND_NONE;  // Compiled from pinType/mode by initializePin
+
+  // Interrupt-driven digital inputs (see hardware/input_events.h)
+  bool useInterrupt = false;  // Capture edges in an ISR instead of polling
+  int64_t lastEdgeUs = 0;     // esp_timer timestamp of the last accepted edge
+  uint32_t edgeCount = 0;     // Accepted edges since configuration
+  bool settlePending = false;  // An edge was rejected inside the debounce window
+
+  // Analog input sampling (see hardware/adc_engine.h)
+  uint8_t adcOversample = 1;  // Raw conversions averaged per filtered sample
+  AdcFilterType adcFilter = ADC_FILTER_NONE;
+  uint8_t adcFilterWindow = 4;      // Average/median length, or IIR divisor
+  uint16_t adcDeadband = 10;        // Minimum change (counts) to report
+  uint16_t adcReportIntervalMs = 0;  // 0 = report on change, else fixed rate
+
+  // Pulse counter inputs (see hardware/pulse_counter.h)
+  CounterEdge counterEdge = COUNTER_EDGE_RISING;
+  uint16_t counterGlitchFilterNs = 1000;  // 0 = off, max ~12.7 us
+  uint16_t counterReportIntervalMs = 1000;
+  int8_t pcntUnit = -1;  // Allocated PCNT unit, -1 if none
+
+  // PWM outputs (see hardware/pwm_output.h)
+  uint32_t pwmFrequency = 5000;  // Hz
+  uint8_t pwmResolution = 8;     // Duty bits
+  int8_t pwmChannel = -1;        // Allocated LEDC channel, -1 if none
 };
 
 // --- Servo Configuration ---
@@ -35,11 +106,11 @@ extern bool
     servoChannelUsed[MAX_SERVO_CHANNELS];  // Track which channels are in use
 
 struct ServoConfig {
-  String id;
-  String name;
+  ComponentId id;
+  ComponentName name;
   uint8_t pin;
   int channel = -1;  // PWM channel (-1 means not assigned)
-  Servo servo;       // ServoESP32 instance
+  HalServo servo;    // Servo backend (see hal/hal_servo.h)
 
   // Configuration
   int minAngle = 0;
@@ -58,17 +129,19 @@ struct ServoConfig {
 
   // Action completion tracking for sequence execution
   bool isActionPending = false;  // Whether a sequence action is in progress
-  String pendingCommandId = "";  // ID of the pending sequence command (if any)
+  CommandId pendingCommandId;    // ID of the pending sequence command (if any)
+
+  uint32_t movesCompleted = 0;  // Reported by /metrics
 };
 
 // --- Stepper Configuration ---
 struct StepperConfig {
-  String id;
-  String name;
+  ComponentId id;
+  ComponentName name;
   uint8_t pulPin = 0;
   uint8_t dirPin = 0;
   uint8_t enaPin = 0;
-  FastAccelStepper* stepper = nullptr;
+  HalStepper* stepper = nullptr;  // Pulse backend (see hal/hal_stepper.h)
   float maxSpeed = 50000.0;      // Steps per second (increased from 1000.0)
   float acceleration = 50000.0;  // Steps per second² (increased from 500.0)
   long minPosition = -50000;
@@ -79,7 +152,7 @@ struct StepperConfig {
   bool isHomed = false;
   unsigned long lastPositionReportTime = 0;
 
-  String homeSensorId;           // ID of the IoPinConfig to use as a sensor
+  ComponentId homeSensorId;      // ID of the IoPinConfig to use as a sensor
   int homingDirection;           // -1 for negative, 1 for positive movement
   float homingSpeed;             // Speed in steps/sec for the homing move
   bool isHoming;                 // Flag to indicate a homing sequence is active
@@ -89,48 +162,161 @@ struct StepperConfig {
 
   // Action completion tracking
   bool isActionPending = false;  // Whether an action is in progress
-  String pendingCommandId = "";  // ID of the pending command (if any)
+  CommandId pendingCommandId;    // ID of the pending command (if any)
+
+  // Reported by /metrics
+  uint64_t stepsGenerated = 0;  // Sum of position changes between samples
+  long stepSamplePosition = 0;  // Position at the last sample
+  uint32_t movesCompleted = 0;
 };
 
 // --- Global Configuration Constants ---
 // Timing constants
 extern const unsigned long
     analogInputReadInterval;  // Only poll analog inputs at this interval
+extern const unsigned long
+    analogReportMinInterval;  // Rate limit for change-driven analog reports
 extern const unsigned long
     stepperPositionReportInterval;  // Report position every 100ms if changed
 extern const unsigned long ipPrintDuration;
 extern const unsigned long ipPrintInterval;
+// Continuous ADC engine
+extern uint32_t adcSampleRateHz;  // Total DMA conversion rate (all channels)
+const uint8_t ADC_MAX_FILTER_WINDOW = 16;
+// Hardware pulse counters. FastAccelStepper's MCPWM/PCNT driver claims PCNT
+// units from unit 0 upwards, so counter inputs take units from the top.
+const uint8_t MAX_PULSE_COUNTERS = 2;
+// WiFi reconnects: an attempt is abandoned after wifiConnectTimeout, then
+// retried after a delay doubling from wifiBackoffMin up to wifiBackoffMax
+extern const unsigned long wifiConnectTimeout;
+extern const unsigned long wifiBackoffMin;
+extern const unsigned long wifiBackoffMax;
+// Optional UDP command and telemetry transport (see network/udp_transport.h).
+// Unacked replies are resent every udpResendInterval ms, up to udpMaxResends
+// times; a peer silent for udpPeerTimeout ms is dropped.
+extern const bool udpTransportEnabled;
+extern const uint16_t udpTransportPort;
+extern const unsigned long udpResendInterval;
+extern const uint8_t udpMaxResends;
+extern const unsigned long udpPeerTimeout;
+const uint8_t MAX_UDP_PEERS = 4;
+const uint8_t UDP_RESEND_SLOTS = 8;         // Unacked replies per peer
+const uint8_t UDP_RECENT_COMMAND_IDS = 16;  // commandIds kept for dedup
+const size_t UDP_FRAME_MAX_BYTES = 1400;    // One datagram under the MTU
 // Servo speed: 0.23 seconds per 60 degrees
 // (0.4666 * 1000 ms) / 60 degrees = 7.7777... ms per degree
 const float SERVO_MS_PER_DEGREE_FULL_SPEED = 7.7777f;
 
+// --- Task Layout (see system/tasks.h) ---
+struct TaskSpec {
+  const char* name;
+  int core;              // CPU core the task is pinned to
+  unsigned priority;     // FreeRTOS priority
+  uint32_t stackBytes;
+};
+extern const TaskSpec controlTaskSpec;    // Hardware updates and commands
+extern const TaskSpec networkTaskSpec;    // Outbound delivery, WiFi, clients
+extern const TaskSpec telemetryTaskSpec;  // Periodic control snapshots
+extern const TaskSpec loggingTaskSpec;    // Serial output
+extern const unsigned long telemetryInterval;  // controlStatus broadcast period
+
+// --- Control Tick Schedule (see system/scheduler.h) ---
+struct SubsystemSpec {
+  const char* name;
+  uint16_t rateHz;    // Must divide controlTickHz
+  uint32_t budgetUs;  // Runs longer than this are counted as over budget
+};
+extern const uint16_t controlTickHz;  // Base tick; fastest subsystem rate
+extern const SubsystemSpec prioritySubsystem;   // Stop/estop, /ws/control, UDP
+extern const SubsystemSpec limitsSubsystem;     // Stepper limits and homing
+extern const SubsystemSpec commandsSubsystem;   // Inbound WebSocket commands
+extern const SubsystemSpec pinsSubsystem;       // Pin polling and events
+extern const SubsystemSpec steppersSubsystem;   // Move completion, positions
+extern const SubsystemSpec servosSubsystem;     // Servo move completion
+extern const SubsystemSpec snapshotSubsystem;   // Control snapshot publish
+const uint8_t MAX_SUBSYSTEMS = 8;
+// Latency histograms (see system/metrics.h), about 1 KB each
+const uint8_t MAX_LATENCY_METRICS = 16;
+// Event trace ring (see system/trace.h), 16 bytes per record
+const size_t TRACE_RING_SIZE = 512;  // Power of two
+const size_t TRACE_DUMP_CHUNK_EVENTS = 32;
+// Heap and stack health (see system/health.h)
+struct HealthThresholds {
+  uint32_t minFreeHeapBytes;      // Warn when free heap drops below this
+  uint32_t minLargestBlockBytes;  // Warn when the largest block is smaller
+  uint32_t minStackFreeBytes;     // Warn when a task's stack headroom is less
+};
+// Adjustable at runtime: published by the control task, read by telemetry
+extern DoubleBuffer<HealthThresholds> healthThresholds;
+extern const unsigned long healthSampleInterval;
+const uint8_t MAX_HEALTH_TASKS = 6;
+// Stepper and servo counters carried in the control snapshot
+const uint8_t MAX_SNAPSHOT_AXES = MAX_STEPPERS + MAX_SERVOS;
+const size_t INBOUND_COMMAND_MAX_BYTES = 1024;
+const size_t INBOUND_COMMAND_QUEUE_SIZE = 8;   // Power of two
+const size_t PRIORITY_COMMAND_QUEUE_SIZE = 4;  // Power of two
+const size_t UDP_COMMAND_QUEUE_SIZE = 4;       // Power of two
+const size_t PRIORITY_OUTBOUND_QUEUE_SIZE = 16;  // Power of two
+const size_t OUTBOUND_MESSAGE_QUEUE_SIZE = 64;  // Power of two
+// ISR -> control task edge events (see hardware/input_events.h)
+const size_t PIN_EDGE_EVENT_QUEUE_SIZE = 256;   // Power of two
+const size_t LOG_QUEUE_SIZE = 32;               // Power of two
+const size_t LOG_LINE_MAX_BYTES = 160;
+
 // --- Global Data Structures ---
-extern std::vector<IoPinConfig> configuredPins;
-extern std::vector<ServoConfig> configuredServos;
-extern std::vector<StepperConfig> configuredSteppers;
-extern std::map<String, unsigned long> lastPinReadTime;
+extern ComponentPool<IoPinConfig, MAX_IO_PINS> configuredPins;
+extern ComponentPool<ServoConfig, MAX_SERVOS> configuredServos;
+extern ComponentPool<StepperConfig, MAX_STEPPERS> configuredSteppers;
 
 // --- Forward declarations of helper functions ---
-IoPinConfig* findPinById(const String& id);
-ServoConfig* findServoById(const String& id);
-StepperConfig* findStepperById(const String& id);
+IoPinConfig* findPinById(const char* id);
+ServoConfig* findServoById(const char* id);
+StepperConfig* findStepperById(const char* id);
+inline IoPinConfig* findPinById(const String& id) {
+  return findPinById(id.c_str());
+}
+inline ServoConfig* findServoById(const String& id) {
+  return findServoById(id.c_str());
+}
+inline StepperConfig* findStepperById(const String& id) {
+  return findStepperById(id.c_str());
+}
+inline IoPinConfig* findPinById(const ComponentId& id) {
+  return findPinById(id.c_str());
+}
+inline ServoConfig* findServoById(const ComponentId& id) {
+  return findServoById(id.c_str());
+}
+inline StepperConfig* findStepperById(const ComponentId& id) {
+  return findStepperById(id.c_str());
+}
 int allocateServoChannel();
 void releaseServoChannel(int channel);
+int allocatePwmChannelPair();
+void releasePwmChannelPair(int channel);
+
+// Parse a filter name from the pin config ("none", "average", "iir", "median")
+AdcFilterType parseAdcFilterType(const char* name);
+// Parse "rising", "falling" or "both" (defaults to rising)
+CounterEdge parseCounterEdge(const char* name);
 
 // --- Debug printing functions for configuration diagnostics ---
 inline void debugPrintServoConfigurations() {
   Serial.println(F("===== SERVO CONFIGURATION DIAGNOSTICS ====="));
-  Serial.printf("Total configured servos: %d\n", configuredServos.size());
+  Serial.printf("Total configured servos: %u/%u\n",
+                (unsigned)configuredServos.size(),
+                (unsigned)configuredServos.capacity());
 
-  for (size_t i = 0; i < configuredServos.size(); i++) {
+  for (size_t i = 0; i < configuredServos.capacity(); i++) {
+    if (!configuredServos.inUse(i)) continue;
     const auto& servo = configuredServos[i];
     Serial.printf(
-        "Servo[%d]: id='%s', name='%s', pin=%d, channel=%d, range=[%d-%d], "
+        "Servo[%u]: id='%s', name='%s', pin=%d, channel=%d, range=[%d-%d], "
         "pulseWidth=[%d-%d], angle=%d, attached=%s\n",
-        i, servo.id.c_str(), servo.name.c_str(), servo.pin, servo.channel,
-        servo.minAngle, servo.maxAngle, servo.minPulseWidth,
+        (unsigned)i, servo.id.c_str(), servo.name.c_str(), servo.pin,
+        servo.channel, servo.minAngle, servo.maxAngle, servo.minPulseWidth,
         servo.maxPulseWidth, servo.currentAngle,
-        configuredServos[i].servo.attached() ? "true" : "false");
+        servo.servo.attached() ? "true" : "false");
   }
   Serial.println(F("=========================================="));
 }
@@ -138,14 +324,17 @@ inline void debugPrintServoConfigurations() {
 // --- Debug printing function for stepper configurations ---
 inline void debugPrintStepperConfigurations() {
   Serial.println(F("===== STEPPER CONFIGURATION DIAGNOSTICS ====="));
-  Serial.printf("Total configured steppers: %d\n", configuredSteppers.size());
+  Serial.printf("Total configured steppers: %u/%u\n",
+                (unsigned)configuredSteppers.size(),
+                (unsigned)configuredSteppers.capacity());
 
-  for (size_t i = 0; i < configuredSteppers.size(); i++) {
+  for (size_t i = 0; i < configuredSteppers.capacity(); i++) {
+    if (!configuredSteppers.inUse(i)) continue;
     const auto& stepper = configuredSteppers[i];
     Serial.printf(
-        "Stepper[%d]: id='%s', name='%s', pins=[PUL:%d,DIR:%d,ENA:%d], "
+        "Stepper[%u]: id='%s', name='%s', pins=[PUL:%d,DIR:%d,ENA:%d], "
         "speed=%.2f, accel=%.2f, range=[%ld-%ld]\n",
-        i, stepper.id.c_str(), stepper.name.c_str(), stepper.pulPin,
+        (unsigned)i, stepper.id.c_str(), stepper.name.c_str(), stepper.pulPin,
         stepper.dirPin, stepper.enaPin, stepper.maxSpeed, stepper.acceleration,
         stepper.minPosition, stepper.maxPosition);
   }
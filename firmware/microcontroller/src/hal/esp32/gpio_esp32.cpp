@@ -0,0 +1,105 @@
+#ifndef EVERWOOD_NATIVE
+
+#include <Arduino.h>
+#include <driver/ledc.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+
+#include "../hal_gpio.h"
+#include "../hal_ledc.h"
+
+static const uint8_t arduinoPinModes[] = {INPUT, INPUT_PULLUP, INPUT_PULLDOWN,
+                                          OUTPUT};
+
+void halPinMode(uint8_t pin, HalPinMode mode) {
+  pinMode(pin, arduinoPinModes[mode]);
+}
+
+int halDigitalRead(uint8_t pin) { return digitalRead(pin); }
+
+void halDigitalWrite(uint8_t pin, int level) {
+  digitalWrite(pin, level ? HIGH : LOW);
+}
+
+int halAnalogRead(uint8_t pin) { return analogRead(pin); }
+
+uint64_t halReadInputs() {
+  return (uint64_t)REG_READ(GPIO_IN_REG) |
+         ((uint64_t)REG_READ(GPIO_IN1_REG) << 32);
+}
+
+// W1TS/W1TC only touch the bits written, so concurrent writers (e.g. the
+// stepper direction pins) are never clobbered by a read-modify-write. Each
+// bank takes one store to set and another to clear.
+void halWriteOutputs(uint64_t setMask, uint64_t clearMask) {
+  uint32_t setLow = (uint32_t)setMask;
+  uint32_t setHigh = (uint32_t)(setMask >> 32);
+  uint32_t clearLow = (uint32_t)clearMask;
+  uint32_t clearHigh = (uint32_t)(clearMask >> 32);
+  if (setLow) REG_WRITE(GPIO_OUT_W1TS_REG, setLow);
+  if (clearLow) REG_WRITE(GPIO_OUT_W1TC_REG, clearLow);
+  if (setHigh) REG_WRITE(GPIO_OUT1_W1TS_REG, setHigh);
+  if (clearHigh) REG_WRITE(GPIO_OUT1_W1TC_REG, clearHigh);
+}
+
+uint32_t halLedcSetup(uint8_t channel, uint32_t frequency, uint8_t bits) {
+  return (uint32_t)ledcSetup(channel, frequency, bits);
+}
+
+void halLedcAttachPin(uint8_t pin, uint8_t channel) {
+  ledcAttachPin(pin, channel);
+}
+
+void halLedcDetachPin(uint8_t pin) { ledcDetachPin(pin); }
+
+void halLedcWrite(uint8_t channel, uint32_t duty) { ledcWrite(channel, duty); }
+
+static HalLedcFadeCallback fadeCallbacks[LEDC_CHANNEL_COUNT];
+static bool fadeServiceInstalled = false;
+
+// Arduino numbers LEDC channels 0-15; the driver uses a speed mode group of 8
+static inline ledc_mode_t ledcModeFor(uint8_t channel) {
+  return (ledc_mode_t)(channel / 8);
+}
+
+static inline ledc_channel_t ledcChannelFor(uint8_t channel) {
+  return (ledc_channel_t)(channel % 8);
+}
+
+static bool IRAM_ATTR onFadeEnd(const ledc_cb_param_t *param, void *arg) {
+  uint8_t channel = (uint8_t)(uintptr_t)arg;
+  if (param->event == LEDC_FADE_END_EVT && fadeCallbacks[channel]) {
+    fadeCallbacks[channel](channel);
+  }
+  return false;
+}
+
+bool halLedcFadeStart(uint8_t channel, uint32_t duty, uint32_t durationMs,
+                      HalLedcFadeCallback onEnd) {
+  if (channel >= LEDC_CHANNEL_COUNT) return false;
+  if (!fadeServiceInstalled) {
+    if (ledc_fade_func_install(0) != ESP_OK) return false;
+    fadeServiceInstalled = true;
+  }
+
+  ledc_mode_t mode = ledcModeFor(channel);
+  ledc_channel_t ledcChannel = ledcChannelFor(channel);
+  fadeCallbacks[channel] = onEnd;
+  ledc_cbs_t callbacks = {};
+  callbacks.fade_cb = onFadeEnd;
+  ledc_cb_register(mode, ledcChannel, &callbacks, (void *)(uintptr_t)channel);
+  return ledc_set_fade_time_and_start(mode, ledcChannel, duty, durationMs,
+                                      LEDC_FADE_NO_WAIT) == ESP_OK;
+}
+
+void halLedcFadeStop(uint8_t channel) {
+  if (channel >= LEDC_CHANNEL_COUNT) return;
+  ledc_fade_stop(ledcModeFor(channel), ledcChannelFor(channel));
+}
+
+uint32_t halLedcGetDuty(uint8_t channel) {
+  if (channel >= LEDC_CHANNEL_COUNT) return 0;
+  return ledc_get_duty(ledcModeFor(channel), ledcChannelFor(channel));
+}
+
+#endif  // EVERWOOD_NATIVE
@@ -0,0 +1,46 @@
+#ifndef EVERWOOD_NATIVE
+
+#include <Arduino.h>
+#include <Servo.h>  // ServoESP32 library (header is still named Servo.h)
+
+#include "../../config.h"
+#include "../hal_servo.h"
+
+static Servo servos[MAX_SERVOS];
+static bool slotUsed[MAX_SERVOS] = {false};
+
+bool HalServo::attach(uint8_t pin, int channel, int minAngle, int maxAngle,
+                      int minPulseUs, int maxPulseUs, int frequencyHz) {
+  if (slot_ < 0) {
+    for (int8_t i = 0; i < (int8_t)MAX_SERVOS; i++) {
+      if (!slotUsed[i]) {
+        slotUsed[i] = true;
+        slot_ = i;
+        break;
+      }
+    }
+    if (slot_ < 0) return false;
+  }
+
+  Servo &servo = servos[slot_];
+  servo.attach(pin, channel, minAngle, maxAngle, minPulseUs, maxPulseUs,
+               frequencyHz);
+  if (!servo.attached()) {
+    detach();
+    return false;
+  }
+  return true;
+}
+
+void HalServo::write(int angle) {
+  if (slot_ >= 0) servos[slot_].write(angle);
+}
+
+void HalServo::detach() {
+  if (slot_ < 0) return;
+  servos[slot_].detach();
+  slotUsed[slot_] = false;
+  slot_ = -1;
+}
+
+#endif  // EVERWOOD_NATIVE
@@ -0,0 +1,75 @@
+#ifndef EVERWOOD_NATIVE
+
+#include <Arduino.h>
+#include <FastAccelStepper.h>
+
+#include "../../config.h"
+#include "../hal_stepper.h"
+
+static FastAccelStepperEngine engine = FastAccelStepperEngine();
+
+static FastAccelStepper *backends[MAX_STEPPERS];
+static uint8_t stepPins[MAX_STEPPERS];
+static HalStepper handles[MAX_STEPPERS];
+static uint8_t connectedCount = 0;
+
+void halStepperInit() { engine.init(); }
+
+HalStepper *halStepperConnect(uint8_t stepPin) {
+  // FastAccelStepper cannot release a pin, so reuse its earlier connection
+  for (uint8_t i = 0; i < connectedCount; i++) {
+    if (stepPins[i] == stepPin) return &handles[i];
+  }
+  if (connectedCount >= MAX_STEPPERS) return nullptr;
+
+  FastAccelStepper *stepper = engine.stepperConnectToPin(stepPin);
+  if (!stepper) return nullptr;
+
+  uint8_t slot = connectedCount++;
+  backends[slot] = stepper;
+  stepPins[slot] = stepPin;
+  handles[slot].slot_ = slot;
+  return &handles[slot];
+}
+
+void HalStepper::setDirectionPin(uint8_t pin) {
+  backends[slot_]->setDirectionPin(pin);
+}
+
+void HalStepper::setEnablePin(uint8_t pin) {
+  backends[slot_]->setEnablePin(pin);
+}
+
+void HalStepper::setAutoEnable(bool autoEnable) {
+  backends[slot_]->setAutoEnable(autoEnable);
+}
+
+void HalStepper::disableOutputs() { backends[slot_]->disableOutputs(); }
+
+void HalStepper::setSpeedInHz(uint32_t stepsPerSecond) {
+  backends[slot_]->setSpeedInHz(stepsPerSecond);
+}
+
+void HalStepper::setAcceleration(int32_t stepsPerSecond2) {
+  backends[slot_]->setAcceleration(stepsPerSecond2);
+}
+
+void HalStepper::moveTo(int32_t position) { backends[slot_]->moveTo(position); }
+
+int32_t HalStepper::getCurrentPosition() {
+  return backends[slot_]->getCurrentPosition();
+}
+
+void HalStepper::setCurrentPosition(int32_t position) {
+  backends[slot_]->setCurrentPosition(position);
+}
+
+bool HalStepper::isRunning() { return backends[slot_]->isRunning(); }
+
+void HalStepper::forceStop() { backends[slot_]->forceStop(); }
+
+void HalStepper::forceStopAndNewPosition(int32_t position) {
+  backends[slot_]->forceStopAndNewPosition(position);
+}
+
+#endif  // EVERWOOD_NATIVE
@@ -0,0 +1,33 @@
+#ifndef EVERWOOD_NATIVE
+
+#include <esp_timer.h>
+
+#include "../hal_timer.h"
+
+// A HalTimer is the esp_timer handle itself; no extra state is needed
+static esp_timer_handle_t handleOf(HalTimer *timer) {
+  return reinterpret_cast<esp_timer_handle_t>(timer);
+}
+
+HalTimer *halTimerCreate(const char *name, HalTimerCallback callback,
+                         void *arg) {
+  esp_timer_create_args_t args = {};
+  args.callback = callback;
+  args.arg = arg;
+  args.name = name;
+  esp_timer_handle_t handle = nullptr;
+  if (esp_timer_create(&args, &handle) != ESP_OK) return nullptr;
+  return reinterpret_cast<HalTimer *>(handle);
+}
+
+bool halTimerStartPeriodic(HalTimer *timer, uint64_t periodUs) {
+  return esp_timer_start_periodic(handleOf(timer), periodUs) == ESP_OK;
+}
+
+bool halTimerStartOnce(HalTimer *timer, uint64_t delayUs) {
+  return esp_timer_start_once(handleOf(timer), delayUs) == ESP_OK;
+}
+
+void halTimerStop(HalTimer *timer) { esp_timer_stop(handleOf(timer)); }
+
+#endif  // EVERWOOD_NATIVE
@@ -0,0 +1,88 @@
+#ifndef EVERWOOD_NATIVE
+
+#include <AsyncWebSocket.h>
+
+#include "../../network/udp_transport.h"
+#include "../hal_transport.h"
+
+extern AsyncWebSocket ws;
+extern AsyncWebSocket wsControl;
+extern AsyncWebSocket wsTelemetry;
+
+static AsyncWebSocket &socketFor(TransportEndpoint endpoint) {
+  switch (endpoint) {
+    case ENDPOINT_CONTROL:
+      return wsControl;
+    case ENDPOINT_TELEMETRY:
+      return wsTelemetry;
+    default:
+      return ws;
+  }
+}
+
+// WebSocket endpoints a broadcast to this address reaches
+static bool reachesControl(uint32_t address) {
+  return transportEndpoint(address) != ENDPOINT_TELEMETRY;
+}
+
+static bool reachesTelemetry(uint32_t address) {
+  return transportEndpoint(address) != ENDPOINT_CONTROL;
+}
+
+void transportSendText(uint32_t address, const String &text) {
+  uint32_t socketId = transportSocketId(address);
+  if (socketId == 0) {
+    ws.textAll(text);
+    if (reachesControl(address)) wsControl.textAll(text);
+    if (reachesTelemetry(address)) wsTelemetry.textAll(text);
+    udpSendText(address, text);
+  } else if (transportEndpoint(address) == ENDPOINT_UDP) {
+    udpSendText(address, text);
+  } else if (AsyncWebSocketClient *client =
+                 socketFor(transportEndpoint(address)).client(socketId)) {
+    client->text(text);
+  }
+}
+
+// Binary frames (streams, dumps, captures) are not carried over UDP
+void transportSendBinary(uint32_t address, const uint8_t *data, size_t len) {
+  uint32_t socketId = transportSocketId(address);
+  if (transportEndpoint(address) == ENDPOINT_UDP) return;
+  if (socketId == 0) {
+    ws.binaryAll(data, len);
+    if (reachesControl(address)) wsControl.binaryAll(data, len);
+    if (reachesTelemetry(address)) wsTelemetry.binaryAll(data, len);
+  } else if (AsyncWebSocketClient *client =
+                 socketFor(transportEndpoint(address)).client(socketId)) {
+    client->binary(data, len);
+  }
+}
+
+bool transportBroadcastReady(uint32_t address) {
+  size_t recipients = ws.count();
+  bool ready = ws.count() == 0 || ws.availableForWriteAll();
+  if (reachesControl(address) && wsControl.count() > 0) {
+    recipients += wsControl.count();
+    ready = ready && wsControl.availableForWriteAll();
+  }
+  if (reachesTelemetry(address) && wsTelemetry.count() > 0) {
+    recipients += wsTelemetry.count();
+    ready = ready && wsTelemetry.availableForWriteAll();
+  }
+  return recipients > 0 && ready;
+}
+
+uint32_t transportAddressOf(AsyncWebSocketClient *client) {
+  AsyncWebSocket *server = client->server();
+  TransportEndpoint endpoint = ENDPOINT_DEFAULT;
+  if (server == &wsControl) endpoint = ENDPOINT_CONTROL;
+  if (server == &wsTelemetry) endpoint = ENDPOINT_TELEMETRY;
+  return transportAddress(endpoint, client->id());
+}
+
+size_t transportClientCount() {
+  return ws.count() + wsControl.count() + wsTelemetry.count() +
+         udpPeerCount();
+}
+
+#endif  // EVERWOOD_NATIVE
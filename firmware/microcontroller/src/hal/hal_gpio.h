@@ -0,0 +1,31 @@
+#ifndef HAL_GPIO_H
+#define HAL_GPIO_H
+
+#include <stdint.h>
+
+// --- GPIO and ADC ---
+// Pin access for modules that must also run in the native build, where the
+// pins are simulated (hal/native/sim.h). The interrupt- and timer-driven
+// paths (input_events, pulse_output, pin_capture) stay ESP32-only.
+
+enum HalPinMode : uint8_t {
+  HAL_PIN_INPUT = 0,
+  HAL_PIN_INPUT_PULLUP,
+  HAL_PIN_INPUT_PULLDOWN,
+  HAL_PIN_OUTPUT
+};
+
+void halPinMode(uint8_t pin, HalPinMode mode);
+int halDigitalRead(uint8_t pin);  // LOW (0) or HIGH (1)
+void halDigitalWrite(uint8_t pin, int level);
+int halAnalogRead(uint8_t pin);  // Raw 12-bit conversion
+
+// Every GPIO input level at once (bit n = GPIO n); two register loads on the
+// ESP32
+uint64_t halReadInputs();
+
+// Drive the outputs in setMask high and those in clearMask low through the
+// write-1-to-set/clear registers, leaving every other output untouched
+void halWriteOutputs(uint64_t setMask, uint64_t clearMask);
+
+#endif  // HAL_GPIO_H
@@ -0,0 +1,43 @@
+#ifndef HAL_LEDC_H
+#define HAL_LEDC_H
+
+#include <stdint.h>
+
+#ifndef EVERWOOD_NATIVE
+#include <soc/soc_caps.h>
+#endif
+
+// --- LEDC (PWM) ---
+// Channels actually present (the ESP32-S3 has no high-speed LEDC group).
+// The native build simulates the classic ESP32's 16 channels.
+#if defined(EVERWOOD_NATIVE)
+const int LEDC_CHANNEL_COUNT = 16;
+const int LEDC_MAX_RESOLUTION_BITS = 20;
+#elif defined(SOC_LEDC_SUPPORT_HS_MODE)
+const int LEDC_CHANNEL_COUNT = SOC_LEDC_CHANNEL_NUM * 2;
+const int LEDC_MAX_RESOLUTION_BITS = SOC_LEDC_TIMER_BIT_WIDE_NUM;
+#else
+const int LEDC_CHANNEL_COUNT = SOC_LEDC_CHANNEL_NUM;
+const int LEDC_MAX_RESOLUTION_BITS = SOC_LEDC_TIMER_BIT_WIDE_NUM;
+#endif
+
+// Configure a channel's timer. Returns the frequency actually set, or 0 if
+// the frequency/resolution pair is not possible.
+uint32_t halLedcSetup(uint8_t channel, uint32_t frequency, uint8_t bits);
+void halLedcAttachPin(uint8_t pin, uint8_t channel);
+void halLedcDetachPin(uint8_t pin);
+void halLedcWrite(uint8_t channel, uint32_t duty);
+
+// Hardware fades. onEnd is called with the channel when a fade finishes:
+// from the fade-end interrupt on the ESP32, from the virtual clock natively.
+typedef void (*HalLedcFadeCallback)(uint8_t channel);
+bool halLedcFadeStart(uint8_t channel, uint32_t duty, uint32_t durationMs,
+                      HalLedcFadeCallback onEnd);
+
+// Stop a running fade at its current duty
+void halLedcFadeStop(uint8_t channel);
+
+// Duty the channel outputs right now, mid-fade included
+uint32_t halLedcGetDuty(uint8_t channel);
+
+#endif  // HAL_LEDC_H
@@ -0,0 +1,22 @@
+#ifndef HAL_SERVO_H
+#define HAL_SERVO_H
+
+#include <stdint.h>
+
+// --- Servo Backend ---
+// ServoESP32 on the ESP32, simulated in the native build. A HalServo is
+// small enough to live inside ServoConfig; the driver state behind it is
+// taken from a fixed table on attach and returned on detach.
+class HalServo {
+ public:
+  bool attach(uint8_t pin, int channel, int minAngle, int maxAngle,
+              int minPulseUs, int maxPulseUs, int frequencyHz);
+  bool attached() const { return slot_ >= 0; }
+  void write(int angle);
+  void detach();
+
+ private:
+  int8_t slot_ = -1;
+};
+
+#endif  // HAL_SERVO_H
@@ -0,0 +1,45 @@
+#ifndef HAL_STEPPER_H
+#define HAL_STEPPER_H
+
+#include <stdint.h>
+
+// --- Stepper Pulse Backend ---
+// Step generation with trapezoidal acceleration ramps. FastAccelStepper on
+// the ESP32; the native build integrates the same ramps against the virtual
+// clock. Handles live in a fixed table, so a pointer stays valid for the
+// life of the program.
+class HalStepper {
+ public:
+  void setDirectionPin(uint8_t pin);
+  void setEnablePin(uint8_t pin);
+  void setAutoEnable(bool autoEnable);
+  void disableOutputs();
+
+  void setSpeedInHz(uint32_t stepsPerSecond);
+  void setAcceleration(int32_t stepsPerSecond2);
+
+  // Start a move to an absolute position (returns immediately)
+  void moveTo(int32_t position);
+  int32_t getCurrentPosition();
+  void setCurrentPosition(int32_t position);
+  bool isRunning();
+
+  // Stop without a ramp, optionally redefining the current position
+  void forceStop();
+  void forceStopAndNewPosition(int32_t position);
+
+  uint8_t slot() const { return slot_; }
+
+ private:
+  friend HalStepper *halStepperConnect(uint8_t stepPin);
+  uint8_t slot_ = 0;
+};
+
+// Start the step generator (call once in setup())
+void halStepperInit();
+
+// Handle for the stepper on stepPin, connecting it on first use. Returns
+// nullptr if the pin cannot generate steps or no backend is left.
+HalStepper *halStepperConnect(uint8_t stepPin);
+
+#endif  // HAL_STEPPER_H
@@ -0,0 +1,32 @@
+#ifndef HAL_TIMER_H
+#define HAL_TIMER_H
+
+#include <stdint.h>
+
+#ifndef EVERWOOD_NATIVE
+#include <esp_timer.h>
+#endif
+
+// --- Clock and Software Timers ---
+// esp_timer on the ESP32; in the native build time only moves when the
+// simulation advances the virtual clock, and due timers fire from there.
+
+typedef void (*HalTimerCallback)(void *arg);
+struct HalTimer;  // Opaque
+
+// Microseconds since boot (monotonic). Inline on the ESP32 so it stays
+// usable from ISRs and costs no more than esp_timer_get_time().
+#ifdef EVERWOOD_NATIVE
+int64_t halTimeUs();
+#else
+inline int64_t halTimeUs() { return esp_timer_get_time(); }
+#endif
+
+// Create a stopped timer. Returns nullptr on failure.
+HalTimer *halTimerCreate(const char *name, HalTimerCallback callback,
+                         void *arg);
+bool halTimerStartPeriodic(HalTimer *timer, uint64_t periodUs);
+bool halTimerStartOnce(HalTimer *timer, uint64_t delayUs);
+void halTimerStop(HalTimer *timer);
+
+#endif  // HAL_TIMER_H
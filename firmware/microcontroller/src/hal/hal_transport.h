@@ -0,0 +1,68 @@
+#ifndef HAL_TRANSPORT_H
+#define HAL_TRANSPORT_H
+
+#include <Arduino.h>
+#include <AsyncWebSocket.h>
+
+// --- Message Transport ---
+// Sends already-serialized messages to WebSocket clients (AsyncWebSocket on
+// the ESP32, a sink set by the simulation in the native build).
+//
+// Clients connect to one of three endpoints:
+//   /ws            everything (existing UIs)
+//   /ws/control    commands, their replies and actionComplete events; its
+//                  commands take the priority lane (see system/tasks.h)
+//   /ws/telemetry  position and pin reports, controlStatus and streams
+// and, when enabled, UDP peers (network/udp_transport.h), which get text
+// messages only. Every AsyncWebSocket numbers its clients from 1, so a
+// client address carries the endpoint in its top bits. Socket id 0
+// broadcasts: to every endpoint for ENDPOINT_DEFAULT, otherwise to /ws, UDP
+// peers and that endpoint.
+
+enum TransportEndpoint : uint8_t {
+  ENDPOINT_DEFAULT = 0,
+  ENDPOINT_CONTROL = 1,
+  ENDPOINT_TELEMETRY = 2,
+  ENDPOINT_UDP = 3
+};
+
+const uint8_t TRANSPORT_ENDPOINT_SHIFT = 28;
+const uint32_t TRANSPORT_SOCKET_MASK = (1u << TRANSPORT_ENDPOINT_SHIFT) - 1;
+
+inline uint32_t transportAddress(TransportEndpoint endpoint,
+                                 uint32_t socketId) {
+  return ((uint32_t)endpoint << TRANSPORT_ENDPOINT_SHIFT) |
+         (socketId & TRANSPORT_SOCKET_MASK);
+}
+
+inline TransportEndpoint transportEndpoint(uint32_t address) {
+  return (TransportEndpoint)(address >> TRANSPORT_ENDPOINT_SHIFT);
+}
+
+inline uint32_t transportSocketId(uint32_t address) {
+  return address & TRANSPORT_SOCKET_MASK;
+}
+
+// Broadcast to /ws and /ws/telemetry
+const uint32_t TRANSPORT_TELEMETRY_BROADCAST =
+    (uint32_t)ENDPOINT_TELEMETRY << TRANSPORT_ENDPOINT_SHIFT;
+
+void transportSendText(uint32_t address, const String &text);
+void transportSendBinary(uint32_t address, const uint8_t *data, size_t len);
+
+// Client objects are owned by the AsyncTCP task and freed by
+// cleanupClients(), so they are only touched from the AsyncTCP task (event
+// handlers) and the network task (the functions here). Other tasks pass
+// addresses around and queue their messages for the network task.
+
+// True when a broadcast to address has at least one recipient and every
+// recipient can take another frame without queueing (network task)
+bool transportBroadcastReady(uint32_t address);
+
+// Address of a connected client (AsyncTCP event handlers)
+uint32_t transportAddressOf(AsyncWebSocketClient *client);
+
+// Connected clients on all endpoints, UDP peers included
+size_t transportClientCount();
+
+#endif  // HAL_TRANSPORT_H
@@ -0,0 +1,225 @@
+#ifndef EVERWOOD_NATIVE_ARDUINO_H
+#define EVERWOOD_NATIVE_ARDUINO_H
+
+// --- Arduino Compatibility (native builds) ---
+// The subset of the Arduino core the portable firmware modules use, on top
+// of the standard library and the HAL's virtual clock. Only on the include
+// path of the native env.
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "../../hal_timer.h"
+#include "../sim.h"
+
+#define HIGH 1
+#define LOW 0
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define F(text) (text)
+
+using std::max;
+using std::min;
+
+template <typename T, typename L, typename H>
+inline T constrain(T value, L low, H high) {
+  return value < low ? low : (value > high ? high : value);
+}
+
+inline unsigned long millis() { return (unsigned long)(halTimeUs() / 1000); }
+inline unsigned long micros() { return (unsigned long)halTimeUs(); }
+inline void delay(unsigned long ms) { simAdvanceUs((uint64_t)ms * 1000); }
+
+// Heap-backed like the device String: every non-empty value owns an
+// allocation and each growing append reallocates to the exact length, so
+// allocation counts on the host follow the firmware's (std::string would
+// keep short values inline)
+class String {
+ public:
+  String() {}
+  String(const char *text) { *this = text; }
+  String(const std::string &text) { assign(text.data(), text.size()); }
+  String(char c) { assign(&c, 1); }
+  String(int value) : String(std::to_string(value)) {}
+  String(unsigned int value) : String(std::to_string(value)) {}
+  String(long value) : String(std::to_string(value)) {}
+  String(unsigned long value) : String(std::to_string(value)) {}
+  String(float value, unsigned char decimals = 2) { format(value, decimals); }
+  String(double value, unsigned char decimals = 2) { format(value, decimals); }
+
+  String(const String &other) { assign(other.c_str(), other.length_); }
+  String(String &&other) noexcept
+      : buffer_(other.buffer_),
+        capacity_(other.capacity_),
+        length_(other.length_) {
+    other.buffer_ = nullptr;
+    other.capacity_ = other.length_ = 0;
+  }
+  ~String() { delete[] buffer_; }
+
+  String &operator=(const String &other) {
+    if (this != &other) assign(other.c_str(), other.length_);
+    return *this;
+  }
+  String &operator=(String &&other) noexcept {
+    if (this == &other) return *this;
+    delete[] buffer_;
+    buffer_ = other.buffer_;
+    capacity_ = other.capacity_;
+    length_ = other.length_;
+    other.buffer_ = nullptr;
+    other.capacity_ = other.length_ = 0;
+    return *this;
+  }
+  String &operator=(const char *text) {
+    assign(text ? text : "", text ? strlen(text) : 0);
+    return *this;
+  }
+
+  const char *c_str() const { return buffer_ ? buffer_ : ""; }
+  unsigned int length() const { return length_; }
+  bool isEmpty() const { return length_ == 0; }
+  void reserve(unsigned int size) {
+    if (size > capacity_) resize(size);
+  }
+
+  bool concat(const String &other) {
+    return append(other.c_str(), other.length_);
+  }
+  bool concat(const char *text) {
+    return text ? append(text, strlen(text)) : true;
+  }
+  bool concat(char c) { return append(&c, 1); }
+  String &operator+=(const String &other) {
+    concat(other);
+    return *this;
+  }
+  String &operator+=(const char *text) {
+    concat(text);
+    return *this;
+  }
+  String &operator+=(char c) {
+    concat(c);
+    return *this;
+  }
+
+  bool operator==(const String &other) const {
+    return length_ == other.length_ &&
+           memcmp(c_str(), other.c_str(), length_) == 0;
+  }
+  bool operator==(const char *text) const {
+    return strcmp(c_str(), text ? text : "") == 0;
+  }
+  bool operator!=(const String &other) const { return !(*this == other); }
+  bool operator!=(const char *text) const { return !(*this == text); }
+
+ private:
+  void format(double value, unsigned char decimals) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    assign(buffer, strlen(buffer));
+  }
+
+  // Move to a new allocation of exactly capacity characters
+  void resize(size_t capacity) {
+    char *buffer = new char[capacity + 1];
+    memcpy(buffer, c_str(), length_ + 1);
+    delete[] buffer_;
+    buffer_ = buffer;
+    capacity_ = capacity;
+  }
+
+  void assign(const char *text, size_t length) {
+    if (length > capacity_) {
+      char *buffer = new char[length + 1];
+      memcpy(buffer, text, length);
+      delete[] buffer_;
+      buffer_ = buffer;
+      capacity_ = length;
+    } else if (length > 0) {
+      memmove(buffer_, text, length);
+    }
+    length_ = length;
+    if (buffer_) buffer_[length_] = 0;
+  }
+
+  // text may point into this string's own buffer
+  bool append(const char *text, size_t length) {
+    if (length == 0) return true;
+    size_t total = length_ + length;
+    if (total > capacity_) {
+      char *buffer = new char[total + 1];
+      memcpy(buffer, c_str(), length_);
+      memcpy(buffer + length_, text, length);
+      delete[] buffer_;
+      buffer_ = buffer;
+      capacity_ = total;
+    } else {
+      memmove(buffer_ + length_, text, length);
+    }
+    length_ = total;
+    buffer_[length_] = 0;
+    return true;
+  }
+
+  char *buffer_ = nullptr;
+  size_t capacity_ = 0;
+  size_t length_ = 0;
+};
+
+// Result of String concatenation (ArduinoJson adapts both types)
+class StringSumHelper : public String {
+ public:
+  StringSumHelper(const String &text) : String(text) {}
+};
+
+inline StringSumHelper operator+(const String &left, const String &right) {
+  StringSumHelper sum(left);
+  sum.concat(right);
+  return sum;
+}
+inline StringSumHelper operator+(const String &left, const char *right) {
+  StringSumHelper sum(left);
+  sum.concat(right);
+  return sum;
+}
+
+// Serial writes to stdout, or to another stream set with setOutput (for
+// example /dev/null while benchmarking)
+class HostSerial {
+ public:
+  void begin(unsigned long baud) {}
+  void setOutput(FILE *out) { out_ = out; }
+  size_t print(const char *text) {
+    return fputs(text, out()) >= 0 ? strlen(text) : 0;
+  }
+  size_t print(const String &text) { return print(text.c_str()); }
+  size_t println(const char *text = "") {
+    size_t written = print(text);
+    fputc('\n', out());
+    return written + 1;
+  }
+  size_t println(const String &text) { return println(text.c_str()); }
+  int printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, format);
+    int written = vfprintf(out(), format, args);
+    va_end(args);
+    return written;
+  }
+
+ private:
+  FILE *out() const { return out_ ? out_ : stdout; }
+  FILE *out_ = nullptr;
+};
+
+extern HostSerial Serial;
+
+#endif  // EVERWOOD_NATIVE_ARDUINO_H
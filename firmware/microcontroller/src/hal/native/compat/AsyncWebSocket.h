@@ -0,0 +1,17 @@
+#ifndef EVERWOOD_NATIVE_ASYNC_WEB_SOCKET_H
+#define EVERWOOD_NATIVE_ASYNC_WEB_SOCKET_H
+
+#include <stdint.h>
+
+// --- AsyncWebSocket Compatibility (native builds) ---
+// Handlers only need a client's id; replies go through hal/hal_transport.h.
+class AsyncWebSocketClient {
+ public:
+  explicit AsyncWebSocketClient(uint32_t id) : id_(id) {}
+  uint32_t id() const { return id_; }
+
+ private:
+  uint32_t id_;
+};
+
+#endif  // EVERWOOD_NATIVE_ASYNC_WEB_SOCKET_H
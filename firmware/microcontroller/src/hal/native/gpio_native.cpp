@@ -0,0 +1,175 @@
+#ifdef EVERWOOD_NATIVE
+
+#include "../hal_gpio.h"
+#include "../hal_ledc.h"
+#include "../hal_timer.h"
+#include "sim.h"
+
+struct SimPin {
+  HalPinMode mode;
+  int outputLevel;
+  int inputLevel;  // -1 = not driven, reads as the pull resistor
+  int analogValue;
+  int ledcChannel;  // -1 = not attached
+};
+
+struct SimLedcChannel {
+  uint32_t frequency;
+  uint8_t bits;
+  uint32_t duty;
+
+  // A running fade moves linearly from fadeFrom to fadeTo
+  bool fading;
+  uint32_t fadeFrom;
+  uint32_t fadeTo;
+  int64_t fadeStartUs;
+  int64_t fadeDurationUs;
+  HalLedcFadeCallback onFadeEnd;
+  HalTimer *fadeTimer;  // Created on the channel's first fade
+};
+
+static SimPin pins[SIM_GPIO_COUNT];
+static SimLedcChannel channels[LEDC_CHANNEL_COUNT];
+static bool pinsInitialized = false;
+
+// Pins power up as undriven inputs
+static SimPin *simPin(uint8_t pin) {
+  if (!pinsInitialized) {
+    for (SimPin &entry : pins) entry = {HAL_PIN_INPUT, 0, -1, 0, -1};
+    pinsInitialized = true;
+  }
+  return pin < SIM_GPIO_COUNT ? &pins[pin] : nullptr;
+}
+
+void halPinMode(uint8_t pin, HalPinMode mode) {
+  if (SimPin *entry = simPin(pin)) entry->mode = mode;
+}
+
+int halDigitalRead(uint8_t pin) {
+  SimPin *entry = simPin(pin);
+  if (!entry) return 0;
+  if (entry->mode == HAL_PIN_OUTPUT) return entry->outputLevel;
+  if (entry->inputLevel >= 0) return entry->inputLevel;
+  return entry->mode == HAL_PIN_INPUT_PULLUP ? 1 : 0;
+}
+
+void halDigitalWrite(uint8_t pin, int level) {
+  if (SimPin *entry = simPin(pin)) entry->outputLevel = level ? 1 : 0;
+}
+
+int halAnalogRead(uint8_t pin) {
+  SimPin *entry = simPin(pin);
+  return entry ? entry->analogValue : 0;
+}
+
+uint64_t halReadInputs() {
+  uint64_t levels = 0;
+  for (uint8_t pin = 0; pin < SIM_GPIO_COUNT; pin++) {
+    if (halDigitalRead(pin)) levels |= 1ULL << pin;
+  }
+  return levels;
+}
+
+void halWriteOutputs(uint64_t setMask, uint64_t clearMask) {
+  for (uint8_t pin = 0; pin < SIM_GPIO_COUNT; pin++) {
+    uint64_t bit = 1ULL << pin;
+    if (setMask & bit) {
+      halDigitalWrite(pin, 1);
+    } else if (clearMask & bit) {
+      halDigitalWrite(pin, 0);
+    }
+  }
+}
+
+void simSetDigitalInput(uint8_t pin, int level) {
+  if (SimPin *entry = simPin(pin)) entry->inputLevel = level ? 1 : 0;
+}
+
+void simSetAnalogInput(uint8_t pin, int value) {
+  if (SimPin *entry = simPin(pin)) entry->analogValue = value;
+}
+
+int simGetDigitalOutput(uint8_t pin) {
+  SimPin *entry = simPin(pin);
+  return entry ? entry->outputLevel : 0;
+}
+
+// Same limit as the ESP32: the 80 MHz APB clock divided into 2^bits steps
+uint32_t halLedcSetup(uint8_t channel, uint32_t frequency, uint8_t bits) {
+  if (channel >= LEDC_CHANNEL_COUNT || bits == 0 || bits > 20) return 0;
+  if ((uint64_t)frequency << bits > 80000000ULL) return 0;
+  HalTimer *fadeTimer = channels[channel].fadeTimer;
+  channels[channel] = SimLedcChannel();
+  channels[channel].frequency = frequency;
+  channels[channel].bits = bits;
+  channels[channel].fadeTimer = fadeTimer;
+  return frequency;
+}
+
+void halLedcAttachPin(uint8_t pin, uint8_t channel) {
+  if (SimPin *entry = simPin(pin)) entry->ledcChannel = channel;
+}
+
+void halLedcDetachPin(uint8_t pin) {
+  if (SimPin *entry = simPin(pin)) entry->ledcChannel = -1;
+}
+
+void halLedcWrite(uint8_t channel, uint32_t duty) {
+  if (channel < LEDC_CHANNEL_COUNT) channels[channel].duty = duty;
+}
+
+// Duty of a fade in progress at the current virtual time
+static uint32_t fadeDuty(const SimLedcChannel &entry) {
+  int64_t elapsedUs = halTimeUs() - entry.fadeStartUs;
+  if (elapsedUs >= entry.fadeDurationUs) return entry.fadeTo;
+  int64_t span = (int64_t)entry.fadeTo - (int64_t)entry.fadeFrom;
+  return (uint32_t)(entry.fadeFrom + span * elapsedUs / entry.fadeDurationUs);
+}
+
+// Fade timer: the fade reached its target duty
+static void onSimFadeEnd(void *arg) {
+  uint8_t channel = (uint8_t)(uintptr_t)arg;
+  SimLedcChannel &entry = channels[channel];
+  if (!entry.fading) return;
+  entry.fading = false;
+  entry.duty = entry.fadeTo;
+  if (entry.onFadeEnd) entry.onFadeEnd(channel);
+}
+
+bool halLedcFadeStart(uint8_t channel, uint32_t duty, uint32_t durationMs,
+                      HalLedcFadeCallback onEnd) {
+  if (channel >= LEDC_CHANNEL_COUNT) return false;
+  SimLedcChannel &entry = channels[channel];
+  if (!entry.fadeTimer) {
+    entry.fadeTimer =
+        halTimerCreate("ledc_fade", onSimFadeEnd, (void *)(uintptr_t)channel);
+    if (!entry.fadeTimer) return false;
+  }
+  halLedcFadeStop(channel);
+  entry.fading = true;
+  entry.fadeFrom = entry.duty;
+  entry.fadeTo = duty;
+  entry.fadeStartUs = halTimeUs();
+  entry.fadeDurationUs = durationMs ? (int64_t)durationMs * 1000 : 1;
+  entry.onFadeEnd = onEnd;
+  return halTimerStartOnce(entry.fadeTimer, entry.fadeDurationUs);
+}
+
+void halLedcFadeStop(uint8_t channel) {
+  if (channel >= LEDC_CHANNEL_COUNT) return;
+  SimLedcChannel &entry = channels[channel];
+  if (!entry.fading) return;
+  entry.duty = fadeDuty(entry);
+  entry.fading = false;
+  halTimerStop(entry.fadeTimer);
+}
+
+uint32_t halLedcGetDuty(uint8_t channel) {
+  if (channel >= LEDC_CHANNEL_COUNT) return 0;
+  const SimLedcChannel &entry = channels[channel];
+  return entry.fading ? fadeDuty(entry) : entry.duty;
+}
+
+uint32_t simGetLedcDuty(uint8_t channel) { return halLedcGetDuty(channel); }
+
+#endif  // EVERWOOD_NATIVE
@@ -0,0 +1,49 @@
+#ifdef EVERWOOD_NATIVE
+
+// --- Host Runtime ---
+// Globals the firmware modules expect from main.cpp and message_handler.cpp,
+// shared by the native programs (native_main.cpp, bench/).
+
+#include <Arduino.h>
+
+#include <cstdarg>
+
+#include "../../system/tasks.h"
+#include "../hal_transport.h"
+
+HostSerial Serial;
+
+// Same helpers the ESP32 build defines in message_handler.cpp, without the
+// outbound queues (native programs run on one thread)
+void broadcastWebSocketMessage(const String &message) {
+  transportSendText(0, message);
+}
+
+// The native runner has a single endpoint, so telemetry is a plain broadcast
+void broadcastTelemetryMessage(const String &message) {
+  transportSendText(0, message);
+}
+
+void sendWebSocketMessage(uint32_t clientId, const String &message) {
+  if (clientId == 0) return;
+  transportSendText(clientId, message);
+}
+
+// Log lines go straight to Serial; there is no logging task
+void logLine(const char *prefix, const String &text) {
+  Serial.print(prefix);
+  Serial.println(text);
+}
+
+void logPrintf(const char *format, ...) {
+  char text[LOG_LINE_MAX_BYTES];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  size_t length = strlen(text);
+  if (length > 0 && text[length - 1] == '\n') text[length - 1] = '\0';
+  Serial.println(text);
+}
+
+#endif  // EVERWOOD_NATIVE
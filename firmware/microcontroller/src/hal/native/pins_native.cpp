@@ -0,0 +1,149 @@
+#ifdef EVERWOOD_NATIVE
+
+// --- Pin Peripherals (native) ---
+// Stand-ins for the pin modules built on ESP32-only peripherals (DMA ADC,
+// PCNT, GPIO interrupts, hardware timers), so io_pin.cpp and the pins handler
+// run against the simulated pins. Analog inputs are polled with single
+// conversions, as the ESP32 build does for pins off ADC1. Interrupt-driven
+// inputs fall back to the batched scanner, counters cannot be attached, and
+// pulse, capture and stream requests are refused.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "../../hardware/adc_engine.h"
+#include "../../hardware/analog_stream.h"
+#include "../../hardware/input_events.h"
+#include "../../hardware/io_pin.h"
+#include "../../hardware/pin_capture.h"
+#include "../../hardware/pulse_counter.h"
+#include "../../hardware/pulse_output.h"
+#include "../../util/poll_tables.h"
+#include "../hal_gpio.h"
+
+extern void sendWebSocketMessage(uint32_t clientId, const String &message);
+
+// --- Analog inputs ---
+
+static AnalogPollTable polledInputs;
+static bool pollTableDirty = true;
+
+static void rebuildPollTable() {
+  polledInputs.clear();
+  uint32_t now = millis();
+  for (size_t i = 0; i < configuredPins.capacity(); i++) {
+    if (!configuredPins.inUse(i)) continue;
+    const IoPinConfig &pin = configuredPins[i];
+    if (pin.kind != PIN_KIND_ANALOG_INPUT) continue;
+    polledInputs.add((uint16_t)i, pin.pin, pin.adcDeadband, now);
+  }
+  pollTableDirty = false;
+}
+
+void invalidateAdcEngine() { pollTableDirty = true; }
+
+void updateAdcEngine() {
+  if (pollTableDirty) rebuildPollTable();
+
+  uint32_t now = millis();
+  for (size_t i = 0; i < polledInputs.size(); i++) {
+    if (!deadlineReached(now, polledInputs.nextDeadlineMs[i])) continue;
+    polledInputs.nextDeadlineMs[i] = now + analogInputReadInterval;
+
+    IoPinConfig &pin = configuredPins[polledInputs.pinIndex[i]];
+    int value = halAnalogRead(polledInputs.gpio[i]);
+    if (pin.lastValue < 0 ||
+        abs(value - pin.lastValue) > polledInputs.deadband[i]) {
+      pin.lastValue = value;
+      broadcastPinValue(pin);
+    }
+  }
+}
+
+bool isAdcEnginePin(const IoPinConfig &pinConfig) { return false; }
+
+int8_t getAdcEngineChannel(const IoPinConfig &pinConfig) { return -1; }
+
+uint32_t getAdcChannelSampleRateMilliHz() { return 0; }
+
+int64_t getAdcEngineStartUs() { return 0; }
+
+uint16_t getAdcLatestRaw(int8_t channel) { return 0; }
+
+int getAdcEngineValue(const IoPinConfig &pinConfig) {
+  return halAnalogRead(pinConfig.pin);
+}
+
+uint32_t setAdcSampleRate(uint32_t sampleRateHz) { return sampleRateHz; }
+
+// --- Analog streaming ---
+
+bool startAnalogStream(IoPinConfig &pinConfig, uint16_t chunkSamples) {
+  return false;  // No pin is DMA-sampled
+}
+
+void stopAnalogStream(const IoPinConfig &pinConfig) {}
+
+void pushAnalogStreamSample(uint8_t channel, uint16_t raw,
+                            uint64_t sampleIndex) {}
+
+void flushAnalogStreams() {}
+
+// --- Interrupt-driven inputs ---
+
+bool attachPinInterrupt(IoPinConfig &pinConfig) {
+  Serial.printf("Pin %s: no interrupts in the native build, polling\n",
+                pinConfig.id.c_str());
+  pinConfig.useInterrupt = false;
+  return false;
+}
+
+void detachPinInterrupt(IoPinConfig &pinConfig) {}
+
+void processPinEdgeEvents() {}
+
+uint32_t getDroppedPinEdgeCount() { return 0; }
+
+// --- Pulse counters ---
+
+bool attachPulseCounter(IoPinConfig &pinConfig) {
+  Serial.printf("ERROR: No pulse counter for pin %s in the native build\n",
+                pinConfig.id.c_str());
+  return false;
+}
+
+void detachPulseCounter(IoPinConfig &pinConfig) {}
+
+void resetPulseCounter(IoPinConfig &pinConfig) {}
+
+int64_t getPulseCount(const IoPinConfig &pinConfig) { return 0; }
+
+float getPulseFrequency(const IoPinConfig &pinConfig) { return 0; }
+
+void invalidatePulseCounters() {}
+
+void updatePulseCounters() {}
+
+// --- Timed pulses ---
+
+void handlePinPulseRequest(uint32_t clientId, JsonDocument &doc) {
+  sendWebSocketMessage(
+      clientId, F("ERROR: Pulses are not simulated in the native build"));
+}
+
+bool cancelPinPulse(const IoPinConfig &pinConfig) { return false; }
+
+void updatePinPulses() {}
+
+// --- Triggered capture ---
+
+void handlePinCaptureRequest(uint32_t clientId, JsonDocument &doc) {
+  sendWebSocketMessage(
+      clientId, F("ERROR: Captures are not simulated in the native build"));
+}
+
+bool cancelPinCapture() { return false; }
+
+void updatePinCapture() {}
+
+#endif  // EVERWOOD_NATIVE
@@ -0,0 +1,56 @@
+#ifdef EVERWOOD_NATIVE
+
+#include "../../config.h"
+#include "../hal_servo.h"
+#include "sim.h"
+
+struct SimServo {
+  bool used;
+  uint8_t pin;
+  int minAngle;
+  int maxAngle;
+  int angle;
+};
+
+static SimServo servos[MAX_SERVOS];
+
+bool HalServo::attach(uint8_t pin, int channel, int minAngle, int maxAngle,
+                      int minPulseUs, int maxPulseUs, int frequencyHz) {
+  if (pin >= SIM_GPIO_COUNT || channel < 0 || channel >= LEDC_CHANNEL_COUNT ||
+      minAngle >= maxAngle || minPulseUs >= maxPulseUs || frequencyHz <= 0) {
+    return false;
+  }
+  if (slot_ < 0) {
+    for (int8_t i = 0; i < (int8_t)MAX_SERVOS; i++) {
+      if (!servos[i].used) {
+        slot_ = i;
+        break;
+      }
+    }
+    if (slot_ < 0) return false;
+  }
+  // An attached servo holds its position until written
+  servos[slot_] = {true, pin, minAngle, maxAngle, -1};
+  return true;
+}
+
+void HalServo::write(int angle) {
+  if (slot_ < 0) return;
+  SimServo &servo = servos[slot_];
+  servo.angle = constrain(angle, servo.minAngle, servo.maxAngle);
+}
+
+void HalServo::detach() {
+  if (slot_ < 0) return;
+  servos[slot_].used = false;
+  slot_ = -1;
+}
+
+int simGetServoAngle(uint8_t pin) {
+  for (const SimServo &servo : servos) {
+    if (servo.used && servo.pin == pin) return servo.angle;
+  }
+  return -1;
+}
+
+#endif  // EVERWOOD_NATIVE
@@ -0,0 +1,43 @@
+#ifndef HAL_NATIVE_SIM_H
+#define HAL_NATIVE_SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Native Simulation Controls ---
+// The native build runs the firmware against simulated hardware on a
+// virtual clock. Nothing moves until the simulation advances the clock:
+// timers fire in time order, steppers follow their acceleration ramps and
+// servos settle where they were written. Host tests and native_main drive
+// the simulation through these functions.
+
+const uint8_t SIM_GPIO_COUNT = 64;
+
+// Advance the virtual clock, firing due timers on the way
+void simAdvanceUs(uint64_t us);
+
+// Drive an input pin as an external device would (sensor, switch)
+void simSetDigitalInput(uint8_t pin, int level);
+void simSetAnalogInput(uint8_t pin, int value);
+
+// Level last written to an output pin
+int simGetDigitalOutput(uint8_t pin);
+
+// Duty an LEDC channel outputs now (follows a running fade)
+uint32_t simGetLedcDuty(uint8_t channel);
+
+// Angle last written to the servo on a pin, or -1 if none is attached or
+// it has not been written yet
+int simGetServoAngle(uint8_t pin);
+
+// Commanded speed of the stepper on a step pin in steps/s (signed, 0 if
+// stopped or not connected)
+float simGetStepperSpeed(uint8_t stepPin);
+
+// Receives every message the firmware sends (clientId 0 = broadcast)
+typedef void (*SimTransportSink)(uint32_t clientId, const uint8_t *data,
+                                 size_t len, bool binary);
+void simSetTransportSink(SimTransportSink sink);
+void simSetClientCount(size_t count);
+
+#endif  // HAL_NATIVE_SIM_H
@@ -0,0 +1,162 @@
+#ifdef EVERWOOD_NATIVE
+
+#include <math.h>
+
+#include "../../config.h"
+#include "../hal_stepper.h"
+#include "../hal_timer.h"
+#include "sim.h"
+
+// Ramps are integrated in steps of at most this long. FastAccelStepper
+// recomputes its speed every few milliseconds, so 50 us is well inside
+// the timing the firmware can observe.
+static const int64_t SIM_STEPPER_STEP_US = 50;
+
+struct SimStepper {
+  uint8_t stepPin;
+  uint8_t dirPin;
+  uint8_t enablePin;
+  bool autoEnable;
+  double position;      // Steps, fractional while moving
+  double speed;         // Steps/s, signed
+  int32_t target;
+  double maxSpeed;      // Steps/s
+  double acceleration;  // Steps/s², 0 = jump straight to maxSpeed
+  bool moving;
+  int64_t updatedUs;    // Virtual time the state was last integrated to
+};
+
+static SimStepper steppers[MAX_STEPPERS];
+static HalStepper handles[MAX_STEPPERS];
+static uint8_t connectedCount = 0;
+
+void halStepperInit() {}
+
+HalStepper *halStepperConnect(uint8_t stepPin) {
+  for (uint8_t i = 0; i < connectedCount; i++) {
+    if (steppers[i].stepPin == stepPin) return &handles[i];
+  }
+  if (connectedCount >= MAX_STEPPERS || stepPin >= SIM_GPIO_COUNT) {
+    return nullptr;
+  }
+
+  uint8_t slot = connectedCount++;
+  steppers[slot] = {};
+  steppers[slot].stepPin = stepPin;
+  steppers[slot].updatedUs = halTimeUs();
+  handles[slot].slot_ = slot;
+  return &handles[slot];
+}
+
+// Advance one stepper's trapezoidal ramp to the current virtual time
+static void integrate(SimStepper &s) {
+  const int64_t nowUs = halTimeUs();
+  while (s.moving && s.updatedUs < nowUs) {
+    int64_t stepUs = nowUs - s.updatedUs;
+    if (stepUs > SIM_STEPPER_STEP_US) stepUs = SIM_STEPPER_STEP_US;
+    s.updatedUs += stepUs;
+    const double dt = stepUs / 1e6;
+
+    const double remaining = s.target - s.position;
+    const double dir = remaining >= 0 ? 1.0 : -1.0;
+
+    if (s.acceleration <= 0) {
+      s.speed = dir * s.maxSpeed;
+    } else {
+      const double dv = s.acceleration * dt;
+      const bool towardTarget = s.speed * dir > 0;
+      const double stopDistance =
+          s.speed * s.speed / (2.0 * s.acceleration);
+      if (!towardTarget || stopDistance < fabs(remaining)) {
+        s.speed += dir * dv;  // Accelerate, or brake a move the wrong way
+      } else {
+        s.speed -= dir * dv;  // Decelerate into the target
+      }
+      if (fabs(s.speed) > s.maxSpeed) {
+        s.speed = s.speed > 0 ? s.maxSpeed : -s.maxSpeed;
+      }
+    }
+    s.position += s.speed * dt;
+
+    // Arrived: within half a step at a speed that stops inside one step
+    const double left = s.target - s.position;
+    const bool crossed = left * dir <= 0;
+    const double stopSpeed =
+        s.acceleration > 0 ? sqrt(2.0 * s.acceleration) : INFINITY;
+    if ((crossed || fabs(left) < 0.5) && fabs(s.speed) <= stopSpeed) {
+      s.position = s.target;
+      s.speed = 0;
+      s.moving = false;
+    }
+  }
+  s.updatedUs = nowUs;
+}
+
+static SimStepper &state(uint8_t slot) {
+  SimStepper &s = steppers[slot];
+  integrate(s);
+  return s;
+}
+
+void HalStepper::setDirectionPin(uint8_t pin) { state(slot_).dirPin = pin; }
+
+void HalStepper::setEnablePin(uint8_t pin) { state(slot_).enablePin = pin; }
+
+void HalStepper::setAutoEnable(bool autoEnable) {
+  state(slot_).autoEnable = autoEnable;
+}
+
+void HalStepper::disableOutputs() {}
+
+void HalStepper::setSpeedInHz(uint32_t stepsPerSecond) {
+  state(slot_).maxSpeed = stepsPerSecond;
+}
+
+void HalStepper::setAcceleration(int32_t stepsPerSecond2) {
+  state(slot_).acceleration = stepsPerSecond2 > 0 ? stepsPerSecond2 : 0;
+}
+
+void HalStepper::moveTo(int32_t position) {
+  SimStepper &s = state(slot_);
+  s.target = position;
+  s.moving = s.maxSpeed > 0 && (s.position != position || s.speed != 0);
+}
+
+int32_t HalStepper::getCurrentPosition() {
+  return (int32_t)lround(state(slot_).position);
+}
+
+// Like FastAccelStepper, a running move keeps its distance to go
+void HalStepper::setCurrentPosition(int32_t position) {
+  SimStepper &s = state(slot_);
+  const double shift = position - lround(s.position);
+  s.position += shift;
+  s.target += (int32_t)shift;
+}
+
+bool HalStepper::isRunning() { return state(slot_).moving; }
+
+void HalStepper::forceStop() {
+  SimStepper &s = state(slot_);
+  s.position = lround(s.position);
+  s.target = (int32_t)s.position;
+  s.speed = 0;
+  s.moving = false;
+}
+
+void HalStepper::forceStopAndNewPosition(int32_t position) {
+  SimStepper &s = state(slot_);
+  s.position = position;
+  s.target = position;
+  s.speed = 0;
+  s.moving = false;
+}
+
+float simGetStepperSpeed(uint8_t stepPin) {
+  for (uint8_t i = 0; i < connectedCount; i++) {
+    if (steppers[i].stepPin == stepPin) return (float)state(i).speed;
+  }
+  return 0;
+}
+
+#endif  // EVERWOOD_NATIVE
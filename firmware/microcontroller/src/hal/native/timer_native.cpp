@@ -0,0 +1,76 @@
+#ifdef EVERWOOD_NATIVE
+
+#include "../hal_timer.h"
+#include "sim.h"
+
+static const uint8_t MAX_SIM_TIMERS = 32;
+
+struct HalTimer {
+  const char *name;
+  HalTimerCallback callback;
+  void *arg;
+  bool armed;
+  uint64_t periodUs;  // 0 for one-shot timers
+  int64_t dueUs;
+};
+
+static HalTimer timers[MAX_SIM_TIMERS];
+static uint8_t timerCount = 0;
+static int64_t nowUs = 0;
+
+int64_t halTimeUs() { return nowUs; }
+
+HalTimer *halTimerCreate(const char *name, HalTimerCallback callback,
+                         void *arg) {
+  if (timerCount >= MAX_SIM_TIMERS) return nullptr;
+  HalTimer &timer = timers[timerCount++];
+  timer = {name, callback, arg, false, 0, 0};
+  return &timer;
+}
+
+bool halTimerStartPeriodic(HalTimer *timer, uint64_t periodUs) {
+  if (!timer || timer->armed || periodUs == 0) return false;
+  timer->armed = true;
+  timer->periodUs = periodUs;
+  timer->dueUs = nowUs + periodUs;
+  return true;
+}
+
+bool halTimerStartOnce(HalTimer *timer, uint64_t delayUs) {
+  if (!timer || timer->armed) return false;
+  timer->armed = true;
+  timer->periodUs = 0;
+  timer->dueUs = nowUs + delayUs;
+  return true;
+}
+
+void halTimerStop(HalTimer *timer) {
+  if (timer) timer->armed = false;
+}
+
+// Earliest armed timer due at or before limitUs, or nullptr
+static HalTimer *nextDueTimer(int64_t limitUs) {
+  HalTimer *next = nullptr;
+  for (uint8_t i = 0; i < timerCount; i++) {
+    HalTimer &timer = timers[i];
+    if (!timer.armed || timer.dueUs > limitUs) continue;
+    if (!next || timer.dueUs < next->dueUs) next = &timer;
+  }
+  return next;
+}
+
+void simAdvanceUs(uint64_t us) {
+  const int64_t endUs = nowUs + (int64_t)us;
+  while (HalTimer *timer = nextDueTimer(endUs)) {
+    nowUs = timer->dueUs;
+    if (timer->periodUs) {
+      timer->dueUs += timer->periodUs;
+    } else {
+      timer->armed = false;
+    }
+    timer->callback(timer->arg);
+  }
+  nowUs = endUs;
+}
+
+#endif  // EVERWOOD_NATIVE
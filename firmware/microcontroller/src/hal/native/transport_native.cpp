@@ -0,0 +1,33 @@
+#ifdef EVERWOOD_NATIVE
+
+#include "../hal_transport.h"
+#include "sim.h"
+
+static SimTransportSink transportSink = nullptr;
+static size_t clientCount = 1;
+
+void transportSendText(uint32_t clientId, const String &text) {
+  if (transportSink) {
+    transportSink(clientId, (const uint8_t *)text.c_str(), text.length(),
+                  false);
+  }
+}
+
+void transportSendBinary(uint32_t clientId, const uint8_t *data, size_t len) {
+  if (transportSink) transportSink(clientId, data, len, true);
+}
+
+bool transportBroadcastReady(uint32_t address) { return clientCount > 0; }
+
+// The native runner has no client registry; its ids are used as addresses
+uint32_t transportAddressOf(AsyncWebSocketClient *client) {
+  return client->id();
+}
+
+size_t transportClientCount() { return clientCount; }
+
+void simSetTransportSink(SimTransportSink sink) { transportSink = sink; }
+
+void simSetClientCount(size_t count) { clientCount = count; }
+
+#endif  // EVERWOOD_NATIVE
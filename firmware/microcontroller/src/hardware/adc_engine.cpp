@@ -0,0 +1,313 @@
+#include "adc_engine.h"
+
+#include <Arduino.h>
+#include <driver/adc.h>
+#include <esp_timer.h>
+
+#include "../util/poll_tables.h"
+#include "analog_stream.h"
+#include "io_pin.h"
+
+// ADC1 is the only unit the continuous driver can use alongside WiFi
+#if CONFIG_IDF_TARGET_ESP32
+static const uint8_t ADC1_CHANNEL_COUNT = 8;
+#else
+static const uint8_t ADC1_CHANNEL_COUNT = 10;
+#endif
+
+static const uint32_t ADC_DMA_FRAME_BYTES = 256;   // Bytes per DMA interrupt
+static const uint32_t ADC_DMA_STORE_BYTES = 4096;  // Driver ring buffer size
+static const uint8_t ADC_DMA_MAX_READS_PER_UPDATE = 4;
+
+// Per-channel oversampling, filter and reporting state
+struct AdcChannelState {
+  int16_t pinIndex = -1;  // Index into configuredPins, -1 if unused
+  uint32_t oversampleSum = 0;
+  uint8_t oversampleCount = 0;
+  uint16_t window[ADC_MAX_FILTER_WINDOW];
+  uint8_t windowPos = 0;
+  uint8_t windowFill = 0;
+  int32_t iirState = 0;  // Filtered value in 24.8 fixed point
+  int value = -1;        // Latest filtered value
+  uint64_t rawSampleCount = 0;  // Conversions received since engine start
+  unsigned long lastReportTime = 0;
+};
+
+static AdcChannelState channels[ADC1_CHANNEL_COUNT];
+static volatile uint16_t latestRaw[ADC1_CHANNEL_COUNT];
+static bool engineDirty = true;
+static bool engineRunning = false;
+static uint32_t engineChannelCount = 0;
+static int64_t engineStartUs = 0;
+static uint32_t dmaOverflowCount = 0;
+static uint8_t dmaBuffer[ADC_DMA_FRAME_BYTES];
+
+// Analog inputs the DMA engine cannot sample, polled with analogRead()
+static AnalogPollTable polledInputs;
+
+// ADC1 channel for a GPIO, or -1 if the pin is not on ADC1
+static int8_t adc1ChannelForPin(uint8_t pin) {
+  int8_t channel = digitalPinToAnalogChannel(pin);
+  if (channel < 0 || channel >= ADC1_CHANNEL_COUNT) return -1;
+  return channel;
+}
+
+static void stopEngine() {
+  if (!engineRunning) return;
+  adc_digi_stop();
+  adc_digi_deinitialize();
+  engineRunning = false;
+}
+
+// Reconfigure the DMA driver for the current set of analog inputs
+static void rebuildEngine() {
+  stopEngine();
+  engineDirty = false;
+
+  adc_digi_pattern_config_t pattern[ADC1_CHANNEL_COUNT];
+  uint32_t patternCount = 0;
+  uint32_t channelMask = 0;
+
+  for (uint8_t ch = 0; ch < ADC1_CHANNEL_COUNT; ch++) {
+    channels[ch] = AdcChannelState();
+  }
+
+  polledInputs.clear();
+  uint32_t now = millis();
+
+  for (size_t i = 0; i < configuredPins.capacity(); i++) {
+    if (!configuredPins.inUse(i)) continue;
+    const IoPinConfig &pin = configuredPins[i];
+    if (pin.kind != PIN_KIND_ANALOG_INPUT) continue;
+    int8_t ch = adc1ChannelForPin(pin.pin);
+    if (ch < 0 || channels[ch].pinIndex >= 0) {
+      polledInputs.add((uint16_t)i, pin.pin, pin.adcDeadband, now);
+      continue;
+    }
+
+    channels[ch].pinIndex = (int16_t)i;
+    channelMask |= 1UL << ch;
+    pattern[patternCount].atten = ADC_ATTEN_DB_11;
+    pattern[patternCount].channel = ch;
+    pattern[patternCount].unit = 0;  // ADC1
+    pattern[patternCount].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    patternCount++;
+  }
+
+  if (patternCount == 0) return;
+
+  adc_digi_init_config_t initConfig = {};
+  initConfig.max_store_buf_size = ADC_DMA_STORE_BYTES;
+  initConfig.conv_num_each_intr = ADC_DMA_FRAME_BYTES;
+  initConfig.adc1_chan_mask = channelMask;
+  initConfig.adc2_chan_mask = 0;
+  esp_err_t err = adc_digi_initialize(&initConfig);
+  if (err != ESP_OK) {
+    Serial.printf("ERROR: ADC DMA init failed (%d)\n", err);
+    return;
+  }
+
+  adc_digi_configuration_t digiConfig = {};
+#if CONFIG_IDF_TARGET_ESP32
+  digiConfig.conv_limit_en = true;
+  digiConfig.conv_limit_num = 250;
+  digiConfig.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+#else
+  digiConfig.conv_limit_en = false;
+  digiConfig.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+#endif
+  digiConfig.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  digiConfig.pattern_num = patternCount;
+  digiConfig.adc_pattern = pattern;
+  digiConfig.sample_freq_hz = adcSampleRateHz;
+  err = adc_digi_controller_configure(&digiConfig);
+  if (err == ESP_OK) err = adc_digi_start();
+  if (err != ESP_OK) {
+    Serial.printf("ERROR: ADC DMA start failed (%d)\n", err);
+    adc_digi_deinitialize();
+    return;
+  }
+
+  engineRunning = true;
+  engineChannelCount = patternCount;
+  engineStartUs = esp_timer_get_time();
+  Serial.printf("ADC engine: %u channel(s) at %u Hz total\n", patternCount,
+                adcSampleRateHz);
+}
+
+// Run one oversampled reading through the pin's filter
+static int applyFilter(AdcChannelState &state, const IoPinConfig &pin,
+                       uint16_t sample) {
+  uint8_t window = constrain<uint8_t>(pin.adcFilterWindow, 1,
+                                      ADC_MAX_FILTER_WINDOW);
+
+  switch (pin.adcFilter) {
+    case ADC_FILTER_MOVING_AVERAGE:
+    case ADC_FILTER_MEDIAN: {
+      state.window[state.windowPos] = sample;
+      state.windowPos = (state.windowPos + 1) % window;
+      if (state.windowFill < window) state.windowFill++;
+
+      if (pin.adcFilter == ADC_FILTER_MOVING_AVERAGE) {
+        uint32_t sum = 0;
+        for (uint8_t i = 0; i < state.windowFill; i++) sum += state.window[i];
+        return (int)(sum / state.windowFill);
+      }
+
+      // Insertion sort of at most ADC_MAX_FILTER_WINDOW values
+      uint16_t sorted[ADC_MAX_FILTER_WINDOW];
+      for (uint8_t i = 0; i < state.windowFill; i++) {
+        uint16_t v = state.window[i];
+        int8_t j = i - 1;
+        while (j >= 0 && sorted[j] > v) {
+          sorted[j + 1] = sorted[j];
+          j--;
+        }
+        sorted[j + 1] = v;
+      }
+      return sorted[state.windowFill / 2];
+    }
+
+    case ADC_FILTER_IIR:
+      if (state.value < 0) {
+        state.iirState = (int32_t)sample << 8;
+      } else {
+        state.iirState += (((int32_t)sample << 8) - state.iirState) / window;
+      }
+      return (int)(state.iirState >> 8);
+
+    case ADC_FILTER_NONE:
+    default:
+      return sample;
+  }
+}
+
+// Decide whether a new value should be broadcast
+static void reportIfDue(IoPinConfig &pin, int value,
+                        unsigned long &lastReportTime, unsigned long now) {
+  if (pin.adcReportIntervalMs > 0) {
+    if (now - lastReportTime < pin.adcReportIntervalMs) return;
+  } else {
+    if (pin.lastValue >= 0 && abs(value - pin.lastValue) <= pin.adcDeadband) {
+      return;
+    }
+    if (now - lastReportTime < analogReportMinInterval) return;
+  }
+
+  lastReportTime = now;
+  pin.lastValue = value;
+  broadcastPinValue(pin);
+}
+
+// Accumulate one raw conversion for a channel
+static void addRawSample(uint8_t ch, uint16_t raw, unsigned long now) {
+  latestRaw[ch] = raw;
+  AdcChannelState &state = channels[ch];
+  if (state.pinIndex < 0 || !configuredPins.inUse(state.pinIndex)) {
+    return;
+  }
+  IoPinConfig &pin = configuredPins[state.pinIndex];
+
+  // Raw conversions go to the stream before any oversampling or filtering
+  pushAnalogStreamSample(ch, raw, state.rawSampleCount++);
+
+  state.oversampleSum += raw;
+  if (++state.oversampleCount < max<uint8_t>(pin.adcOversample, 1)) return;
+
+  uint16_t sample = (uint16_t)(state.oversampleSum / state.oversampleCount);
+  state.oversampleSum = 0;
+  state.oversampleCount = 0;
+
+  state.value = applyFilter(state, pin, sample);
+  reportIfDue(pin, state.value, state.lastReportTime, now);
+}
+
+// Drain whatever the DMA has produced since the last update
+static void drainDma(unsigned long now) {
+  for (uint8_t reads = 0; reads < ADC_DMA_MAX_READS_PER_UPDATE; reads++) {
+    uint32_t length = 0;
+    esp_err_t err =
+        adc_digi_read_bytes(dmaBuffer, sizeof(dmaBuffer), &length, 0);
+    if (err == ESP_ERR_INVALID_STATE) {
+      dmaOverflowCount++;  // Driver buffer overflowed; data is still valid
+    } else if (err != ESP_OK) {
+      return;  // ESP_ERR_TIMEOUT: nothing pending
+    }
+    if (length == 0) return;
+
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length;
+         i += SOC_ADC_DIGI_RESULT_BYTES) {
+      adc_digi_output_data_t *result = (adc_digi_output_data_t *)&dmaBuffer[i];
+#if CONFIG_IDF_TARGET_ESP32
+      uint8_t ch = result->type1.channel;
+      uint16_t raw = result->type1.data;
+#else
+      if (result->type2.unit != 0) continue;
+      uint8_t ch = result->type2.channel;
+      uint16_t raw = result->type2.data;
+#endif
+      if (ch < ADC1_CHANNEL_COUNT) addRawSample(ch, raw, now);
+    }
+  }
+}
+
+void invalidateAdcEngine() { engineDirty = true; }
+
+void updateAdcEngine() {
+  if (engineDirty) rebuildEngine();
+
+  unsigned long now = millis();
+  if (engineRunning) drainDma(now);
+
+  // Pins off ADC1 are still polled with single conversions
+  for (size_t i = 0; i < polledInputs.size(); i++) {
+    if (!deadlineReached(now, polledInputs.nextDeadlineMs[i])) continue;
+    polledInputs.nextDeadlineMs[i] = now + analogInputReadInterval;
+
+    IoPinConfig &pin = configuredPins[polledInputs.pinIndex[i]];
+    int value = analogRead(polledInputs.gpio[i]);
+    if (pin.lastValue < 0 ||
+        abs(value - pin.lastValue) > polledInputs.deadband[i]) {
+      pin.lastValue = value;
+      broadcastPinValue(pin);
+    }
+  }
+}
+
+bool isAdcEnginePin(const IoPinConfig &pinConfig) {
+  return getAdcEngineChannel(pinConfig) >= 0;
+}
+
+int8_t getAdcEngineChannel(const IoPinConfig &pinConfig) {
+  if (!engineRunning) return -1;
+  int8_t ch = adc1ChannelForPin(pinConfig.pin);
+  if (ch < 0 || channels[ch].pinIndex < 0) return -1;
+  if (&configuredPins[channels[ch].pinIndex] != &pinConfig) return -1;
+  return ch;
+}
+
+uint32_t getAdcChannelSampleRateMilliHz() {
+  if (!engineRunning || engineChannelCount == 0) return 0;
+  return (uint32_t)((uint64_t)adcSampleRateHz * 1000 / engineChannelCount);
+}
+
+int64_t getAdcEngineStartUs() { return engineStartUs; }
+
+uint16_t getAdcLatestRaw(int8_t channel) {
+  if (channel < 0 || channel >= ADC1_CHANNEL_COUNT) return 0;
+  return latestRaw[channel];
+}
+
+int getAdcEngineValue(const IoPinConfig &pinConfig) {
+  int8_t ch = adc1ChannelForPin(pinConfig.pin);
+  if (ch < 0) return -1;
+  return channels[ch].value;
+}
+
+uint32_t setAdcSampleRate(uint32_t sampleRateHz) {
+  adcSampleRateHz = constrain<uint32_t>(sampleRateHz,
+                                        SOC_ADC_SAMPLE_FREQ_THRES_LOW,
+                                        SOC_ADC_SAMPLE_FREQ_THRES_HIGH);
+  invalidateAdcEngine();
+  return adcSampleRateHz;
+}
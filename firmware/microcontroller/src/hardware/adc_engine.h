@@ -0,0 +1,41 @@
+#ifndef ADC_ENGINE_H
+#define ADC_ENGINE_H
+
+#include "../config.h"
+
+// --- Continuous (DMA) Analog Sampling ---
+// Analog inputs on ADC1 are sampled in the background by the ESP32
+// continuous ADC driver at adcSampleRateHz (shared by all channels). The loop
+// drains the DMA results without blocking, oversamples and filters each
+// channel, and reports either on change (beyond adcDeadband) or at a fixed
+// adcReportIntervalMs. Pins that are not on ADC1 fall back to periodic
+// analogRead() polling.
+
+// Mark the channel set stale; the driver is reconfigured on the next update
+void invalidateAdcEngine();
+
+// Drain DMA results, filter, and broadcast analog input changes
+void updateAdcEngine();
+
+// Whether a pin is sampled by the DMA engine (false = polled fallback)
+bool isAdcEnginePin(const IoPinConfig &pinConfig);
+
+// ADC1 channel sampling a pin, or -1 if it is not DMA-sampled
+int8_t getAdcEngineChannel(const IoPinConfig &pinConfig);
+
+// Conversion rate seen by each channel, in millihertz
+uint32_t getAdcChannelSampleRateMilliHz();
+
+// esp_timer time at which the DMA engine last started (sample index 0)
+int64_t getAdcEngineStartUs();
+
+// Most recent raw conversion of an ADC1 channel (safe from any task)
+uint16_t getAdcLatestRaw(int8_t channel);
+
+// Latest filtered value for a DMA-sampled pin, or -1 if none yet
+int getAdcEngineValue(const IoPinConfig &pinConfig);
+
+// Change the total conversion rate (clamped to what the SoC supports)
+uint32_t setAdcSampleRate(uint32_t sampleRateHz);
+
+#endif  // ADC_ENGINE_H
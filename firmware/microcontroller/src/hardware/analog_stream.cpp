@@ -0,0 +1,172 @@
+#include "analog_stream.h"
+
+#include <Arduino.h>
+
+#include <atomic>
+
+#include "../binary_frames.h"
+#include "../system/tasks.h"
+#include "adc_engine.h"
+
+extern void broadcastWebSocketBinary(const uint8_t *data, size_t len);
+
+static const uint8_t MAX_ANALOG_STREAMS = 4;
+static const uint16_t MAX_STREAM_CHUNK_SAMPLES = 512;
+static const uint8_t MAX_STREAM_ID_LENGTH = COMPONENT_ID_MAX_CHARS;
+
+struct AnalogStream {
+  bool active = false;
+  int8_t channel = -1;
+  uint8_t gpio = 0;
+  ComponentId id;
+  uint16_t chunkSamples = 0;
+
+  // Double buffer: the ADC path fills buffers[writeIndex] while the other
+  // half, once marked ready, waits for flushAnalogStreams()
+  uint16_t buffers[2][MAX_STREAM_CHUNK_SAMPLES];
+  uint64_t bufferStartIndex[2] = {0, 0};
+  std::atomic<bool> ready[2];
+  uint8_t writeIndex = 0;
+  uint16_t fill = 0;
+
+  uint32_t sequence = 0;
+  uint16_t droppedChunks = 0;  // Since the last chunk that was sent
+};
+
+static AnalogStream streams[MAX_ANALOG_STREAMS];
+static uint8_t frameBuffer[sizeof(AnalogStreamChunkHeader) +
+                           MAX_STREAM_ID_LENGTH +
+                           MAX_STREAM_CHUNK_SAMPLES * sizeof(uint16_t)];
+
+static AnalogStream *findStream(uint8_t gpio) {
+  for (auto &stream : streams) {
+    if (stream.active && stream.gpio == gpio) return &stream;
+  }
+  return nullptr;
+}
+
+// Count a dropped chunk without overflowing the 16-bit header field
+static inline void countDroppedChunk(AnalogStream &stream) {
+  if (stream.droppedChunks < UINT16_MAX) stream.droppedChunks++;
+}
+
+bool startAnalogStream(IoPinConfig &pinConfig, uint16_t chunkSamples) {
+  int8_t channel = getAdcEngineChannel(pinConfig);
+  if (channel < 0) {
+    Serial.printf("Pin %s: streaming needs a DMA-sampled analog input\n",
+                  pinConfig.id.c_str());
+    return false;
+  }
+
+  AnalogStream *stream = findStream(pinConfig.pin);
+  if (!stream) {
+    for (auto &candidate : streams) {
+      if (!candidate.active) {
+        stream = &candidate;
+        break;
+      }
+    }
+  }
+  if (!stream) {
+    Serial.println(F("ERROR: No free analog stream slots"));
+    return false;
+  }
+
+  stream->active = false;  // Keep the ADC path out while re-arming
+  stream->channel = channel;
+  stream->gpio = pinConfig.pin;
+  stream->id = pinConfig.id;
+  stream->chunkSamples = constrain<uint16_t>(chunkSamples, 16,
+                                             MAX_STREAM_CHUNK_SAMPLES);
+  stream->ready[0] = false;
+  stream->ready[1] = false;
+  stream->writeIndex = 0;
+  stream->fill = 0;
+  stream->sequence = 0;
+  stream->droppedChunks = 0;
+  stream->active = true;
+
+  Serial.printf("Pin %s: streaming %u-sample chunks at %.1f Hz\n",
+                pinConfig.id.c_str(), stream->chunkSamples,
+                getAdcChannelSampleRateMilliHz() / 1000.0);
+  return true;
+}
+
+void stopAnalogStream(const IoPinConfig &pinConfig) {
+  AnalogStream *stream = findStream(pinConfig.pin);
+  if (stream) stream->active = false;
+}
+
+void pushAnalogStreamSample(uint8_t channel, uint16_t raw,
+                            uint64_t sampleIndex) {
+  for (auto &stream : streams) {
+    if (!stream.active || stream.channel != (int8_t)channel) continue;
+
+    if (stream.fill == 0) stream.bufferStartIndex[stream.writeIndex] = sampleIndex;
+    stream.buffers[stream.writeIndex][stream.fill++] = raw;
+    if (stream.fill < stream.chunkSamples) return;
+
+    // Chunk complete: hand it over and continue in the other half. If that
+    // half was never sent, its chunk is dropped as a whole.
+    stream.ready[stream.writeIndex] = true;
+    stream.writeIndex ^= 1;
+    stream.fill = 0;
+    if (stream.ready[stream.writeIndex].exchange(false)) {
+      countDroppedChunk(stream);
+    }
+    return;
+  }
+}
+
+// Serialize and send one completed chunk
+static void sendChunk(AnalogStream &stream, uint8_t buffer) {
+  uint32_t rateMilliHz = getAdcChannelSampleRateMilliHz();
+  uint8_t idLength = (uint8_t)min<size_t>(stream.id.length(),
+                                          MAX_STREAM_ID_LENGTH);
+
+  AnalogStreamChunkHeader header;
+  header.frameType = BINARY_FRAME_ANALOG_STREAM;
+  header.version = ANALOG_STREAM_FRAME_VERSION;
+  header.gpio = stream.gpio;
+  header.idLength = idLength;
+  header.sequence = stream.sequence++;
+  header.startUs = (uint64_t)getAdcEngineStartUs();
+  if (rateMilliHz > 0) {
+    header.startUs +=
+        stream.bufferStartIndex[buffer] * 1000000000ULL / rateMilliHz;
+  }
+  header.sampleRateMilliHz = rateMilliHz;
+  header.sampleCount = stream.chunkSamples;
+  header.droppedChunks = stream.droppedChunks;
+
+  size_t offset = 0;
+  memcpy(frameBuffer, &header, sizeof(header));
+  offset += sizeof(header);
+  memcpy(frameBuffer + offset, stream.id.c_str(), idLength);
+  offset += idLength;
+  size_t sampleBytes = stream.chunkSamples * sizeof(uint16_t);
+  memcpy(frameBuffer + offset, stream.buffers[buffer], sampleBytes);
+  offset += sampleBytes;
+
+  broadcastWebSocketBinary(frameBuffer, offset);
+  stream.droppedChunks = 0;
+}
+
+void flushAnalogStreams() {
+  for (auto &stream : streams) {
+    if (!stream.active) continue;
+
+    // The half not being written is the older one; send it first
+    uint8_t order[2] = {(uint8_t)(stream.writeIndex ^ 1), stream.writeIndex};
+    for (uint8_t buffer : order) {
+      if (!stream.ready[buffer]) continue;
+
+      if (isTelemetryWritable()) {
+        sendChunk(stream, buffer);
+      } else {
+        countDroppedChunk(stream);  // Never wait for the network
+      }
+      stream.ready[buffer] = false;
+    }
+  }
+}
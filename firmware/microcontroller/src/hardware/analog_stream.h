@@ -0,0 +1,25 @@
+#ifndef ANALOG_STREAM_H
+#define ANALOG_STREAM_H
+
+#include "../config.h"
+
+// --- High-Rate Analog Streaming ---
+// A DMA-sampled analog input can stream every raw conversion to the host.
+// Samples fill one half of a double buffer while the other half waits to be
+// sent as a binary WebSocket chunk (see binary_frames.h). If the network
+// cannot keep up, whole chunks are dropped; the sampling path never waits.
+
+// Start streaming a DMA-sampled analog input in chunks of `chunkSamples`
+bool startAnalogStream(IoPinConfig &pinConfig, uint16_t chunkSamples);
+
+// Stop streaming a pin (no-op if it is not streaming)
+void stopAnalogStream(const IoPinConfig &pinConfig);
+
+// Feed one raw conversion from the ADC engine
+void pushAnalogStreamSample(uint8_t channel, uint16_t raw,
+                            uint64_t sampleIndex);
+
+// Send completed chunks to connected clients
+void flushAnalogStreams();
+
+#endif  // ANALOG_STREAM_H
@@ -0,0 +1,135 @@
+#include "input_events.h"
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_timer.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+
+#include "../system/trace.h"
+#include "../util/ring_buffer.h"
+
+// Forward declaration for WebSocket broadcast function
+extern void broadcastTelemetryMessage(const String &message);
+
+// All GPIO ISRs are dispatched from the single GPIO interrupt handler, so they
+// never run concurrently and the ring has exactly one producer.
+static SpscRing<PinEdgeEvent, PIN_EDGE_EVENT_QUEUE_SIZE> edgeEvents;
+static uint32_t lastReportedDropCount = 0;
+
+// Read a GPIO level straight from the input registers (ISR safe)
+static inline uint8_t IRAM_ATTR readGpioLevel(uint8_t pin) {
+  if (pin < 32) return (REG_READ(GPIO_IN_REG) >> pin) & 0x1;
+  return (REG_READ(GPIO_IN1_REG) >> (pin - 32)) & 0x1;
+}
+
+// Edge ISR: timestamp and enqueue, nothing else
+static void IRAM_ATTR onPinEdge(void *arg) {
+  uint8_t pin = (uint8_t)(uintptr_t)arg;
+  PinEdgeEvent event;
+  event.pin = pin;
+  event.level = readGpioLevel(pin);
+  event.timestampUs = esp_timer_get_time();
+  edgeEvents.push(event);
+  traceInstant(TRACE_ISR_EDGE, 0, pin);
+}
+
+// Find the interrupt-driven input bound to a GPIO number
+static IoPinConfig *findInterruptPin(uint8_t gpio) {
+  for (auto &pin : configuredPins) {
+    if (pin.useInterrupt && pin.pin == gpio) return &pin;
+  }
+  return nullptr;
+}
+
+// Broadcast an accepted edge, including its exact timestamp
+static void broadcastPinEdge(const IoPinConfig &pin) {
+  StaticJsonDocument<192> msg;
+  msg["id"] = pin.id.c_str();
+  msg["value"] = pin.lastValue;
+  msg["type"] = pin.pinType.c_str();
+  msg["mode"] = pin.mode.c_str();
+  msg["timestampUs"] = pin.lastEdgeUs;
+  msg["edgeCount"] = pin.edgeCount;
+
+  String out;
+  serializeJson(msg, out);
+  broadcastTelemetryMessage(out);
+}
+
+// Accept a level change if it lies outside the pin's debounce window
+static void applyPinEdge(IoPinConfig &pin, uint8_t level, int64_t timestampUs) {
+  if (level == pin.lastValue) return;  // Bounce back to the reported level
+
+  int64_t debounceUs = (int64_t)pin.debounceMs * 1000;
+  if (pin.edgeCount > 0 && timestampUs - pin.lastEdgeUs < debounceUs) {
+    // Inside the window: re-check the settled level once it has elapsed
+    pin.settlePending = true;
+    return;
+  }
+
+  pin.lastValue = level;
+  pin.lastEdgeUs = timestampUs;
+  pin.edgeCount++;
+  pin.settlePending = false;
+  broadcastPinEdge(pin);
+}
+
+bool attachPinInterrupt(IoPinConfig &pinConfig) {
+  if (digitalPinToInterrupt(pinConfig.pin) < 0) {
+    Serial.printf("ERROR: Pin %d does not support interrupts\n",
+                  pinConfig.pin);
+    pinConfig.useInterrupt = false;
+    return false;
+  }
+
+  pinConfig.lastValue = readGpioLevel(pinConfig.pin);
+  pinConfig.lastEdgeUs = esp_timer_get_time();
+  pinConfig.edgeCount = 0;
+  pinConfig.settlePending = false;
+  attachInterruptArg(pinConfig.pin, onPinEdge,
+                     (void *)(uintptr_t)pinConfig.pin, CHANGE);
+
+  Serial.printf("Pin %s: interrupt-driven input on GPIO %d\n",
+                pinConfig.id.c_str(), pinConfig.pin);
+  return true;
+}
+
+void detachPinInterrupt(IoPinConfig &pinConfig) {
+  if (pinConfig.useInterrupt) {
+    detachInterrupt(pinConfig.pin);
+  }
+}
+
+void processPinEdgeEvents() {
+  PinEdgeEvent event;
+  while (edgeEvents.pop(event)) {
+    IoPinConfig *pin = findInterruptPin(event.pin);
+    if (pin) applyPinEdge(*pin, event.level, event.timestampUs);
+  }
+
+  int64_t nowUs = esp_timer_get_time();
+  uint32_t dropped = edgeEvents.dropped();
+  bool resync = dropped != lastReportedDropCount;
+  if (resync) {
+    Serial.printf("WARNING: %u pin edge events dropped (ring full)\n",
+                  dropped - lastReportedDropCount);
+    lastReportedDropCount = dropped;
+  }
+
+  // Settle pins whose last edge was swallowed by the debounce window, and
+  // resynchronise every pin after an overflow so no level change is lost
+  for (auto &pin : configuredPins) {
+    if (!pin.useInterrupt) continue;
+    if (!resync && !pin.settlePending) continue;
+    if (!resync &&
+        nowUs - pin.lastEdgeUs < (int64_t)pin.debounceMs * 1000) {
+      continue;
+    }
+    pin.settlePending = false;
+    uint8_t level = readGpioLevel(pin.pin);
+    if (level != pin.lastValue) applyPinEdge(pin, level, nowUs);
+  }
+}
+
+uint32_t getDroppedPinEdgeCount() { return edgeEvents.dropped(); }
@@ -0,0 +1,30 @@
+#ifndef INPUT_EVENTS_H
+#define INPUT_EVENTS_H
+
+#include "../config.h"
+
+// --- Interrupt-Driven Digital Inputs ---
+// Digital inputs configured with "interrupt": true are not polled. A GPIO ISR
+// records every edge with its esp_timer timestamp into a lock-free ring and
+// the main loop drains that ring into debouncing and telemetry.
+
+// Edge record produced by the GPIO ISR
+struct PinEdgeEvent {
+  uint8_t pin;          // GPIO number
+  uint8_t level;        // Level sampled in the ISR (LOW or HIGH)
+  int64_t timestampUs;  // esp_timer_get_time() at the edge
+};
+
+// Attach the edge ISR for an interrupt-driven digital input
+bool attachPinInterrupt(IoPinConfig &pinConfig);
+
+// Detach the edge ISR (safe to call for pins that were never attached)
+void detachPinInterrupt(IoPinConfig &pinConfig);
+
+// Drain queued edges into debouncing and broadcast accepted changes
+void processPinEdgeEvents();
+
+// Number of edges lost because the ring was full
+uint32_t getDroppedPinEdgeCount();
+
+#endif  // INPUT_EVENTS_H
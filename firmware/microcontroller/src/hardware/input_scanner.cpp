@@ -0,0 +1,136 @@
+#include "input_scanner.h"
+
+#include <Arduino.h>
+
+#include "../hal/hal_gpio.h"
+#include "../hal/hal_timer.h"
+
+static const uint8_t MAX_SCANNED_GPIO = 64;
+
+static bool scanDirty = true;
+static uint64_t scanMask = 0;      // Polled digital inputs
+static uint64_t debounceMask = 0;  // Subset of scanMask that is debounced
+static uint64_t stableState = 0;   // Debounced levels
+static uint64_t reportedState = 0;  // Levels returned by the last scan
+static uint64_t pendingReport = 0;  // Newly configured pins to report once
+
+// Two-bit vertical counters, one bit-slice per GPIO. Idle counters hold 3;
+// a differing sample counts down and the state toggles on wrap-around.
+static uint64_t counterLow = ~0ULL;
+static uint64_t counterHigh = ~0ULL;
+
+// Debounced pins grouped by sample period; each group advances its own
+// bit-slices of the counters
+struct DebounceGroup {
+  uint64_t mask;
+  int64_t periodUs;
+  int64_t lastSampleUs;
+};
+static DebounceGroup debounceGroups[MAX_IO_PINS];
+static uint8_t debounceGroupCount = 0;
+
+// Index into configuredPins for each scanned GPIO (-1 if none)
+static int16_t gpioToPinIndex[MAX_SCANNED_GPIO];
+
+// Add a pin to the group sampling at its period, creating the group if needed
+static void addToDebounceGroup(uint64_t bit, uint16_t debounceMs) {
+  // Four stable samples make up one debounce interval
+  int64_t periodUs = max<int64_t>(1000, (int64_t)debounceMs * 1000 / 4);
+  for (uint8_t i = 0; i < debounceGroupCount; i++) {
+    if (debounceGroups[i].periodUs == periodUs) {
+      debounceGroups[i].mask |= bit;
+      return;
+    }
+  }
+  debounceGroups[debounceGroupCount++] = {bit, periodUs, 0};
+}
+
+// Rebuild masks and the GPIO -> pin index table from configuredPins
+static void rebuildScanTables() {
+  uint64_t previousMask = scanMask;
+
+  scanMask = 0;
+  debounceMask = 0;
+  debounceGroupCount = 0;
+  for (uint8_t gpio = 0; gpio < MAX_SCANNED_GPIO; gpio++) {
+    gpioToPinIndex[gpio] = -1;
+  }
+
+  for (size_t i = 0; i < configuredPins.capacity(); i++) {
+    if (!configuredPins.inUse(i)) continue;
+    const IoPinConfig &pin = configuredPins[i];
+    if (pin.kind != PIN_KIND_DIGITAL_INPUT || pin.useInterrupt ||
+        pin.pin >= MAX_SCANNED_GPIO) {
+      continue;
+    }
+
+    uint64_t bit = 1ULL << pin.pin;
+    scanMask |= bit;
+    gpioToPinIndex[pin.pin] = (int16_t)i;
+    if (pin.debounceMs > 0) {
+      debounceMask |= bit;
+      addToDebounceGroup(bit, pin.debounceMs);
+    }
+  }
+
+  // Seed newly scanned pins with their current level
+  uint64_t added = scanMask & ~previousMask;
+  uint64_t raw = halReadInputs();
+  stableState = (stableState & ~added) | (raw & added);
+  counterLow |= added;
+  counterHigh |= added;
+
+  // Report any pin whose last known value is stale (new or reconfigured)
+  pendingReport &= scanMask;
+  for (uint8_t gpio = 0; gpio < MAX_SCANNED_GPIO; gpio++) {
+    if (gpioToPinIndex[gpio] < 0) continue;
+    const IoPinConfig &pin = configuredPins[gpioToPinIndex[gpio]];
+    if (pin.lastValue != digitalInputLevel(stableState, gpio)) {
+      pendingReport |= 1ULL << gpio;
+    }
+  }
+
+  scanDirty = false;
+}
+
+void invalidateDigitalInputScan() { scanDirty = true; }
+
+uint64_t scanDigitalInputs() {
+  if (scanDirty) rebuildScanTables();
+  if (scanMask == 0) return 0;
+
+  uint64_t raw = halReadInputs() & scanMask;
+
+  // Pins without debouncing follow the raw sample directly
+  uint64_t direct = scanMask & ~debounceMask;
+  stableState = (stableState & ~direct) | (raw & direct);
+
+  // Debounced pins advance their vertical counters once per sample period
+  // of their group; the other groups' bit-slices are left as they are
+  int64_t nowUs = halTimeUs();
+  for (uint8_t i = 0; i < debounceGroupCount; i++) {
+    DebounceGroup &group = debounceGroups[i];
+    if (nowUs - group.lastSampleUs < group.periodUs) continue;
+    group.lastSampleUs = nowUs;
+    uint64_t differs = (stableState ^ raw) & group.mask;
+    uint64_t low = ~(counterLow & differs);
+    uint64_t high = low ^ (counterHigh & differs);
+    counterLow = (counterLow & ~group.mask) | (low & group.mask);
+    counterHigh = (counterHigh & ~group.mask) | (high & group.mask);
+    stableState ^= differs & low & high;
+  }
+
+  uint64_t changed = ((stableState ^ reportedState) & scanMask) | pendingReport;
+  reportedState = stableState;
+  pendingReport = 0;
+  return changed;
+}
+
+uint64_t getDigitalInputState() { return stableState; }
+
+IoPinConfig *getScannedDigitalInput(uint8_t gpio) {
+  if (gpio >= MAX_SCANNED_GPIO || gpioToPinIndex[gpio] < 0) return nullptr;
+  size_t index = (size_t)gpioToPinIndex[gpio];
+  if (!configuredPins.inUse(index)) return nullptr;
+  return &configuredPins[index];
+}
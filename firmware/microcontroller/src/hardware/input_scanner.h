@@ -0,0 +1,34 @@
+#ifndef INPUT_SCANNER_H
+#define INPUT_SCANNER_H
+
+#include "../config.h"
+
+// --- Batched Digital Input Scanning ---
+// All polled digital inputs are sampled with one read of the GPIO input
+// registers per scan. Changes are found with a single XOR against the last
+// reported state, and debouncing runs bit-parallel across every pin using
+// two-bit vertical counters, so a scan costs the same for 40 pins as for 1.
+//
+// A debounced level must be stable for four consecutive samples taken a
+// quarter of the pin's debounceMs apart (minimum 1 ms). Pins with the same
+// sample period are debounced together as one group.
+
+// Mark the scan tables stale; they are rebuilt on the next scan
+void invalidateDigitalInputScan();
+
+// Sample all polled digital inputs; returns a GPIO bitmask of pins whose
+// debounced level changed since the previous call
+uint64_t scanDigitalInputs();
+
+// Debounced level of a scanned digital input
+inline int digitalInputLevel(uint64_t state, uint8_t gpio) {
+  return (int)((state >> gpio) & 0x1);
+}
+
+// Current debounced state of all scanned inputs (bit n = GPIO n)
+uint64_t getDigitalInputState();
+
+// Pin configured for a scanned GPIO, or nullptr
+IoPinConfig *getScannedDigitalInput(uint8_t gpio);
+
+#endif  // INPUT_SCANNER_H
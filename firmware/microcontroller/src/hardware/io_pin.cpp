@@ -2,127 +2,529 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
-#include <AsyncWebSocket.h>
 
-// Forward declaration for WebSocket instance
-extern AsyncWebSocket ws;
+#include "../hal/hal_gpio.h"
+#include "../hal/hal_ledc.h"
+#include "../system/tasks.h"
+#include "adc_engine.h"
+#include "analog_stream.h"
+#include "input_events.h"
+#include "input_scanner.h"
+#include "pin_capture.h"
+#include "pulse_counter.h"
+#include "pulse_output.h"
+#include "pwm_output.h"
 
-// Forward declaration for WebSocket broadcast function
-extern void broadcastWebSocketMessage(const String &message);
+// Forward declarations for WebSocket functions
+extern void broadcastTelemetryMessage(const String &message);
+extern void sendWebSocketMessage(uint32_t clientId, const String &message);
+
+PinKind classifyPin(const char *pinType, const char *mode) {
+  bool output = strcmp(mode, "output") == 0;
+  if (strcmp(pinType, "digital") == 0) {
+    return output ? PIN_KIND_DIGITAL_OUTPUT : PIN_KIND_DIGITAL_INPUT;
+  }
+  if (strcmp(pinType, "analog") == 0) {
+    return output ? PIN_KIND_ANALOG_OUTPUT : PIN_KIND_ANALOG_INPUT;
+  }
+  if (strcmp(pinType, "pwm") == 0 && output) return PIN_KIND_PWM_OUTPUT;
+  if (strcmp(pinType, "counter") == 0 && !output) return PIN_KIND_COUNTER;
+  if (strcmp(pinType, "frequency") == 0 && !output) return PIN_KIND_FREQUENCY;
+  return PIN_KIND_NONE;
+}
 
 // Initialize a pin based on its configuration
 void initializePin(IoPinConfig &pinConfig) {
-  // Setup pin based on mode and type
-  if (pinConfig.mode == "output") {
-    if (pinConfig.pinType == "digital") {
-      pinMode(pinConfig.pin, OUTPUT);
-      digitalWrite(pinConfig.pin, LOW);
-    } else if (pinConfig.pinType == "pwm") {
-      // Configure PWM for ESP32
-      ledcSetup(pinConfig.pin % 16, 5000, 8);  // Channel, frequency, resolution
-      ledcAttachPin(pinConfig.pin, pinConfig.pin % 16);
-      ledcWrite(pinConfig.pin % 16, 0);
-    }
-    // For analog output, we use DAC which will be handled during write
-    // operations
-  } else {
-    // Input mode with appropriate pull resistors
-    if (pinConfig.pinType == "digital") {
+  pinConfig.kind = classifyPin(pinConfig.pinType.c_str(), pinConfig.mode.c_str());
+
+  // Setup pin based on its kind
+  switch (pinConfig.kind) {
+    case PIN_KIND_DIGITAL_OUTPUT:
+      halPinMode(pinConfig.pin, HAL_PIN_OUTPUT);
+      halDigitalWrite(pinConfig.pin, LOW);
+      break;
+    case PIN_KIND_PWM_OUTPUT:
+      // Dedicated LEDC timer at the pin's frequency and resolution
+      setupPwmPin(pinConfig);
+      break;
+    case PIN_KIND_ANALOG_OUTPUT:
+      // For analog output, we use DAC which will be handled during write
+      // operations
+      break;
+    case PIN_KIND_COUNTER:
+    case PIN_KIND_FREQUENCY:
+      // Counted by the PCNT peripheral, not polled
+      attachPulseCounter(pinConfig);
+      break;
+    case PIN_KIND_DIGITAL_INPUT:
+      // Input mode with appropriate pull resistors
       if (pinConfig.pullMode == PULL_UP) {
-        pinMode(pinConfig.pin, INPUT_PULLUP);
+        halPinMode(pinConfig.pin, HAL_PIN_INPUT_PULLUP);
       } else if (pinConfig.pullMode == PULL_DOWN) {
-        pinMode(pinConfig.pin, INPUT_PULLDOWN);
+        halPinMode(pinConfig.pin, HAL_PIN_INPUT_PULLDOWN);
       } else {
-        pinMode(pinConfig.pin, INPUT);
+        halPinMode(pinConfig.pin, HAL_PIN_INPUT);
       }
-    } else {
-      // Analog input - set pin appropriately
-      pinMode(pinConfig.pin, INPUT);
-    }
+      break;
+    default:
+      // Analog and unrecognized inputs
+      if (pinConfig.mode != "output") halPinMode(pinConfig.pin, HAL_PIN_INPUT);
+      break;
   }
 
-  // Setup debouncer for digital inputs
-  if (pinConfig.mode == "input" && pinConfig.pinType == "digital" &&
-      pinConfig.debounceMs > 0) {
-    if (pinConfig.debouncer) {
-      delete pinConfig.debouncer;  // Clean up old debouncer if exists
+  // Interrupt-driven digital inputs debounce on edge timestamps instead
+  if (pinConfig.useInterrupt) {
+    if (pinConfig.kind == PIN_KIND_DIGITAL_INPUT) {
+      attachPinInterrupt(pinConfig);
+    } else {
+      pinConfig.useInterrupt = false;
     }
-    pinConfig.debouncer = new Bounce();
-    pinConfig.debouncer->attach(pinConfig.pin);
-    pinConfig.debouncer->interval(pinConfig.debounceMs);
   }
+
+  // Polled digital inputs are picked up by the batched scanner, analog
+  // inputs by the DMA engine
+  invalidateDigitalInputScan();
+  invalidateAdcEngine();
+  invalidatePulseCounters();
 }
 
 // Clean up a pin (e.g., before reconfiguration or removal)
 void cleanupPin(IoPinConfig &pinConfig) {
-  // Clean up existing debouncer
-  if (pinConfig.debouncer) {
-    delete pinConfig.debouncer;
-    pinConfig.debouncer = nullptr;
-  }
+  // Stop edge capture and hardware counting before the pin changes mode
+  detachPinInterrupt(pinConfig);
+  detachPulseCounter(pinConfig);
+  cancelPinPulse(pinConfig);
+
+  // Drop the pin from the batched input scan, the ADC engine and streaming
+  stopAnalogStream(pinConfig);
+  invalidateDigitalInputScan();
+  invalidateAdcEngine();
+  invalidatePulseCounters();
 
   // Reset pin to safe state
-  if (pinConfig.pinType == "pwm") {
-    ledcDetachPin(pinConfig.pin);
+  if (pinConfig.kind == PIN_KIND_PWM_OUTPUT) {
+    releasePwmPin(pinConfig);
   }
 
   // Set to input (safest mode)
-  pinMode(pinConfig.pin, INPUT);
+  halPinMode(pinConfig.pin, HAL_PIN_INPUT);
+}
+
+// Broadcast a pin's current value to all websocket clients
+void broadcastPinValue(const IoPinConfig &pin) {
+  StaticJsonDocument<128> msg;
+  msg["id"] = pin.id.c_str();
+  msg["value"] = pin.lastValue;
+  msg["type"] = pin.pinType.c_str();
+  msg["mode"] = pin.mode.c_str();
+
+  String out;
+  serializeJson(msg, out);
+
+  broadcastTelemetryMessage(out);
+}
+
+uint64_t getDigitalOutputMask() {
+  uint64_t mask = 0;
+  for (const auto &pin : configuredPins) {
+    if (pin.kind == PIN_KIND_DIGITAL_OUTPUT && pin.pin < 64) {
+      mask |= 1ULL << pin.pin;
+    }
+  }
+  return mask;
+}
+
+void writeDigitalOutputs(uint64_t setMask, uint64_t clearMask) {
+  // Explicit writes take over from any pulse running on the same pins
+  for (const auto &pin : configuredPins) {
+    if (pin.pin < 64 && ((setMask | clearMask) & (1ULL << pin.pin))) {
+      cancelPinPulse(pin);
+    }
+  }
+
+  halWriteOutputs(setMask, clearMask);
+
+  for (auto &pin : configuredPins) {
+    if (pin.pin >= 64 || pin.kind != PIN_KIND_DIGITAL_OUTPUT) continue;
+    uint64_t bit = 1ULL << pin.pin;
+    if (setMask & bit) {
+      pin.lastValue = HIGH;
+    } else if (clearMask & bit) {
+      pin.lastValue = LOW;
+    }
+  }
+}
+
+void broadcastPinValues(uint64_t gpioMask) {
+  DynamicJsonDocument msg(64 + configuredPins.size() * 48);
+  msg["type"] = "pinValues";
+  msg["componentGroup"] = "pins";
+  JsonArray values = msg.createNestedArray("values");
+  for (const auto &pin : configuredPins) {
+    if (pin.pin >= 64 || !(gpioMask & (1ULL << pin.pin))) continue;
+    JsonObject entry = values.createNestedObject();
+    entry["id"] = pin.id.c_str();
+    entry["value"] = pin.lastValue;
+  }
+
+  String out;
+  serializeJson(msg, out);
+  broadcastTelemetryMessage(out);
 }
 
 // Update and report pin values
 void updatePinValues() {
-  unsigned long now = millis();
+  // Interrupt-driven inputs report from their edge queue
+  processPinEdgeEvents();
 
-  for (auto &pin : configuredPins) {
-    if (pin.mode == "input") {
-      bool shouldUpdate = false;
-      int currentValue = 0;
-
-      if (pin.pinType == "digital") {
-        if (pin.debouncer) {
-          // Use debouncer for digital inputs with debouncing enabled
-          pin.debouncer->update();
-          if (pin.debouncer->changed()) {
-            currentValue = pin.debouncer->read();
-            shouldUpdate = true;
-          }
-        } else {
-          // Regular digital read for non-debounced pins
-          currentValue = digitalRead(pin.pin);
-          if (currentValue != pin.lastValue) {
-            shouldUpdate = true;
-          }
+  // Polled digital inputs: one register read, one XOR, report changed bits
+  uint64_t changed = scanDigitalInputs();
+  if (changed) {
+    uint64_t state = getDigitalInputState();
+    while (changed) {
+      uint8_t gpio = (uint8_t)__builtin_ctzll(changed);
+      changed &= changed - 1;
+
+      IoPinConfig *pin = getScannedDigitalInput(gpio);
+      if (!pin) continue;
+      pin->lastValue = digitalInputLevel(state, gpio);
+      broadcastPinValue(*pin);
+    }
+  }
+
+  // Analog inputs are sampled, filtered and reported by the ADC engine
+  updateAdcEngine();
+  flushAnalogStreams();
+
+  // Pulse counters report count and rate at their own interval
+  updatePulseCounters();
+
+  // Report timed output pulses and PWM fades that have finished
+  updatePinPulses();
+  updatePwmFades();
+
+  // Upload a finished triggered capture
+  updatePinCapture();
+}
+
+int readInputPin(IoPinConfig &pinConfig) {
+  switch (pinConfig.kind) {
+    case PIN_KIND_COUNTER:
+      return (int)getPulseCount(pinConfig);
+    case PIN_KIND_FREQUENCY:
+      return (int)lroundf(getPulseFrequency(pinConfig));
+    case PIN_KIND_ANALOG_INPUT:
+      if (isAdcEnginePin(pinConfig)) return getAdcEngineValue(pinConfig);
+      return halAnalogRead(pinConfig.pin);
+    default:
+      return halDigitalRead(pinConfig.pin);
+  }
+}
+
+// Handle pin-related WebSocket messages
+void handlePinMessage(uint32_t clientId, JsonDocument &doc) {
+  const char *action = doc["action"];
+
+  if (strcmp(action, "configure") == 0) {
+    JsonObject config = doc["config"];
+    String id = config["id"];
+    String name = config["name"];
+    uint8_t pin = config["pin"];
+    String mode = config["mode"] | "output";
+    String pinType = config["pinType"] | "digital";
+    PinPullMode pullMode = static_cast<PinPullMode>(config["pullMode"] | 0);
+    uint16_t debounceMs = config["debounceMs"] | 0;
+    bool useInterrupt = config["interrupt"] | false;
+
+    // Analog input sampling options
+    uint8_t adcOversample = config["oversample"] | 1;
+    AdcFilterType adcFilter = parseAdcFilterType(config["filter"] | "none");
+    uint8_t adcFilterWindow = config["filterWindow"] | 4;
+    uint16_t adcDeadband = config["deadband"] | 10;
+    uint16_t adcReportIntervalMs = config["adcReportIntervalMs"] | 0;
+
+    // PWM output options
+    uint32_t pwmFrequency = config["frequency"] | 5000;
+    uint8_t pwmResolution =
+        constrain(config["resolution"] | 8, 1, LEDC_MAX_RESOLUTION_BITS);
+
+    // Pulse counter options ("counter" / "frequency" pins)
+    CounterEdge counterEdge = parseCounterEdge(config["edge"] | "rising");
+    uint16_t counterGlitchFilterNs = config["glitchFilterNs"] | 1000;
+    uint16_t counterReportIntervalMs =
+        config["counterReportIntervalMs"] | 1000;
+
+    logPrintf("Configuring pin %s: %s, %d, %s, %s, %d, %d", id.c_str(),
+              name.c_str(), pin, mode.c_str(), pinType.c_str(), pullMode,
+              debounceMs);
+
+    if (id.isEmpty() || name.isEmpty()) {
+      sendWebSocketMessage(clientId,
+                           F("ERROR: Missing required config fields for pin"));
+      return;
+    }
+    if (!ComponentId::fits(id)) {
+      sendWebSocketMessage(clientId, F("ERROR: Pin id too long"));
+      return;
+    }
+
+    IoPinConfig *existingPin = findPinById(id);
+    if (existingPin) {
+      cleanupPin(*existingPin);  // Clean up before reconfiguring
+      existingPin->name = name;
+      existingPin->pin = pin;
+      existingPin->mode = mode;
+      existingPin->pinType = pinType;
+      existingPin->lastValue = -1;  // Reset last value
+      existingPin->pullMode = pullMode;
+      existingPin->debounceMs = debounceMs;
+      existingPin->useInterrupt = useInterrupt;
+      existingPin->adcOversample = adcOversample;
+      existingPin->adcFilter = adcFilter;
+      existingPin->adcFilterWindow = adcFilterWindow;
+      existingPin->adcDeadband = adcDeadband;
+      existingPin->adcReportIntervalMs = adcReportIntervalMs;
+      existingPin->counterEdge = counterEdge;
+      existingPin->counterGlitchFilterNs = counterGlitchFilterNs;
+      existingPin->counterReportIntervalMs = counterReportIntervalMs;
+      existingPin->pwmFrequency = pwmFrequency;
+      existingPin->pwmResolution = pwmResolution;
+      initializePin(*existingPin);
+    } else {
+      IoPinConfig *newPin = configuredPins.allocate();
+      if (!newPin) {
+        sendWebSocketMessage(clientId, F("ERROR: No free pin slots"));
+        return;
+      }
+      newPin->id = id;
+      newPin->name = name;
+      newPin->pin = pin;
+      newPin->pinType = pinType;
+      newPin->mode = mode;
+      newPin->lastValue = -1;
+      newPin->pullMode = pullMode;
+      newPin->debounceMs = debounceMs;
+      newPin->useInterrupt = useInterrupt;
+      newPin->adcOversample = adcOversample;
+      newPin->adcFilter = adcFilter;
+      newPin->adcFilterWindow = adcFilterWindow;
+      newPin->adcDeadband = adcDeadband;
+      newPin->adcReportIntervalMs = adcReportIntervalMs;
+      newPin->counterEdge = counterEdge;
+      newPin->counterGlitchFilterNs = counterGlitchFilterNs;
+      newPin->counterReportIntervalMs = counterReportIntervalMs;
+      newPin->pwmFrequency = pwmFrequency;
+      newPin->pwmResolution = pwmResolution;
+      initializePin(*newPin);
+    }
+    StaticJsonDocument<128> response;
+    response["status"] = F("OK");
+    response["message"] = F("Pin configured");
+    response["id"] = id;
+    String jsonResponse;
+    serializeJson(response, jsonResponse);
+    sendWebSocketMessage(clientId, jsonResponse);
+
+  } else if (strcmp(action, "readPin") == 0) {
+    String id = doc["id"];
+    IoPinConfig *pinToRead = findPinById(id);
+    if (!pinToRead) {
+      sendWebSocketMessage(clientId, F("ERROR: Pin not found"));
+      return;
+    }
+    if (pinToRead->mode != "input") {
+      sendWebSocketMessage(clientId,
+                           F("ERROR: Pin is not configured as input"));
+      return;
+    }
+    int value = readInputPin(*pinToRead);
+    pinToRead->lastValue = value;
+    StaticJsonDocument<128> response;
+    response["status"] = F("OK");
+    response["id"] = pinToRead->id.c_str();
+    response["value"] = value;
+    String jsonResponse;
+    serializeJson(response, jsonResponse);
+    sendWebSocketMessage(clientId, jsonResponse);
+
+  } else if (strcmp(action, "writePin") == 0) {
+    String id = doc["id"];
+    int value = doc["value"];
+    String type =
+        doc["type"] | "digital";  // Default to digital if not specified
+
+    IoPinConfig *pinToWrite = findPinById(id);
+    if (!pinToWrite) {
+      sendWebSocketMessage(clientId, F("ERROR: Pin not found"));
+      return;
+    }
+    if (pinToWrite->mode != "output") {
+      sendWebSocketMessage(clientId,
+                           F("ERROR: Pin is not configured as output"));
+      return;
+    }
+
+    // An explicit write takes over from a running pulse
+    cancelPinPulse(*pinToWrite);
+
+    if (type == "digital") {
+      halDigitalWrite(pinToWrite->pin, value ? HIGH : LOW);
+    } else if (type == "pwm") {
+      if (isPwmFading(*pinToWrite)) {
+        sendWebSocketMessage(clientId, F("ERROR: Pin is fading"));
+        return;
+      }
+      if (!writePwmDuty(*pinToWrite, value)) {
+        sendWebSocketMessage(clientId, F("ERROR: PWM pin is not active"));
+        return;
+      }
+    } else if (type == "analog") {  // ESP32 DAC
+      if (pinToWrite->pin == 25 || pinToWrite->pin == 26) {
+        // dacWrite(pinToWrite->pin, constrain(value, 0, 255));
+      } else {
+        sendWebSocketMessage(
+            clientId, F("ERROR: Pin does not support analog output (DAC)"));
+        return;
+      }
+    }
+    pinToWrite->lastValue = value;
+    StaticJsonDocument<128> response;
+    response["status"] = F("OK");
+    response["message"] = F("Pin value updated");
+    response["id"] = pinToWrite->id.c_str();
+    response["value"] = value;
+    String jsonResponse;
+    serializeJson(response, jsonResponse);
+    sendWebSocketMessage(clientId, jsonResponse);
+
+  } else if (strcmp(action, "writeMany") == 0) {
+    // Either explicit GPIO masks or an id -> value map
+    uint64_t outputMask = getDigitalOutputMask();
+    uint64_t setMask = doc["setMask"] | 0ULL;
+    uint64_t clearMask = doc["clearMask"] | 0ULL;
+
+    JsonObject values = doc["values"];
+    if (!values.isNull()) {
+      for (JsonPair entry : values) {
+        IoPinConfig *pin = findPinById(entry.key().c_str());
+        if (!pin || pin->mode != "output" || pin->pinType != "digital") {
+          sendWebSocketMessage(
+              clientId, String(F("ERROR: Not a digital output: ")) +
+                          entry.key().c_str());
+          return;
         }
-      } else if (pin.pinType == "analog") {
-        // Only read analog values at specified intervals
-        if (now - lastPinReadTime[pin.id] >= analogInputReadInterval) {
-          lastPinReadTime[pin.id] = now;
-          currentValue = analogRead(pin.pin);
-
-          // For analog, only update if value changed by more than 1%
-          int threshold = 10;  // About 1% of 1023
-          if (abs(currentValue - pin.lastValue) > threshold) {
-            shouldUpdate = true;
-          }
+        uint64_t bit = 1ULL << pin->pin;
+        if (entry.value().as<int>()) {
+          setMask |= bit;
+        } else {
+          clearMask |= bit;
         }
       }
+    }
+
+    if ((setMask | clearMask) == 0) {
+      sendWebSocketMessage(
+          clientId, F("ERROR: writeMany needs values or set/clear masks"));
+      return;
+    }
+    if ((setMask | clearMask) & ~outputMask) {
+      sendWebSocketMessage(
+          clientId, F("ERROR: writeMany mask includes non-output pins"));
+      return;
+    }
+    if (setMask & clearMask) {
+      sendWebSocketMessage(clientId,
+                           F("ERROR: writeMany set and clear masks overlap"));
+      return;
+    }
 
-      if (shouldUpdate) {
-        pin.lastValue = currentValue;
+    writeDigitalOutputs(setMask, clearMask);
 
-        // Send update to all websocket clients
-        StaticJsonDocument<128> msg;
-        msg["id"] = pin.id;
-        msg["value"] = currentValue;
-        msg["type"] = pin.pinType;
-        msg["mode"] = pin.mode;
+    StaticJsonDocument<128> response;
+    response["status"] = F("OK");
+    response["message"] = F("Pins updated");
+    response["componentGroup"] = F("pins");
+    response["count"] = __builtin_popcountll(setMask | clearMask);
+    String jsonResponse;
+    serializeJson(response, jsonResponse);
+    sendWebSocketMessage(clientId, jsonResponse);
 
-        String out;
-        serializeJson(msg, out);
+    broadcastPinValues(setMask | clearMask);
 
-        broadcastWebSocketMessage(out);
+  } else if (strcmp(action, "startStream") == 0 ||
+             strcmp(action, "stopStream") == 0) {
+    String id = doc["id"];
+    IoPinConfig *pin = findPinById(id);
+    if (!pin) {
+      sendWebSocketMessage(clientId, F("ERROR: Pin not found"));
+      return;
+    }
+
+    bool start = strcmp(action, "startStream") == 0;
+    if (start) {
+      uint16_t chunkSamples = doc["chunkSamples"] | 256;
+      if (!startAnalogStream(*pin, chunkSamples)) {
+        sendWebSocketMessage(
+            clientId, F("ERROR: Pin is not a DMA-sampled analog input"));
+        return;
       }
+    } else {
+      stopAnalogStream(*pin);
+    }
+
+    StaticJsonDocument<192> response;
+    response["status"] = F("OK");
+    response["message"] = start ? F("Stream started") : F("Stream stopped");
+    response["id"] = pin->id.c_str();
+    response["componentGroup"] = F("pins");
+    if (start) {
+      response["sampleRateHz"] = getAdcChannelSampleRateMilliHz() / 1000.0;
+    }
+    String jsonResponse;
+    serializeJson(response, jsonResponse);
+    sendWebSocketMessage(clientId, jsonResponse);
+
+  } else if (strcmp(action, "fade") == 0) {
+    handlePinFadeRequest(clientId, doc);
+
+  } else if (strcmp(action, "pulse") == 0) {
+    handlePinPulseRequest(clientId, doc);
+
+  } else if (strcmp(action, "resetCounter") == 0) {
+    String id = doc["id"];
+    IoPinConfig *counterPin = findPinById(id);
+    if (!counterPin || counterPin->pcntUnit < 0) {
+      sendWebSocketMessage(clientId, F("ERROR: Pulse counter not found"));
+      return;
+    }
+    resetPulseCounter(*counterPin);
+    sendWebSocketMessage(clientId, F("OK: Counter reset"));
+
+  } else if (strcmp(action, "capture") == 0) {
+    handlePinCaptureRequest(clientId, doc);
+
+  } else if (strcmp(action, "cancelCapture") == 0) {
+    if (cancelPinCapture()) {
+      sendWebSocketMessage(clientId, F("OK: Capture cancelled"));
+    } else {
+      sendWebSocketMessage(clientId, F("ERROR: No capture running"));
+    }
+
+  } else if (strcmp(action, "remove") == 0) {
+    String id = doc["id"];
+    IoPinConfig *pinToRemove = findPinById(id);
+    if (pinToRemove) {
+      cleanupPin(*pinToRemove);  // Clean up before releasing the slot
+      configuredPins.release(pinToRemove);
+      // The poll tables index configuredPins slots
+      invalidateDigitalInputScan();
+      invalidateAdcEngine();
+      invalidatePulseCounters();
+      sendWebSocketMessage(clientId, F("OK: Pin removed"));
+    } else {
+      sendWebSocketMessage(clientId, F("ERROR: Pin not found for removal"));
     }
+  } else {
+    sendWebSocketMessage(clientId, F("ERROR: Unknown pin action"));
   }
-}
\ No newline at end of file
+}
@@ -1,8 +1,13 @@
 #ifndef IO_PIN_H
 #define IO_PIN_H
 
+#include <ArduinoJson.h>
+
 #include "../config.h"
 
+// Compile a pin's pinType/mode strings into its PinKind
+PinKind classifyPin(const char *pinType, const char *mode);
+
 // Initialize a pin based on its configuration
 void initializePin(IoPinConfig &pinConfig);
 
@@ -12,4 +17,25 @@ void cleanupPin(IoPinConfig &pinConfig);
 // Update and report pin values
 void updatePinValues();
 
+// Broadcast a pin's current value to all websocket clients
+void broadcastPinValue(const IoPinConfig &pin);
+
+// Read an input pin's current value (filtered for DMA-sampled analog pins)
+int readInputPin(IoPinConfig &pinConfig);
+
+// GPIO bitmask of all pins configured as digital outputs (bit n = GPIO n)
+uint64_t getDigitalOutputMask();
+
+// Drive several digital outputs at once through the GPIO W1TS/W1TC registers.
+// Within a register bank the pins being set change together on one store and
+// those being cleared on the next, so a mask with both is not glitch-free.
+// Masks must only contain configured digital outputs and must not overlap.
+void writeDigitalOutputs(uint64_t setMask, uint64_t clearMask);
+
+// Broadcast one coalesced value update for every output in the mask
+void broadcastPinValues(uint64_t gpioMask);
+
+// Handle pin-related WebSocket messages
+void handlePinMessage(uint32_t clientId, JsonDocument &doc);
+
 #endif  // IO_PIN_H
\ No newline at end of file
@@ -0,0 +1,408 @@
+#include "pin_capture.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+
+#include <atomic>
+#include <vector>
+
+#include "../binary_frames.h"
+#include "../hal/hal_transport.h"
+#include "../system/tasks.h"
+#include "adc_engine.h"
+
+extern void sendWebSocketMessage(uint32_t clientId,
+                                 const String &message);
+extern void sendWebSocketBinary(uint32_t clientId,
+                                std::vector<uint8_t> &&payload);
+
+static const size_t CAPTURE_BUFFER_BYTES = 32768;
+static const size_t CAPTURE_CHUNK_BYTES = 2048;  // Frame bytes per data frame
+static const uint32_t CAPTURE_MAX_RATE_HZ = 20000;
+static const uint8_t CAPTURE_MAX_DIGITAL_CHANNELS = 32;
+static const uint8_t CAPTURE_MAX_ANALOG_CHANNELS = 8;
+
+enum CaptureState : uint8_t {
+  CAPTURE_IDLE = 0,
+  CAPTURE_ARMED,      // Filling the pre-trigger ring, waiting for trigger
+  CAPTURE_TRIGGERED,  // Recording post-trigger frames
+  CAPTURE_DONE,       // Waiting for updatePinCapture() to upload
+  CAPTURE_UPLOADING   // Sending the ring in chunks; it must not be rearmed
+};
+
+struct CaptureChannel {
+  uint8_t gpio;
+  ComponentId id;
+  int8_t adcChannel;  // Analog channels only
+};
+
+// Preallocated frame storage, used as a ring of preFrames + postFrames
+static uint8_t captureBuffer[CAPTURE_BUFFER_BYTES];
+
+static CaptureChannel digitalChannels[CAPTURE_MAX_DIGITAL_CHANNELS];
+static CaptureChannel analogChannels[CAPTURE_MAX_ANALOG_CHANNELS];
+static uint8_t digitalChannelCount = 0;
+static uint8_t analogChannelCount = 0;
+static uint64_t outputChannelMask = 0;  // Digital channels read from GPIO_OUT
+
+static size_t frameBytes = 0;
+static uint32_t ringFrames = 0;
+static uint32_t preFrames = 0;
+static uint32_t postFrames = 0;
+static uint32_t writeIndex = 0;     // Next ring slot
+static uint32_t framesWritten = 0;  // Frames recorded since arming
+static uint32_t triggerFrameNumber = 0;
+static int64_t firstFrameUs = 0;
+static uint32_t captureRateHz = 0;
+
+static CaptureTriggerType triggerType = CAPTURE_TRIGGER_IMMEDIATE;
+static uint8_t triggerChannel = 0;  // Index into digital or analog channels
+static uint16_t triggerThreshold = 0;
+static uint32_t previousDigital = 0;
+static uint16_t previousAnalog = 0;
+
+static std::atomic<uint8_t> captureState{CAPTURE_IDLE};
+static esp_timer_handle_t captureTimer = nullptr;
+static uint32_t requesterClientId = 0;
+
+// Upload progress, in frames from the oldest one in the ring
+static uint32_t uploadOldest = 0;
+static uint32_t uploadFrameCount = 0;
+static uint32_t uploadSent = 0;
+
+// Pack the selected digital channels into one bitfield
+static inline uint32_t sampleDigitalChannels() {
+  uint64_t in = (uint64_t)REG_READ(GPIO_IN_REG) |
+                ((uint64_t)REG_READ(GPIO_IN1_REG) << 32);
+  uint64_t out = (uint64_t)REG_READ(GPIO_OUT_REG) |
+                 ((uint64_t)REG_READ(GPIO_OUT1_REG) << 32);
+  uint64_t levels = (in & ~outputChannelMask) | (out & outputChannelMask);
+
+  uint32_t bits = 0;
+  for (uint8_t i = 0; i < digitalChannelCount; i++) {
+    bits |= (uint32_t)((levels >> digitalChannels[i].gpio) & 0x1) << i;
+  }
+  return bits;
+}
+
+// Evaluate the trigger against the current and previous frame
+static bool triggerFired(uint32_t digital, const uint16_t *analog) {
+  bool fired = false;
+  switch (triggerType) {
+    case CAPTURE_TRIGGER_IMMEDIATE:
+      return true;
+    case CAPTURE_TRIGGER_RISING:
+    case CAPTURE_TRIGGER_FALLING:
+    case CAPTURE_TRIGGER_EDGE: {
+      bool now = (digital >> triggerChannel) & 0x1;
+      bool before = (previousDigital >> triggerChannel) & 0x1;
+      fired = (now != before) &&
+              (triggerType == CAPTURE_TRIGGER_EDGE ||
+               (triggerType == CAPTURE_TRIGGER_RISING) == now);
+      break;
+    }
+    case CAPTURE_TRIGGER_ABOVE:
+      fired = previousAnalog < triggerThreshold &&
+              analog[triggerChannel] >= triggerThreshold;
+      break;
+    case CAPTURE_TRIGGER_BELOW:
+      fired = previousAnalog > triggerThreshold &&
+              analog[triggerChannel] <= triggerThreshold;
+      break;
+  }
+  return fired;
+}
+
+// Timer callback: record one frame and advance the capture state
+static void captureTick(void *arg) {
+  uint8_t state = captureState.load();
+  if (state != CAPTURE_ARMED && state != CAPTURE_TRIGGERED) return;
+
+  uint8_t *frame = captureBuffer + writeIndex * frameBytes;
+  uint32_t digital = sampleDigitalChannels();
+  uint16_t analog[CAPTURE_MAX_ANALOG_CHANNELS];
+  for (uint8_t i = 0; i < analogChannelCount; i++) {
+    analog[i] = getAdcLatestRaw(analogChannels[i].adcChannel);
+  }
+  memcpy(frame, &digital, sizeof(digital));
+  memcpy(frame + sizeof(digital), analog, analogChannelCount * sizeof(uint16_t));
+
+  if (framesWritten == 0) {
+    firstFrameUs = esp_timer_get_time();
+  } else if (state == CAPTURE_ARMED && framesWritten >= preFrames &&
+             triggerFired(digital, analog)) {
+    // Only trigger once the pre-trigger window is full
+    state = CAPTURE_TRIGGERED;
+    triggerFrameNumber = framesWritten;
+    captureState = CAPTURE_TRIGGERED;
+  }
+  if (framesWritten == 0 && triggerType == CAPTURE_TRIGGER_IMMEDIATE &&
+      preFrames == 0) {
+    state = CAPTURE_TRIGGERED;
+    triggerFrameNumber = 0;
+    captureState = CAPTURE_TRIGGERED;
+  }
+
+  previousDigital = digital;
+  if (triggerType == CAPTURE_TRIGGER_ABOVE ||
+      triggerType == CAPTURE_TRIGGER_BELOW) {
+    previousAnalog = analog[triggerChannel];
+  }
+
+  framesWritten++;
+  writeIndex = (writeIndex + 1) % ringFrames;
+
+  if (state == CAPTURE_TRIGGERED &&
+      framesWritten - triggerFrameNumber >= postFrames) {
+    esp_timer_stop(captureTimer);
+    captureState = CAPTURE_DONE;
+  }
+}
+
+// Parse a trigger type name
+static bool parseTriggerType(const char *name, CaptureTriggerType &type) {
+  if (!name || strcmp(name, "immediate") == 0) {
+    type = CAPTURE_TRIGGER_IMMEDIATE;
+  } else if (strcmp(name, "rising") == 0) {
+    type = CAPTURE_TRIGGER_RISING;
+  } else if (strcmp(name, "falling") == 0) {
+    type = CAPTURE_TRIGGER_FALLING;
+  } else if (strcmp(name, "edge") == 0) {
+    type = CAPTURE_TRIGGER_EDGE;
+  } else if (strcmp(name, "above") == 0) {
+    type = CAPTURE_TRIGGER_ABOVE;
+  } else if (strcmp(name, "below") == 0) {
+    type = CAPTURE_TRIGGER_BELOW;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void handlePinCaptureRequest(uint32_t clientId, JsonDocument &doc) {
+  if (transportEndpoint(clientId) == ENDPOINT_UDP) {  // Uploads need WS
+    sendWebSocketMessage(clientId, F("ERROR: Captures need a WebSocket"));
+    return;
+  }
+  uint8_t state = captureState.load();
+  if (state == CAPTURE_ARMED || state == CAPTURE_TRIGGERED ||
+      state == CAPTURE_UPLOADING) {
+    sendWebSocketMessage(clientId, F("ERROR: A capture is already running"));
+    return;
+  }
+
+  // Resolve the channel list
+  digitalChannelCount = 0;
+  analogChannelCount = 0;
+  outputChannelMask = 0;
+  JsonArray pins = doc["pins"];
+  if (pins.isNull() || pins.size() == 0) {
+    sendWebSocketMessage(clientId, F("ERROR: Missing 'pins' for capture"));
+    return;
+  }
+  for (JsonVariant entry : pins) {
+    String id = entry.as<String>();
+    IoPinConfig *pin = findPinById(id);
+    if (!pin) {
+      sendWebSocketMessage(clientId, String(F("ERROR: Pin not found: ")) + id);
+      return;
+    }
+
+    if (pin->kind == PIN_KIND_DIGITAL_INPUT ||
+        pin->kind == PIN_KIND_DIGITAL_OUTPUT) {
+      if (digitalChannelCount >= CAPTURE_MAX_DIGITAL_CHANNELS) {
+        sendWebSocketMessage(clientId, F("ERROR: Too many digital channels"));
+        return;
+      }
+      digitalChannels[digitalChannelCount++] = {pin->pin, pin->id, -1};
+      if (pin->kind == PIN_KIND_DIGITAL_OUTPUT) {
+        outputChannelMask |= 1ULL << pin->pin;
+      }
+    } else if (pin->kind == PIN_KIND_ANALOG_INPUT &&
+               getAdcEngineChannel(*pin) >= 0) {
+      if (analogChannelCount >= CAPTURE_MAX_ANALOG_CHANNELS) {
+        sendWebSocketMessage(clientId, F("ERROR: Too many analog channels"));
+        return;
+      }
+      analogChannels[analogChannelCount++] = {pin->pin, pin->id,
+                                              getAdcEngineChannel(*pin)};
+    } else {
+      sendWebSocketMessage(
+          clientId, String(F("ERROR: Pin cannot be captured: ")) + id);
+      return;
+    }
+  }
+
+  // Trigger
+  JsonObject trigger = doc["trigger"];
+  if (!parseTriggerType(trigger["type"] | "immediate", triggerType)) {
+    sendWebSocketMessage(clientId, F("ERROR: Unknown capture trigger type"));
+    return;
+  }
+  triggerChannel = 0;
+  triggerThreshold = trigger["threshold"] | 0;
+  if (triggerType != CAPTURE_TRIGGER_IMMEDIATE) {
+    String triggerId = trigger["id"] | "";
+    bool analogTrigger = triggerType == CAPTURE_TRIGGER_ABOVE ||
+                         triggerType == CAPTURE_TRIGGER_BELOW;
+    bool found = false;
+    uint8_t count = analogTrigger ? analogChannelCount : digitalChannelCount;
+    CaptureChannel *list = analogTrigger ? analogChannels : digitalChannels;
+    for (uint8_t i = 0; i < count; i++) {
+      if (list[i].id == triggerId) {
+        triggerChannel = i;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      sendWebSocketMessage(
+          clientId, F("ERROR: Trigger pin must be one of the captured pins"));
+      return;
+    }
+  }
+
+  // Size the ring
+  frameBytes = sizeof(uint32_t) + analogChannelCount * sizeof(uint16_t);
+  uint32_t maxFrames = CAPTURE_BUFFER_BYTES / frameBytes;
+  preFrames = doc["preSamples"] | 0;
+  postFrames = doc["postSamples"] | 1000;
+  if (postFrames == 0) postFrames = 1;
+  if (preFrames + postFrames > maxFrames) {
+    sendWebSocketMessage(
+        clientId, String(F("ERROR: Capture too long; max frames ")) +
+                    String(maxFrames));
+    return;
+  }
+  ringFrames = preFrames + postFrames;
+  captureRateHz =
+      constrain<uint32_t>(doc["sampleRateHz"] | 1000, 1, CAPTURE_MAX_RATE_HZ);
+
+  if (!captureTimer) {
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = captureTick;
+    timerArgs.name = "pin_capture";
+    if (esp_timer_create(&timerArgs, &captureTimer) != ESP_OK) {
+      sendWebSocketMessage(clientId,
+                           F("ERROR: Could not create capture timer"));
+      return;
+    }
+  }
+
+  writeIndex = 0;
+  framesWritten = 0;
+  triggerFrameNumber = 0;
+  previousDigital = sampleDigitalChannels();
+  previousAnalog = triggerThreshold;
+  requesterClientId = clientId;
+  captureState = CAPTURE_ARMED;
+  esp_timer_start_periodic(captureTimer, 1000000ULL / captureRateHz);
+
+  StaticJsonDocument<192> response;
+  response["status"] = F("OK");
+  response["message"] = F("Capture armed");
+  response["componentGroup"] = F("pins");
+  response["sampleRateHz"] = captureRateHz;
+  response["frames"] = ringFrames;
+  String jsonResponse;
+  serializeJson(response, jsonResponse);
+  sendWebSocketMessage(clientId, jsonResponse);
+}
+
+bool cancelPinCapture() {
+  uint8_t state = captureState.load();
+  if (state == CAPTURE_IDLE) return false;
+  if (captureTimer) esp_timer_stop(captureTimer);
+  captureState = CAPTURE_IDLE;
+  return true;
+}
+
+// Send the header frame: capture timing and the channel descriptors
+static void sendCaptureHeader(uint32_t clientId, uint32_t frameCount,
+                              uint32_t firstFrameNumber) {
+  size_t descriptorBytes = 0;
+  for (uint8_t i = 0; i < digitalChannelCount; i++) {
+    descriptorBytes += 2 + min<size_t>(digitalChannels[i].id.length(), 255);
+  }
+  for (uint8_t i = 0; i < analogChannelCount; i++) {
+    descriptorBytes += 2 + min<size_t>(analogChannels[i].id.length(), 255);
+  }
+  std::vector<uint8_t> payload(sizeof(PinCaptureHeader) + descriptorBytes);
+  uint8_t *out = payload.data();
+
+  PinCaptureHeader header;
+  header.frameType = BINARY_FRAME_PIN_CAPTURE;
+  header.version = PIN_CAPTURE_FRAME_VERSION;
+  header.digitalChannels = digitalChannelCount;
+  header.analogChannels = analogChannelCount;
+  header.sampleRateHz = captureRateHz;
+  header.frameCount = frameCount;
+  header.triggerFrame = triggerFrameNumber - firstFrameNumber;
+  header.startUs = (uint64_t)firstFrameUs +
+                   (uint64_t)firstFrameNumber * 1000000ULL / captureRateHz;
+  memcpy(out, &header, sizeof(header));
+  out += sizeof(header);
+
+  for (uint8_t list = 0; list < 2; list++) {
+    CaptureChannel *channels = list == 0 ? digitalChannels : analogChannels;
+    uint8_t count = list == 0 ? digitalChannelCount : analogChannelCount;
+    for (uint8_t i = 0; i < count; i++) {
+      uint8_t idLength = (uint8_t)min<size_t>(channels[i].id.length(), 255);
+      *out++ = channels[i].gpio;
+      *out++ = idLength;
+      memcpy(out, channels[i].id.c_str(), idLength);
+      out += idLength;
+    }
+  }
+  sendWebSocketBinary(clientId, std::move(payload));
+}
+
+// Send the next run of frames straight out of the ring. A chunk never wraps
+// around the end of the ring, so it is always one contiguous copy.
+static void sendCaptureChunk() {
+  uint32_t ringIndex = (uploadOldest + uploadSent) % ringFrames;
+  uint32_t frames = min(uploadFrameCount - uploadSent, ringFrames - ringIndex);
+  frames = min<uint32_t>(frames, CAPTURE_CHUNK_BYTES / frameBytes);
+
+  PinCaptureDataHeader header;
+  header.frameType = BINARY_FRAME_PIN_CAPTURE_DATA;
+  header.version = PIN_CAPTURE_FRAME_VERSION;
+  header.frameCount = (uint16_t)frames;
+  header.firstFrame = uploadSent;
+
+  std::vector<uint8_t> payload(sizeof(header) + frames * frameBytes);
+  memcpy(payload.data(), &header, sizeof(header));
+  memcpy(payload.data() + sizeof(header),
+         captureBuffer + ringIndex * frameBytes, frames * frameBytes);
+  sendWebSocketBinary(requesterClientId, std::move(payload));
+  uploadSent += frames;
+}
+
+void updatePinCapture() {
+  uint8_t state = captureState.load();
+  if (state == CAPTURE_DONE) {
+    // Frames to upload: the ring's content, oldest first
+    uploadFrameCount = min(framesWritten, ringFrames);
+    uploadOldest = framesWritten > ringFrames ? writeIndex : 0;
+    uploadSent = 0;
+    // A requester that has disconnected is skipped by the network task
+    sendCaptureHeader(requesterClientId, uploadFrameCount,
+                      framesWritten - uploadFrameCount);
+    captureState = CAPTURE_UPLOADING;
+    return;
+  }
+  if (state != CAPTURE_UPLOADING) return;
+
+  // One chunk per pass, and only while the outbound rings have room, so the
+  // upload never crowds out (or gets dropped behind) other traffic
+  if (getQueueDepths().outbound >= OUTBOUND_MESSAGE_QUEUE_SIZE / 2) return;
+  sendCaptureChunk();
+  if (uploadSent < uploadFrameCount) return;
+
+  captureState = CAPTURE_IDLE;
+  logLine("CAPTURE: ", String(F("uploaded ")) + uploadFrameCount +
+                           F(" frames, ") + uploadFrameCount * frameBytes +
+                           F(" bytes"));
+}
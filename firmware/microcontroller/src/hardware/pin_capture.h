@@ -0,0 +1,36 @@
+#ifndef PIN_CAPTURE_H
+#define PIN_CAPTURE_H
+
+#include <ArduinoJson.h>
+
+#include "../config.h"
+
+// --- Triggered Pin Capture ---
+// Logic-analyzer style recording of a set of pins at a fixed rate into a
+// preallocated RAM buffer. Frames are written to a circular pre-trigger
+// region until the trigger fires, then the post-trigger frames are recorded
+// and the window is uploaded to the requesting client: a header frame, then
+// the frames in chunks sent straight from the buffer (see binary_frames.h).
+// The buffer cannot be rearmed until the upload has been queued. Digital
+// channels come from one read of the GPIO registers per frame; analog
+// channels take the most recent conversion of the DMA ADC engine.
+
+enum CaptureTriggerType {
+  CAPTURE_TRIGGER_IMMEDIATE = 0,  // Fire as soon as the pre-trigger window is full
+  CAPTURE_TRIGGER_RISING,         // Digital channel goes LOW -> HIGH
+  CAPTURE_TRIGGER_FALLING,        // Digital channel goes HIGH -> LOW
+  CAPTURE_TRIGGER_EDGE,           // Either edge on a digital channel
+  CAPTURE_TRIGGER_ABOVE,          // Analog channel crosses above threshold
+  CAPTURE_TRIGGER_BELOW           // Analog channel crosses below threshold
+};
+
+// Handle a pins "capture" request (arms a capture and replies)
+void handlePinCaptureRequest(uint32_t clientId, JsonDocument &doc);
+
+// Cancel a running capture; returns false if none was running
+bool cancelPinCapture();
+
+// Upload a finished capture (called from the main loop)
+void updatePinCapture();
+
+#endif  // PIN_CAPTURE_H
@@ -0,0 +1,258 @@
+#include "pulse_counter.h"
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <driver/pcnt.h>
+#include <esp_timer.h>
+
+#include "../util/poll_tables.h"
+
+// Forward declaration for WebSocket broadcast function
+extern void broadcastTelemetryMessage(const String &message);
+
+// The counter wraps to zero at this limit and raises an interrupt
+static const int16_t PCNT_HIGH_LIMIT = 32767;
+
+// The glitch filter counts APB (80 MHz) cycles in a 10-bit register
+static const uint32_t PCNT_APB_MHZ = 80;
+static const uint16_t PCNT_MAX_FILTER_CYCLES = 1023;
+
+struct PulseCounterState {
+  bool inUse = false;
+  volatile uint32_t overflows = 0;  // Incremented by the PCNT ISR
+  int64_t offset = 0;               // Subtracted on reset
+  int64_t lastTotal = 0;            // Keeps the total monotonic
+  int64_t intervalStartCount = 0;
+  int64_t intervalStartUs = 0;
+  float frequencyHz = 0;
+};
+
+static PulseCounterState counterUnits[PCNT_UNIT_MAX];
+static bool pcntIsrServiceInstalled = false;
+
+// Attached counters in report order, rebuilt when counters change
+static CounterPollTable counterTable;
+static bool counterTableDirty = true;
+
+// Overflow ISR: the counter just wrapped from PCNT_HIGH_LIMIT to zero
+static void IRAM_ATTR onPulseCounterOverflow(void *arg) {
+  pcnt_unit_t unit = (pcnt_unit_t)(uintptr_t)arg;
+  uint32_t status = 0;
+  pcnt_get_event_status(unit, &status);
+  if (status & PCNT_EVT_H_LIM) counterUnits[unit].overflows++;
+}
+
+// Read the extended 64-bit count of a unit
+static int64_t readUnitTotal(pcnt_unit_t unit) {
+  PulseCounterState &state = counterUnits[unit];
+  uint32_t before, after;
+  int16_t count = 0;
+  do {
+    before = state.overflows;
+    pcnt_get_counter_value(unit, &count);
+    after = state.overflows;
+  } while (before != after);
+
+  int64_t total = (int64_t)after * PCNT_HIGH_LIMIT + count;
+
+  // A wrap whose interrupt has not been serviced yet reads as a small count
+  // with the old overflow total; the counter only counts up, so correct it
+  if (total < state.lastTotal) total += PCNT_HIGH_LIMIT;
+  state.lastTotal = total;
+  return total;
+}
+
+// Pick the highest free unit, staying clear of the stepper driver's units
+static int8_t allocatePcntUnit() {
+  for (int unit = PCNT_UNIT_MAX - 1; unit >= PCNT_UNIT_MAX - MAX_PULSE_COUNTERS;
+       unit--) {
+    if (!counterUnits[unit].inUse) return unit;
+  }
+  return -1;
+}
+
+bool attachPulseCounter(IoPinConfig &pinConfig) {
+  int8_t unit = allocatePcntUnit();
+  if (unit < 0) {
+    Serial.printf("ERROR: No free pulse counter for pin %s (max %d)\n",
+                  pinConfig.id.c_str(), MAX_PULSE_COUNTERS);
+    return false;
+  }
+  pcnt_unit_t pcntUnit = (pcnt_unit_t)unit;
+
+  pcnt_config_t config = {};
+  config.pulse_gpio_num = pinConfig.pin;
+  config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+  config.lctrl_mode = PCNT_MODE_KEEP;
+  config.hctrl_mode = PCNT_MODE_KEEP;
+  config.pos_mode = pinConfig.counterEdge == COUNTER_EDGE_FALLING
+                        ? PCNT_COUNT_DIS
+                        : PCNT_COUNT_INC;
+  config.neg_mode = pinConfig.counterEdge == COUNTER_EDGE_RISING
+                        ? PCNT_COUNT_DIS
+                        : PCNT_COUNT_INC;
+  config.counter_h_lim = PCNT_HIGH_LIMIT;
+  config.counter_l_lim = -1;
+  config.unit = pcntUnit;
+  config.channel = PCNT_CHANNEL_0;
+  if (pcnt_unit_config(&config) != ESP_OK) {
+    Serial.printf("ERROR: PCNT configuration failed for pin %s\n",
+                  pinConfig.id.c_str());
+    return false;
+  }
+
+  // pcnt_unit_config() resets the pad pulls, so apply the configured ones
+  if (pinConfig.pullMode == PULL_UP) {
+    pinMode(pinConfig.pin, INPUT_PULLUP);
+  } else if (pinConfig.pullMode == PULL_DOWN) {
+    pinMode(pinConfig.pin, INPUT_PULLDOWN);
+  }
+
+  uint32_t filterCycles =
+      (uint32_t)pinConfig.counterGlitchFilterNs * PCNT_APB_MHZ / 1000;
+  if (filterCycles > 0) {
+    pcnt_set_filter_value(pcntUnit,
+                          min<uint32_t>(filterCycles, PCNT_MAX_FILTER_CYCLES));
+    pcnt_filter_enable(pcntUnit);
+  } else {
+    pcnt_filter_disable(pcntUnit);
+  }
+
+  if (!pcntIsrServiceInstalled) {
+    // The stepper driver may already have installed the shared service
+    esp_err_t err = pcnt_isr_service_install(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+      Serial.printf("ERROR: PCNT ISR service install failed (%d)\n", err);
+      return false;
+    }
+    pcntIsrServiceInstalled = true;
+  }
+
+  PulseCounterState &state = counterUnits[unit];
+  state = PulseCounterState();
+  state.inUse = true;
+  state.intervalStartUs = esp_timer_get_time();
+  counterTableDirty = true;
+
+  pcnt_counter_pause(pcntUnit);
+  pcnt_counter_clear(pcntUnit);
+  pcnt_isr_handler_add(pcntUnit, onPulseCounterOverflow,
+                       (void *)(uintptr_t)unit);
+  pcnt_event_enable(pcntUnit, PCNT_EVT_H_LIM);
+  pcnt_counter_resume(pcntUnit);
+
+  pinConfig.pcntUnit = unit;
+  pinConfig.lastValue = 0;
+  Serial.printf("Pin %s counting on PCNT unit %d\n", pinConfig.id.c_str(),
+                unit);
+  return true;
+}
+
+void detachPulseCounter(IoPinConfig &pinConfig) {
+  if (pinConfig.pcntUnit < 0) return;
+  pcnt_unit_t unit = (pcnt_unit_t)pinConfig.pcntUnit;
+
+  pcnt_counter_pause(unit);
+  pcnt_event_disable(unit, PCNT_EVT_H_LIM);
+  pcnt_isr_handler_remove(unit);
+  pcnt_counter_clear(unit);
+
+  // Route the pin away from the counter before it changes mode
+  pcnt_config_t config = {};
+  config.pulse_gpio_num = PCNT_PIN_NOT_USED;
+  config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+  config.unit = unit;
+  config.channel = PCNT_CHANNEL_0;
+  pcnt_unit_config(&config);
+
+  counterUnits[unit].inUse = false;
+  pinConfig.pcntUnit = -1;
+  counterTableDirty = true;
+}
+
+int64_t getPulseCount(const IoPinConfig &pinConfig) {
+  if (pinConfig.pcntUnit < 0) return 0;
+  pcnt_unit_t unit = (pcnt_unit_t)pinConfig.pcntUnit;
+  return readUnitTotal(unit) - counterUnits[unit].offset;
+}
+
+float getPulseFrequency(const IoPinConfig &pinConfig) {
+  if (pinConfig.pcntUnit < 0) return 0;
+  return counterUnits[pinConfig.pcntUnit].frequencyHz;
+}
+
+void resetPulseCounter(IoPinConfig &pinConfig) {
+  if (pinConfig.pcntUnit < 0) return;
+  pcnt_unit_t unit = (pcnt_unit_t)pinConfig.pcntUnit;
+  PulseCounterState &state = counterUnits[unit];
+  // Offset rather than clear, so the overflow bookkeeping stays consistent
+  int64_t total = readUnitTotal(unit);
+  state.offset = total;
+  state.intervalStartCount = total;
+  state.intervalStartUs = esp_timer_get_time();
+  pinConfig.lastValue = 0;
+}
+
+// Broadcast a counter's count and rate
+static void broadcastPulseCounter(const IoPinConfig &pin, int64_t count,
+                                  float frequencyHz) {
+  StaticJsonDocument<192> msg;
+  msg["id"] = pin.id.c_str();
+  msg["value"] = pin.lastValue;
+  msg["type"] = pin.pinType.c_str();
+  msg["mode"] = pin.mode.c_str();
+  msg["count"] = count;
+  msg["frequency"] = frequencyHz;
+
+  String out;
+  serializeJson(msg, out);
+  broadcastTelemetryMessage(out);
+}
+
+// Compile the attached counters into the report table
+static void rebuildCounterTable() {
+  counterTable.clear();
+  uint32_t now = millis();
+  for (size_t i = 0; i < configuredPins.capacity(); i++) {
+    if (!configuredPins.inUse(i)) continue;
+    const IoPinConfig &pin = configuredPins[i];
+    if (pin.pcntUnit < 0) continue;
+    counterTable.add((uint16_t)i, (uint8_t)pin.pcntUnit,
+                     pin.counterReportIntervalMs,
+                     pin.kind == PIN_KIND_FREQUENCY,
+                     now + pin.counterReportIntervalMs);
+  }
+  counterTableDirty = false;
+}
+
+void invalidatePulseCounters() { counterTableDirty = true; }
+
+void updatePulseCounters() {
+  if (counterTableDirty) rebuildCounterTable();
+
+  uint32_t now = millis();
+  for (size_t i = 0; i < counterTable.size(); i++) {
+    if (!deadlineReached(now, counterTable.nextDeadlineMs[i])) continue;
+    counterTable.nextDeadlineMs[i] = now + counterTable.intervalMs[i];
+
+    // Rate over the elapsed interval, timed with the microsecond clock
+    pcnt_unit_t unit = (pcnt_unit_t)counterTable.unit[i];
+    PulseCounterState &state = counterUnits[unit];
+    int64_t total = readUnitTotal(unit);
+    int64_t nowUs = esp_timer_get_time();
+    int64_t elapsedUs = nowUs - state.intervalStartUs;
+    if (elapsedUs > 0) {
+      state.frequencyHz =
+          (float)(total - state.intervalStartCount) * 1e6f / elapsedUs;
+    }
+    state.intervalStartCount = total;
+    state.intervalStartUs = nowUs;
+
+    IoPinConfig &pin = configuredPins[counterTable.pinIndex[i]];
+    int64_t count = total - state.offset;
+    pin.lastValue = counterTable.reportsFrequency[i]
+                        ? (int)lroundf(state.frequencyHz)
+                        : (int)count;
+    broadcastPulseCounter(pin, count, state.frequencyHz);
+  }
+}
@@ -0,0 +1,36 @@
+#ifndef PULSE_COUNTER_H
+#define PULSE_COUNTER_H
+
+#include "../config.h"
+
+// --- Hardware Pulse Counter Inputs ---
+// Pins with pinType "counter" or "frequency" are counted by the PCNT
+// peripheral, so pulse trains far faster than the main loop are counted
+// without CPU involvement. The 16-bit hardware counter is extended to 64 bits
+// by an overflow interrupt. Each pin reports its total count and the rate
+// measured over its report interval; "counter" pins report the count as their
+// value, "frequency" pins the rate in Hz.
+
+// Claim a PCNT unit and start counting; returns false if none is free
+bool attachPulseCounter(IoPinConfig &pinConfig);
+
+// Stop counting and release the PCNT unit (safe for unattached pins)
+void detachPulseCounter(IoPinConfig &pinConfig);
+
+// Reset the pin's accumulated count to zero
+void resetPulseCounter(IoPinConfig &pinConfig);
+
+// Total pulses counted since attach or the last reset
+int64_t getPulseCount(const IoPinConfig &pinConfig);
+
+// Rate measured over the last completed report interval, in Hz
+float getPulseFrequency(const IoPinConfig &pinConfig);
+
+// Mark the report table stale. The table holds configuredPins slot indices,
+// so it must be invalidated whenever a slot is allocated or released.
+void invalidatePulseCounters();
+
+// Report counters whose interval has elapsed (called from the main loop)
+void updatePulseCounters();
+
+#endif  // PULSE_COUNTER_H
@@ -0,0 +1,263 @@
+#include "pulse_output.h"
+
+#include <Arduino.h>
+#include <driver/timer.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+
+#include "../system/trace.h"
+#include "io_pin.h"
+
+// Forward declarations for WebSocket functions
+extern void broadcastWebSocketMessage(const String &message);
+extern void sendWebSocketMessage(uint32_t clientId,
+                                 const String &message);
+
+// Timer group 1 is not used by the core, servos or steppers; one timer per
+// concurrently running pulse
+static const timer_group_t PULSE_TIMER_GROUP = TIMER_GROUP_1;
+static const uint8_t MAX_PULSE_OUTPUTS = 2;
+
+// 80 MHz APB / 80 = 1 us timer ticks
+static const uint32_t PULSE_TIMER_DIVIDER = 80;
+
+// Shorter phases would be dominated by interrupt latency
+static const uint32_t MIN_PULSE_PHASE_US = 10;
+
+struct PulseSlot {
+  // Shared with the alarm ISR
+  volatile bool running = false;
+  volatile bool finished = false;
+  volatile uint32_t edgesRemaining = 0;  // Level changes still to drive
+  bool nextLevelActive = false;
+  bool activeHigh = true;
+  uint8_t gpio = 0;
+  uint32_t widthUs = 0;
+  uint32_t gapUs = 0;  // Inactive time between pulses
+  uint64_t alarmAt = 0;
+
+  // Main loop only
+  bool timerReady = false;
+  uint32_t count = 0;
+  ComponentId pinId;
+  CommandId commandId;
+};
+
+static PulseSlot pulseSlots[MAX_PULSE_OUTPUTS];
+
+// Drive a GPIO through the set/clear registers (ISR safe)
+static inline void IRAM_ATTR drivePulseLevel(const PulseSlot &slot,
+                                             bool active) {
+  bool high = active == slot.activeHigh;
+  if (slot.gpio < 32) {
+    REG_WRITE(high ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG, 1UL << slot.gpio);
+  } else {
+    REG_WRITE(high ? GPIO_OUT1_W1TS_REG : GPIO_OUT1_W1TC_REG,
+              1UL << (slot.gpio - 32));
+  }
+}
+
+// Alarm ISR: drive the next edge and schedule the one after it. Alarms are
+// absolute counter values, so interrupt latency never accumulates; only a
+// handler running more than a phase late pushes the rest of the train back.
+static bool IRAM_ATTR onPulseAlarm(void *arg) {
+  uint8_t index = (uint8_t)(uintptr_t)arg;
+  PulseSlot &slot = pulseSlots[index];
+  if (!slot.running || slot.finished) return false;
+
+  bool active = slot.nextLevelActive;
+  drivePulseLevel(slot, active);
+  if (--slot.edgesRemaining == 0) {
+    slot.finished = true;
+    traceInstant(TRACE_ISR_PULSE_DONE, 0, index);
+    return false;
+  }
+
+  slot.alarmAt += active ? slot.widthUs : slot.gapUs;
+  // An alarm the counter has already passed would only fire after it wraps
+  uint64_t earliest = timer_group_get_counter_value_in_isr(
+                          PULSE_TIMER_GROUP, (timer_idx_t)index) +
+                      MIN_PULSE_PHASE_US;
+  if (slot.alarmAt < earliest) slot.alarmAt = earliest;
+  slot.nextLevelActive = !active;
+  timer_group_set_alarm_value_in_isr(PULSE_TIMER_GROUP, (timer_idx_t)index,
+                                     slot.alarmAt);
+  timer_group_enable_alarm_in_isr(PULSE_TIMER_GROUP, (timer_idx_t)index);
+  return false;
+}
+
+// Configure a slot's hardware timer the first time it is used
+static bool preparePulseTimer(uint8_t index) {
+  PulseSlot &slot = pulseSlots[index];
+  if (slot.timerReady) return true;
+
+  timer_config_t config = {};
+  config.alarm_en = TIMER_ALARM_EN;
+  config.counter_en = TIMER_PAUSE;
+  config.intr_type = TIMER_INTR_LEVEL;
+  config.counter_dir = TIMER_COUNT_UP;
+  config.auto_reload = TIMER_AUTORELOAD_DIS;
+  config.divider = PULSE_TIMER_DIVIDER;
+  if (timer_init(PULSE_TIMER_GROUP, (timer_idx_t)index, &config) != ESP_OK) {
+    return false;
+  }
+  timer_enable_intr(PULSE_TIMER_GROUP, (timer_idx_t)index);
+  if (timer_isr_callback_add(PULSE_TIMER_GROUP, (timer_idx_t)index,
+                             onPulseAlarm, (void *)(uintptr_t)index,
+                             ESP_INTR_FLAG_IRAM) != ESP_OK) {
+    timer_deinit(PULSE_TIMER_GROUP, (timer_idx_t)index);
+    return false;
+  }
+  slot.timerReady = true;
+  return true;
+}
+
+// Send action completion notification
+static void sendPulseActionComplete(const PulseSlot &slot, bool success,
+                                    const String &errorMsg) {
+  if (slot.commandId.isEmpty()) return;  // No pending command to complete
+
+  StaticJsonDocument<256> completionMsg;
+  completionMsg["type"] = "actionComplete";
+  completionMsg["componentId"] = slot.pinId.c_str();
+  completionMsg["componentGroup"] = "pins";
+  completionMsg["commandId"] = slot.commandId.c_str();
+  completionMsg["success"] = success;
+  completionMsg["pulses"] = slot.count;
+  traceInstant(TRACE_COMPLETION, traceCommandId(slot.commandId.c_str()));
+
+  if (!success && !errorMsg.isEmpty()) {
+    completionMsg["error"] = errorMsg;
+  }
+
+  String completionJson;
+  serializeJson(completionMsg, completionJson);
+  broadcastWebSocketMessage(completionJson);
+}
+
+// Stop a slot's timer and release it
+static void releasePulseSlot(uint8_t index) {
+  PulseSlot &slot = pulseSlots[index];
+  timer_pause(PULSE_TIMER_GROUP, (timer_idx_t)index);
+  timer_set_alarm(PULSE_TIMER_GROUP, (timer_idx_t)index, TIMER_ALARM_DIS);
+  slot.running = false;
+  slot.finished = false;
+  slot.commandId = "";
+}
+
+static int8_t findPulseSlot(const ComponentId &pinId) {
+  for (uint8_t i = 0; i < MAX_PULSE_OUTPUTS; i++) {
+    if (pulseSlots[i].running && pulseSlots[i].pinId == pinId) return i;
+  }
+  return -1;
+}
+
+bool cancelPinPulse(const IoPinConfig &pinConfig) {
+  int8_t index = findPulseSlot(pinConfig.id);
+  if (index < 0) return false;
+  PulseSlot &slot = pulseSlots[index];
+  bool completed = slot.finished;
+  timer_pause(PULSE_TIMER_GROUP, (timer_idx_t)index);
+  if (completed) {
+    sendPulseActionComplete(slot, true, "");
+  } else {
+    sendPulseActionComplete(slot, false, F("Pulse interrupted"));
+  }
+  releasePulseSlot(index);
+  return true;
+}
+
+void handlePinPulseRequest(uint32_t clientId, JsonDocument &doc) {
+  String id = doc["id"];
+  IoPinConfig *pin = findPinById(id);
+  if (!pin) {
+    sendWebSocketMessage(clientId, F("ERROR: Pin not found"));
+    return;
+  }
+  if (pin->kind != PIN_KIND_DIGITAL_OUTPUT || pin->pin >= 64) {
+    sendWebSocketMessage(clientId,
+                         F("ERROR: Pulses require a digital output pin"));
+    return;
+  }
+
+  // Widths in microseconds, or milliseconds for convenience
+  uint32_t widthUs = doc["widthUs"] | (uint32_t)(doc["widthMs"] | 0) * 1000;
+  uint32_t periodUs = doc["periodUs"] | (uint32_t)(doc["periodMs"] | 0) * 1000;
+  uint32_t count = doc["count"] | 1;
+  bool activeHigh = !(doc["activeLow"] | false);
+
+  if (widthUs < MIN_PULSE_PHASE_US || count == 0) {
+    sendWebSocketMessage(clientId, F("ERROR: Invalid pulse width or count"));
+    return;
+  }
+  if (count > 1 && periodUs < widthUs + MIN_PULSE_PHASE_US) {
+    sendWebSocketMessage(
+        clientId, F("ERROR: Pulse period must exceed the width for trains"));
+    return;
+  }
+
+  // A new pulse replaces one already running on the same pin
+  cancelPinPulse(*pin);
+
+  int8_t index = -1;
+  for (uint8_t i = 0; i < MAX_PULSE_OUTPUTS; i++) {
+    if (!pulseSlots[i].running) {
+      index = i;
+      break;
+    }
+  }
+  if (index < 0) {
+    sendWebSocketMessage(clientId, F("ERROR: All pulse timers are busy"));
+    return;
+  }
+  if (!preparePulseTimer(index)) {
+    sendWebSocketMessage(clientId, F("ERROR: Could not set up pulse timer"));
+    return;
+  }
+
+  PulseSlot &slot = pulseSlots[index];
+  slot.gpio = pin->pin;
+  slot.activeHigh = activeHigh;
+  slot.widthUs = widthUs;
+  slot.gapUs = count > 1 ? periodUs - widthUs : 0;
+  slot.edgesRemaining = count * 2 - 1;  // Leading edge is driven below
+  slot.nextLevelActive = false;
+  slot.alarmAt = widthUs;
+  slot.count = count;
+  slot.pinId = pin->id;
+  slot.commandId = doc["commandId"] | "";
+  slot.finished = false;
+  slot.running = true;
+
+  timer_set_counter_value(PULSE_TIMER_GROUP, (timer_idx_t)index, 0);
+  timer_set_alarm_value(PULSE_TIMER_GROUP, (timer_idx_t)index, slot.alarmAt);
+  timer_set_alarm(PULSE_TIMER_GROUP, (timer_idx_t)index, TIMER_ALARM_EN);
+  drivePulseLevel(slot, true);
+  timer_start(PULSE_TIMER_GROUP, (timer_idx_t)index);
+  traceInstant(TRACE_MOTION_START, traceCommandId(slot.commandId.c_str()));
+
+  StaticJsonDocument<192> response;
+  response["status"] = F("OK");
+  response["message"] = F("Pulse started");
+  response["id"] = pin->id.c_str();
+  response["widthUs"] = widthUs;
+  response["count"] = count;
+  String jsonResponse;
+  serializeJson(response, jsonResponse);
+  sendWebSocketMessage(clientId, jsonResponse);
+}
+
+void updatePinPulses() {
+  for (uint8_t i = 0; i < MAX_PULSE_OUTPUTS; i++) {
+    PulseSlot &slot = pulseSlots[i];
+    if (!slot.running || !slot.finished) continue;
+
+    IoPinConfig *pin = findPinById(slot.pinId);
+    if (pin) {
+      pin->lastValue = slot.activeHigh ? LOW : HIGH;
+      broadcastPinValue(*pin);
+    }
+    sendPulseActionComplete(slot, true, "");
+    releasePulseSlot(i);
+  }
+}
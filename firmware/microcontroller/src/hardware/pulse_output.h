@@ -0,0 +1,25 @@
+#ifndef PULSE_OUTPUT_H
+#define PULSE_OUTPUT_H
+
+#include <ArduinoJson.h>
+
+#include "../config.h"
+
+// --- Timed Pulses on Digital Outputs ---
+// One-shot pulses and pulse trains with microsecond-exact timing. Each
+// running pulse owns a general-purpose hardware timer whose alarm ISR drives
+// the GPIO through the W1TS/W1TC registers, so width and period do not depend
+// on the main loop or the network. Completion is reported with the same
+// "actionComplete" message used by steppers and servos.
+
+// Handle a pins "pulse" request (starts the pulse and replies)
+void handlePinPulseRequest(uint32_t clientId, JsonDocument &doc);
+
+// Stop a running pulse on this pin without changing its level (the caller is
+// about to drive it). Returns false if the pin was not pulsing.
+bool cancelPinPulse(const IoPinConfig &pinConfig);
+
+// Report finished pulses (called from the main loop)
+void updatePinPulses();
+
+#endif  // PULSE_OUTPUT_H
@@ -0,0 +1,208 @@
+#include "pwm_output.h"
+
+#include <Arduino.h>
+
+#include "../hal/hal_ledc.h"
+#include "../system/trace.h"
+#include "io_pin.h"
+
+// Forward declarations for WebSocket functions
+extern void broadcastWebSocketMessage(const String &message);
+extern void sendWebSocketMessage(uint32_t clientId,
+                                 const String &message);
+
+struct PwmFadeState {
+  volatile bool active = false;
+  volatile bool done = false;  // Set by the fade-end interrupt
+  bool releasePending = false;  // Pin was removed while fading
+  uint32_t targetDuty = 0;
+  ComponentId pinId;
+  CommandId commandId;
+};
+
+static PwmFadeState fades[MAX_SERVO_CHANNELS];
+
+// Fade-end interrupt: hand completion to the main loop
+static void IRAM_ATTR onFadeEnd(uint8_t channel) {
+  if (fades[channel].active) {
+    fades[channel].done = true;
+    traceInstant(TRACE_ISR_FADE_DONE, 0, channel);
+  }
+}
+
+// Largest duty a client can request for the pin's resolution. Like
+// ledcWrite(), a full-scale fade is sent to the hardware as 2^bits so the
+// output ends fully on.
+static uint32_t pwmFullScaleDuty(const IoPinConfig &pinConfig) {
+  return (1UL << pinConfig.pwmResolution) - 1;
+}
+
+bool setupPwmPin(IoPinConfig &pinConfig) {
+  int channel = allocatePwmChannelPair();
+  if (channel < 0) {
+    Serial.printf("ERROR: No LEDC channel for PWM pin %s\n",
+                  pinConfig.id.c_str());
+    return false;
+  }
+
+  if (halLedcSetup(channel, pinConfig.pwmFrequency, pinConfig.pwmResolution) ==
+      0) {
+    // The LEDC clock cannot produce this frequency at this resolution
+    Serial.printf("ERROR: PWM pin %s cannot run at %u Hz with %u bits\n",
+                  pinConfig.id.c_str(), pinConfig.pwmFrequency,
+                  pinConfig.pwmResolution);
+    releasePwmChannelPair(channel);
+    return false;
+  }
+  halLedcAttachPin(pinConfig.pin, channel);
+  halLedcWrite(channel, 0);
+
+  pinConfig.pwmChannel = channel;
+  pinConfig.lastValue = 0;
+  return true;
+}
+
+void releasePwmPin(IoPinConfig &pinConfig) {
+  int channel = pinConfig.pwmChannel;
+  if (channel < 0) return;
+
+  halLedcDetachPin(pinConfig.pin);
+  pinConfig.pwmChannel = -1;
+
+  // The driver holds the channel until the fade ends; release it then
+  PwmFadeState &fade = fades[channel];
+  if (fade.active) {
+    fade.releasePending = true;
+    return;
+  }
+  releasePwmChannelPair(channel);
+}
+
+bool isPwmFading(const IoPinConfig &pinConfig) {
+  return pinConfig.pwmChannel >= 0 && fades[pinConfig.pwmChannel].active;
+}
+
+bool writePwmDuty(IoPinConfig &pinConfig, uint32_t duty) {
+  if (pinConfig.pwmChannel < 0 || isPwmFading(pinConfig)) return false;
+  duty = min(duty, pwmFullScaleDuty(pinConfig));
+  halLedcWrite(pinConfig.pwmChannel, duty);
+  pinConfig.lastValue = duty;
+  return true;
+}
+
+// Send action completion notification
+static void sendFadeActionComplete(const PwmFadeState &fade, bool success,
+                                   const String &errorMsg) {
+  if (fade.commandId.isEmpty()) return;  // No pending command to complete
+
+  StaticJsonDocument<256> completionMsg;
+  completionMsg["type"] = "actionComplete";
+  completionMsg["componentId"] = fade.pinId.c_str();
+  completionMsg["componentGroup"] = "pins";
+  completionMsg["commandId"] = fade.commandId.c_str();
+  completionMsg["success"] = success;
+  completionMsg["value"] = fade.targetDuty;
+  traceInstant(TRACE_COMPLETION, traceCommandId(fade.commandId.c_str()));
+
+  if (!success && !errorMsg.isEmpty()) {
+    completionMsg["error"] = errorMsg;
+  }
+
+  String completionJson;
+  serializeJson(completionMsg, completionJson);
+  broadcastWebSocketMessage(completionJson);
+}
+
+void handlePinFadeRequest(uint32_t clientId, JsonDocument &doc) {
+  String id = doc["id"];
+  IoPinConfig *pin = findPinById(id);
+  if (!pin) {
+    sendWebSocketMessage(clientId, F("ERROR: Pin not found"));
+    return;
+  }
+  if (pin->kind != PIN_KIND_PWM_OUTPUT || pin->pwmChannel < 0) {
+    sendWebSocketMessage(clientId, F("ERROR: Pin is not an active PWM output"));
+    return;
+  }
+  if (isPwmFading(*pin)) {
+    sendWebSocketMessage(clientId, F("ERROR: A fade is already running"));
+    return;
+  }
+  if (!doc.containsKey("duty")) {
+    sendWebSocketMessage(clientId, F("ERROR: Missing 'duty' for fade"));
+    return;
+  }
+
+  uint32_t duty = min(doc["duty"].as<uint32_t>(), pwmFullScaleDuty(*pin));
+  uint32_t durationMs = doc["durationMs"] | 1000;
+
+  int channel = pin->pwmChannel;
+  PwmFadeState &fade = fades[channel];
+  fade.targetDuty = duty;
+  fade.pinId = pin->id;
+  fade.commandId = doc["commandId"] | "";
+  fade.done = false;
+  fade.releasePending = false;
+  fade.active = true;
+
+  uint32_t hardwareDuty = duty == pwmFullScaleDuty(*pin) ? duty + 1 : duty;
+  if (!halLedcFadeStart(channel, hardwareDuty, durationMs, onFadeEnd)) {
+    fade.active = false;
+    sendWebSocketMessage(clientId, F("ERROR: Could not start fade"));
+    return;
+  }
+  traceInstant(TRACE_MOTION_START, traceCommandId(fade.commandId.c_str()));
+
+  StaticJsonDocument<192> response;
+  response["status"] = F("OK");
+  response["message"] = F("Fade started");
+  response["id"] = pin->id.c_str();
+  response["duty"] = duty;
+  response["durationMs"] = durationMs;
+  String jsonResponse;
+  serializeJson(response, jsonResponse);
+  sendWebSocketMessage(clientId, jsonResponse);
+}
+
+bool cancelPwmFade(IoPinConfig &pinConfig, const String &reason) {
+  if (!isPwmFading(pinConfig)) return false;
+  int channel = pinConfig.pwmChannel;
+  PwmFadeState &fade = fades[channel];
+
+  // The fade-end interrupt ignores inactive channels, so done cannot change
+  // after this
+  fade.active = false;
+  bool completed = fade.done;
+  fade.done = false;
+  halLedcFadeStop(channel);
+
+  pinConfig.lastValue =
+      min(halLedcGetDuty(channel), pwmFullScaleDuty(pinConfig));
+  broadcastPinValue(pinConfig);
+  sendFadeActionComplete(fade, completed, completed ? String() : reason);
+  fade.commandId = "";
+  return true;
+}
+
+void updatePwmFades() {
+  for (int channel = 0; channel < MAX_SERVO_CHANNELS; channel++) {
+    PwmFadeState &fade = fades[channel];
+    if (!fade.active || !fade.done) continue;
+    fade.active = false;
+    fade.done = false;
+
+    if (fade.releasePending) {
+      fade.releasePending = false;
+      releasePwmChannelPair(channel);
+      sendFadeActionComplete(fade, false, F("Pin removed during fade"));
+    } else {
+      IoPinConfig *pin = findPinById(fade.pinId);
+      if (pin) {
+        pin->lastValue = fade.targetDuty;
+        broadcastPinValue(*pin);
+      }
+      sendFadeActionComplete(fade, true, "");
+    }
+    fade.commandId = "";
+  }
+}
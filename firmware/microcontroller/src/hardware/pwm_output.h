@@ -0,0 +1,37 @@
+#ifndef PWM_OUTPUT_H
+#define PWM_OUTPUT_H
+
+#include <ArduinoJson.h>
+
+#include "../config.h"
+
+// --- PWM Outputs ---
+// PWM pins get their own LEDC timer (a channel pair) so each pin can run at
+// its configured frequency and resolution without disturbing servos. Fades
+// run on the LEDC hardware fade engine; completion comes back through the
+// fade-end interrupt and is reported as an "actionComplete" message.
+
+// Allocate an LEDC channel pair and start the pin at 0% duty
+bool setupPwmPin(IoPinConfig &pinConfig);
+
+// Detach the pin and release its channels (deferred while a fade runs)
+void releasePwmPin(IoPinConfig &pinConfig);
+
+// Set the duty immediately. Fails while a fade is running on the pin.
+bool writePwmDuty(IoPinConfig &pinConfig, uint32_t duty);
+
+// True while a hardware fade is running on the pin
+bool isPwmFading(const IoPinConfig &pinConfig);
+
+// Handle a pins "fade" request (starts the fade and replies)
+void handlePinFadeRequest(uint32_t clientId, JsonDocument &doc);
+
+// Report finished fades (called from the main loop)
+void updatePwmFades();
+
+// Stop a running fade where it is; its action completes as failed with
+// reason (or succeeds if it had just finished). Returns false if the pin was
+// not fading.
+bool cancelPwmFade(IoPinConfig &pinConfig, const String &reason);
+
+#endif  // PWM_OUTPUT_H
@@ -3,11 +3,10 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
-// Forward declaration for WebSocket instance
-extern AsyncWebSocket ws;
+#include "../system/trace.h"
 
 // Forward declaration for WebSocket message sending functions
-extern void sendWebSocketMessage(AsyncWebSocketClient *client,
+extern void sendWebSocketMessage(uint32_t clientId,
                                  const String &message);
 extern void broadcastWebSocketMessage(const String &message);
 
@@ -122,12 +121,39 @@ bool moveServo(ServoConfig &servoConfig, int angle) {
 
   // Mark as pending for action completion tracking
   servoConfig.isActionPending = true;
+  traceInstant(TRACE_MOTION_START,
+               traceCommandId(servoConfig.pendingCommandId.c_str()));
 
   return true;
 }
 
+// The servo reports no position, so the angle reached is interpolated from
+// the move's elapsed share of its expected duration
+bool stopServo(ServoConfig &servoConfig) {
+  if (!servoConfig.isActionPending) return false;
+
+  int angle = servoConfig.previousAngle;  // Not yet timed: barely started
+  if (servoConfig.moveStartTime != 0 && servoConfig.moveDuration > 0) {
+    unsigned long elapsed = millis() - servoConfig.moveStartTime;
+    float fraction =
+        min(1.0f, (float)elapsed / (float)servoConfig.moveDuration);
+    angle = servoConfig.previousAngle +
+            (int)((servoConfig.targetAngle - servoConfig.previousAngle) *
+                  fraction);
+  }
+  if (servoConfig.servo.attached()) servoConfig.servo.write(angle);
+
+  servoConfig.currentAngle = angle;
+  servoConfig.targetAngle = angle;
+  servoConfig.previousAngle = angle;
+  servoConfig.moveStartTime = 0;
+  servoConfig.moveDuration = 0;
+  servoConfig.isActionPending = false;
+  return true;
+}
+
 // Send error message for when a servo is not found
-void sendServoNotFoundError(AsyncWebSocketClient *client, const String &id) {
+void sendServoNotFoundError(uint32_t clientId, const String &id) {
   StaticJsonDocument<128> response;
   response["status"] = F("ERROR");
   response["message"] = F("Servo not found");
@@ -136,7 +162,7 @@ void sendServoNotFoundError(AsyncWebSocketClient *client, const String &id) {
 
   String jsonResponse;
   serializeJson(response, jsonResponse);
-  sendWebSocketMessage(client, jsonResponse);
+  sendWebSocketMessage(clientId, jsonResponse);
 }
 
 // Send action completion notification
@@ -147,11 +173,13 @@ void sendServoActionComplete(const ServoConfig &config, bool success,
 
   StaticJsonDocument<256> completionMsg;
   completionMsg["type"] = "actionComplete";
-  completionMsg["componentId"] = config.id;
+  completionMsg["componentId"] = config.id.c_str();
   completionMsg["componentGroup"] = "servos";
-  completionMsg["commandId"] = config.pendingCommandId;
+  completionMsg["commandId"] = config.pendingCommandId.c_str();
   completionMsg["success"] = success;
   completionMsg["angle"] = config.currentAngle;
+  traceInstant(TRACE_COMPLETION,
+               traceCommandId(config.pendingCommandId.c_str()));
 
   if (!success && !errorMsg.isEmpty()) {
     completionMsg["error"] = errorMsg;
@@ -207,6 +235,7 @@ void updateServoActionStatus() {
 
         // Mark as completed
         servo.isActionPending = false;
+        servo.movesCompleted++;
 
         // If we have a pending command ID, send completion notification
         if (!servo.pendingCommandId.isEmpty()) {
@@ -220,7 +249,7 @@ void updateServoActionStatus() {
 }
 
 // Handle servo-related WebSocket messages
-void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
+void handleServoMessage(uint32_t clientId, JsonDocument &doc) {
   const char *action = doc["action"];
   String id = doc["id"];  // Common for most servo actions
 
@@ -241,7 +270,7 @@ void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
       channel = config["channel"];
       // Validate channel range
       if (channel < 0 || channel >= MAX_SERVO_CHANNELS) {
-        sendWebSocketMessage(client,
+        sendWebSocketMessage(clientId,
                              F("ERROR: Invalid servo channel (must be 0-15)"));
         return;
       }
@@ -257,7 +286,7 @@ void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
 
         if (!usedBySelf) {
           sendWebSocketMessage(
-              client,
+              clientId,
               F("ERROR: Servo channel already in use by another servo"));
           return;
         }
@@ -271,7 +300,11 @@ void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
 
     if (cfg_id.isEmpty() || name.isEmpty() || pin == 0) {
       sendWebSocketMessage(
-          client, F("ERROR: Missing servo config fields (id, name, pin)"));
+          clientId, F("ERROR: Missing servo config fields (id, name, pin)"));
+      return;
+    }
+    if (!ComponentId::fits(cfg_id)) {
+      sendWebSocketMessage(clientId, F("ERROR: Servo id too long"));
       return;
     }
 
@@ -315,30 +348,34 @@ void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
     } else {
       Serial.printf("DEBUG CONFIG: Creating new servo %s on pin %d\n",
                     cfg_id.c_str(), pin);
-      ServoConfig newServo;
-      newServo.id = cfg_id;
-      newServo.name = name;
-      newServo.pin = pin;
-      newServo.minAngle = minAngle;
-      newServo.maxAngle = maxAngle;
-      newServo.minPulseWidth = minPulseWidth;
-      newServo.maxPulseWidth = maxPulseWidth;
-      newServo.currentAngle = initialAngle;
+      ServoConfig *newServo = configuredServos.allocate();
+      if (!newServo) {
+        sendWebSocketMessage(clientId, F("ERROR: No free servo slots"));
+        return;
+      }
+      newServo->id = cfg_id;
+      newServo->name = name;
+      newServo->pin = pin;
+      newServo->minAngle = minAngle;
+      newServo->maxAngle = maxAngle;
+      newServo->minPulseWidth = minPulseWidth;
+      newServo->maxPulseWidth = maxPulseWidth;
+      newServo->currentAngle = initialAngle;
 
       // Set channel if specified, otherwise it will be allocated in
       // initializeServo
       if (channel >= 0) {
-        newServo.channel = channel;
+        newServo->channel = channel;
         servoChannelUsed[channel] = true;
       }
 
       // Initialize the servo
-      initializeServo(newServo);
-      configuredServos.push_back(newServo);
+      initializeServo(*newServo);
+      existingServo = newServo;
 
       Serial.printf(
-          "DEBUG CONFIG: After adding, now have %d servos configured\n",
-          configuredServos.size());
+          "DEBUG CONFIG: After adding, now have %u servos configured\n",
+          (unsigned)configuredServos.size());
     }
 
     // Send success response
@@ -347,24 +384,23 @@ void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
     response["message"] = F("Servo configured");
     response["id"] = cfg_id;
     response["componentGroup"] = F("servos");
-    response["channel"] = existingServo ? existingServo->channel
-                                        : configuredServos.back().channel;
+    response["channel"] = existingServo->channel;
     String jsonResponse;
     serializeJson(response, jsonResponse);
-    sendWebSocketMessage(client, jsonResponse);
+    sendWebSocketMessage(clientId, jsonResponse);
 
   } else if (strcmp(action, "control") == 0) {
     // New control action for servos (similar to stepper control)
     const char *command = doc["command"];
     if (!command) {
-      sendWebSocketMessage(client,
+      sendWebSocketMessage(clientId,
                            F("ERROR: Missing 'command' for servo control"));
       return;
     }
 
     ServoConfig *servo = findServoById(id);
     if (!servo) {
-      sendServoNotFoundError(client, id);
+      sendServoNotFoundError(clientId, id);
       return;
     }
 
@@ -373,7 +409,7 @@ void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
 
       if (angle < 0) {
         sendWebSocketMessage(
-            client, F("ERROR: Missing or invalid 'angle' for servo move"));
+            clientId, F("ERROR: Missing or invalid 'angle' for servo move"));
         return;
       }
 
@@ -396,16 +432,16 @@ void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
         char buffer[100];
         snprintf(buffer, sizeof(buffer), "OK: Servo %s moving to angle %d",
                  id.c_str(), angle);
-        sendWebSocketMessage(client, buffer);
+        sendWebSocketMessage(clientId, buffer);
       } else {
         String errorMsg = String(F("ERROR: Failed to move servo ")) + id +
                           F(" to angle ") + String(angle);
-        sendWebSocketMessage(client, errorMsg);
+        sendWebSocketMessage(clientId, errorMsg);
       }
     } else if (strcmp(command, "detach") == 0) {
       cleanupServo(*servo);
       String response = String(F("OK: Servo ")) + id + F(" detached");
-      sendWebSocketMessage(client, response);
+      sendWebSocketMessage(clientId, response);
     } else if (strcmp(command, "setParams") == 0) {
       if (doc.containsKey("minAngle")) {
         servo->minAngle = doc["minAngle"].as<int>();
@@ -421,9 +457,9 @@ void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
       }
 
       String response = String(F("OK: Servo parameters updated for ")) + id;
-      sendWebSocketMessage(client, response);
+      sendWebSocketMessage(clientId, response);
     } else {
-      sendWebSocketMessage(client, F("ERROR: Unknown servo command"));
+      sendWebSocketMessage(clientId, F("ERROR: Unknown servo command"));
     }
   } else if (strcmp(action, "moveServo") == 0) {
     // Legacy action for backward compatibility
@@ -431,13 +467,13 @@ void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
 
     if (angle < 0) {
       sendWebSocketMessage(
-          client, F("ERROR: Missing or invalid 'angle' for servo move"));
+          clientId, F("ERROR: Missing or invalid 'angle' for servo move"));
       return;
     }
 
     ServoConfig *servo = findServoById(id);
     if (!servo) {
-      sendServoNotFoundError(client, id);
+      sendServoNotFoundError(clientId, id);
       return;
     }
 
@@ -451,40 +487,39 @@ void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
       char buffer[100];
       snprintf(buffer, sizeof(buffer), "OK: Servo %s moving to angle %d",
                id.c_str(), angle);
-      sendWebSocketMessage(client, buffer);
+      sendWebSocketMessage(clientId, buffer);
     } else {
       String errorMsg = String(F("ERROR: Failed to move servo ")) + id +
                         F(" to angle ") + String(angle);
-      sendWebSocketMessage(client, errorMsg);
+      sendWebSocketMessage(clientId, errorMsg);
     }
 
   } else if (strcmp(action, "detachServo") == 0) {
     // Legacy action for backward compatibility
     ServoConfig *servo = findServoById(id);
     if (!servo) {
-      sendServoNotFoundError(client, id);
+      sendServoNotFoundError(clientId, id);
       return;
     }
 
     cleanupServo(*servo);
     String response = String(F("OK: Servo ")) + id + F(" detached");
-    sendWebSocketMessage(client, response);
+    sendWebSocketMessage(clientId, response);
 
   } else if (strcmp(action, "remove") == 0) {
-    auto it = std::remove_if(configuredServos.begin(), configuredServos.end(),
-                             [&](const ServoConfig &s) { return s.id == id; });
+    ServoConfig *servo = findServoById(id);
 
-    if (it != configuredServos.end()) {
-      cleanupServo(*it);  // Clean up before erasing
-      configuredServos.erase(it, configuredServos.end());
+    if (servo) {
+      cleanupServo(*servo);  // Clean up before releasing the slot
+      configuredServos.release(servo);
       String response = String(F("OK: Servo removed: ")) + id;
-      sendWebSocketMessage(client, response);
+      sendWebSocketMessage(clientId, response);
     } else {
       String response = String(F("ERROR: Servo not found for removal: ")) + id;
-      sendWebSocketMessage(client, response);
+      sendWebSocketMessage(clientId, response);
     }
 
   } else {
-    sendWebSocketMessage(client, F("ERROR: Unknown servo action"));
+    sendWebSocketMessage(clientId, F("ERROR: Unknown servo action"));
   }
 }
\ No newline at end of file
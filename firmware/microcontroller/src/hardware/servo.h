@@ -2,7 +2,6 @@
 #define SERVO_H
 
 #include <ArduinoJson.h>
-#include <AsyncWebSocket.h>
 
 #include "../config.h"
 
@@ -20,13 +19,17 @@ bool isValidAngle(ServoConfig &servoConfig, int angle);
 // Move servo to a specified angle
 bool moveServo(ServoConfig &servoConfig, int angle);
 
+// Hold a moving servo at its estimated position. Returns false if no move
+// was pending; the caller completes the pending action.
+bool stopServo(ServoConfig &servoConfig);
+
 // --- WebSocket Communication ---
 
 // Send error message for when a servo is not found
-void sendServoNotFoundError(AsyncWebSocketClient *client, const String &id);
+void sendServoNotFoundError(uint32_t clientId, const String &id);
 
 // Handle servo-related WebSocket messages
-void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc);
+void handleServoMessage(uint32_t clientId, JsonDocument &doc);
 
 // Send action completion notification
 void sendServoActionComplete(const ServoConfig &config, bool success,
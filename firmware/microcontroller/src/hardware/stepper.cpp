@@ -4,15 +4,15 @@
 #include <ArduinoJson.h>
 
 #include "../config.h"  // For StepperConfig, IoPinConfig and findPinById
+#include "../hal/hal_gpio.h"
 #include "io_pin.h"     // For IoPinConfig and findPinById
-
-// Forward declaration for WebSocket instance
-extern AsyncWebSocket ws;
+#include "../system/trace.h"
 
 // Forward declaration for WebSocket message sending functions
-extern void sendWebSocketMessage(AsyncWebSocketClient* client,
+extern void sendWebSocketMessage(uint32_t clientId,
                                  const String& message);
 extern void broadcastWebSocketMessage(const String& message);
+extern void broadcastTelemetryMessage(const String& message);
 
 // --- Stepper Motor Operations ---
 
@@ -23,11 +23,8 @@ bool initializeStepper(StepperConfig& config) {
     cleanupStepper(config);  // Clean up existing instance
   }
 
-  // Get the global FastAccelStepperEngine instance
-  extern FastAccelStepperEngine engine;
-
-  // Create the stepper instance
-  config.stepper = engine.stepperConnectToPin(config.pulPin);
+  // Connect the pulse backend to the step pin
+  config.stepper = halStepperConnect(config.pulPin);
   if (config.stepper == nullptr) {
     Serial.printf("ERROR: Failed to create stepper on pin %d\n", config.pulPin);
     return false;
@@ -49,6 +46,7 @@ bool initializeStepper(StepperConfig& config) {
   // Initialize other properties
   config.currentPosition = config.stepper->getCurrentPosition();
   config.targetPosition = config.currentPosition;
+  config.stepSamplePosition = config.currentPosition;
   config.isActionPending = false;
   config.isHoming = false;
   config.pendingCommandId = "";
@@ -96,6 +94,8 @@ bool moveStepperToPosition(StepperConfig& config, long position) {
   config.stepper->moveTo(targetPos);
   config.targetPosition = targetPos;
   config.isActionPending = true;
+  traceInstant(TRACE_MOTION_START,
+               traceCommandId(config.pendingCommandId.c_str()));
 
   Serial.printf("Stepper '%s' moving to position %ld\n", config.name.c_str(),
                 targetPos);
@@ -151,6 +151,8 @@ bool moveStepperRelative(StepperConfig& config, long steps) {
 
   config.targetPosition = newPos;
   config.isActionPending = true;
+  traceInstant(TRACE_MOTION_START,
+               traceCommandId(config.pendingCommandId.c_str()));
 
   return true;
 }
@@ -174,6 +176,7 @@ bool setStepperCurrentPosition(StepperConfig& config, long position) {
   config.stepper->setCurrentPosition(position);
   config.currentPosition = position;
   config.targetPosition = position;
+  config.stepSamplePosition = position;
   config.isActionPending = false;
 
   Serial.printf("Stepper '%s' current position set to %ld\n",
@@ -220,6 +223,8 @@ bool homeStepperWithSensor(StepperConfig& config) {
   config.stepper->moveTo(targetPos);
   config.isHoming = true;
   config.isActionPending = true;
+  traceInstant(TRACE_MOTION_START,
+               traceCommandId(config.pendingCommandId.c_str()));
 
   Serial.printf("Stepper '%s' homing in direction %d at speed %.2f steps/sec\n",
                 config.name.c_str(), config.homingDirection, homingSpeed);
@@ -238,7 +243,7 @@ long clampPosition(StepperConfig* stepper, long position) {
 // --- WebSocket Communication ---
 
 // Send JSON error message for when a stepper is not found
-void sendStepperNotFoundError(AsyncWebSocketClient* client, const String& id) {
+void sendStepperNotFoundError(uint32_t clientId, const String& id) {
   StaticJsonDocument<128> response;
   response["status"] = F("ERROR");
   response["message"] = F("Stepper not found or not initialized");
@@ -247,19 +252,19 @@ void sendStepperNotFoundError(AsyncWebSocketClient* client, const String& id) {
 
   String jsonResponse;
   serializeJson(response, jsonResponse);
-  sendWebSocketMessage(client, jsonResponse);
+  sendWebSocketMessage(clientId, jsonResponse);
 }
 
 // Send position update for a stepper
 void sendStepperPositionUpdate(const StepperConfig& config) {
   StaticJsonDocument<128> updateDoc;
-  updateDoc["id"] = config.id;
+  updateDoc["id"] = config.id.c_str();
   updateDoc["position"] = config.currentPosition;
   updateDoc["componentGroup"] = F("steppers");
 
   String output;
   serializeJson(updateDoc, output);
-  broadcastWebSocketMessage(output);
+  broadcastTelemetryMessage(output);
 }
 
 // Send action completion notification
@@ -270,11 +275,13 @@ void sendStepperActionComplete(const StepperConfig& config, bool success,
 
   StaticJsonDocument<256> completionMsg;
   completionMsg["type"] = "actionComplete";
-  completionMsg["componentId"] = config.id;
+  completionMsg["componentId"] = config.id.c_str();
   completionMsg["componentGroup"] = "steppers";
-  completionMsg["commandId"] = config.pendingCommandId;
+  completionMsg["commandId"] = config.pendingCommandId.c_str();
   completionMsg["success"] = success;
   completionMsg["position"] = config.currentPosition;
+  traceInstant(TRACE_COMPLETION,
+               traceCommandId(config.pendingCommandId.c_str()));
 
   if (!success && !errorMsg.isEmpty()) {
     completionMsg["error"] = errorMsg;
@@ -291,15 +298,19 @@ void sendStepperActionComplete(const StepperConfig& config, bool success,
 
 // --- Periodic Updates ---
 
-// Update and report stepper positions
-void updateStepperPositions() {
-  unsigned long now = millis();
-
+// Enforce position limits and check home sensors
+void updateStepperLimits() {
   for (auto& stepperConfig : configuredSteppers) {
     if (stepperConfig.stepper) {
       // Get current position
       long currentPos = stepperConfig.stepper->getCurrentPosition();
 
+      // Count steps since the last sample. Sampling at the limits rate, a
+      // direction reversal between two samples is the only thing missed.
+      stepperConfig.stepsGenerated +=
+          labs(currentPos - stepperConfig.stepSamplePosition);
+      stepperConfig.stepSamplePosition = currentPos;
+
       // Enforce limits - if the stepper somehow went outside its limits, stop
       // it
       if (!stepperConfig.isHoming && (currentPos < stepperConfig.minPosition ||
@@ -320,6 +331,7 @@ void updateStepperPositions() {
 
         stepperConfig.stepper->setCurrentPosition(correctedPos);
         currentPos = correctedPos;
+        stepperConfig.stepSamplePosition = correctedPos;
         stepperConfig.currentPosition = correctedPos;
         stepperConfig.targetPosition = correctedPos;
 
@@ -332,7 +344,7 @@ void updateStepperPositions() {
         IoPinConfig* sensorPin = findPinById(stepperConfig.homeSensorId);
         if (sensorPin && sensorPin->mode == "input") {
           int sensorValue =
-              digitalRead(sensorPin->pin);  // Direct read for responsiveness
+              halDigitalRead(sensorPin->pin);  // Direct read for responsiveness
 
           // Check if sensor is triggered (matches the active state)
           if (sensorValue == stepperConfig.homeSensorPinActiveState) {
@@ -346,9 +358,11 @@ void updateStepperPositions() {
                 stepperConfig.homePositionOffset);
             stepperConfig.currentPosition = stepperConfig.homePositionOffset;
             stepperConfig.targetPosition = stepperConfig.homePositionOffset;
+            stepperConfig.stepSamplePosition = stepperConfig.homePositionOffset;
             stepperConfig.isHoming = false;
             stepperConfig.isActionPending = false;
             stepperConfig.isHomed = true;
+            stepperConfig.movesCompleted++;
 
             // Restore normal operational speed and acceleration
             stepperConfig.stepper->setSpeedInHz(stepperConfig.maxSpeed);
@@ -373,11 +387,25 @@ void updateStepperPositions() {
           stepperConfig.pendingCommandId = "";
         }
       }
-      // Handle normal move completion
-      else if (stepperConfig.isActionPending) {
+    }
+  }
+}
+
+// Report stepper positions and check for completion of moves
+void updateStepperPositions() {
+  unsigned long now = millis();
+
+  for (auto& stepperConfig : configuredSteppers) {
+    if (stepperConfig.stepper) {
+      long currentPos = stepperConfig.stepper->getCurrentPosition();
+
+      // Handle normal move completion (homing completes in
+      // updateStepperLimits)
+      if (!stepperConfig.isHoming && stepperConfig.isActionPending) {
         // Check if stepper has stopped moving
         if (!stepperConfig.stepper->isRunning()) {
           stepperConfig.isActionPending = false;
+          stepperConfig.movesCompleted++;
           stepperConfig.currentPosition = currentPos;
 
           // Send completion notification if we have a command ID
@@ -399,4 +427,408 @@ void updateStepperPositions() {
       }
     }
   }
-}
\ No newline at end of file
+}
+
+// --- WebSocket Message Handling ---
+
+// Handle stepper-related WebSocket messages
+void handleStepperMessage(uint32_t clientId, JsonDocument &doc) {
+  const char *action = doc["action"];
+  String id = doc["id"];  // Common for most stepper actions
+
+  // Handle configuration action separately since it might create a new stepper
+  if (strcmp(action, "configure") == 0) {
+    JsonObject config = doc["config"];
+    String cfg_id = config["id"];
+    String name = config["name"];
+    uint8_t pulPin = config["pulPin"];
+    uint8_t dirPin = config["dirPin"];
+    uint8_t enaPin = config["enaPin"] | 0;
+    long minPosition = config["minPosition"] | -50000;
+    long maxPosition = config["maxPosition"] | 50000;
+    float stepsPerInch = config["stepsPerInch"] | 200.0;
+    float maxSpeed = config["maxSpeed"] |
+                     50000.0;  // Default to 50k steps/sec if not specified
+    float acceleration = config["acceleration"] |
+                         50000.0;  // Default to 50k steps/sec² if not specified
+
+    // Optional homing parameters
+    String homeSensorId = config["homeSensorId"] | "";
+    int homingDirection = config["homingDirection"] | 1;
+    float homingSpeed = config["homingSpeed"] | 500.0;
+    int homeSensorPinActiveState = config["homeSensorPinActiveState"] | 0;
+    long homePositionOffset = config["homePositionOffset"] | 0;
+
+    if (cfg_id.isEmpty() || name.isEmpty() || pulPin == 0 || dirPin == 0) {
+      sendWebSocketMessage(
+          clientId,
+          F("ERROR: Missing stepper config fields (id, name, pulPin, dirPin)"));
+      return;
+    }
+    if (!ComponentId::fits(cfg_id) || !ComponentId::fits(homeSensorId)) {
+      sendWebSocketMessage(clientId, F("ERROR: Stepper or sensor id too long"));
+      return;
+    }
+
+    // Serial.printf("Configuring stepper '%s' (ID: %s):\n", name.c_str(),
+    //               cfg_id.c_str());
+    // Serial.printf("  - Pins: PUL=%d, DIR=%d, ENA=%d\n", pulPin, dirPin,
+    // enaPin); Serial.printf("  - Speed: %.2f steps/sec\n", maxSpeed);
+    // Serial.printf("  - Acceleration: %.2f steps/sec²\n", acceleration);
+    // Serial.printf("  - Position Range: %ld to %ld steps\n", minPosition,
+    //               maxPosition);
+    // Serial.printf("  - Steps per inch: %.2f\n", stepsPerInch);
+
+    StepperConfig *existingStepper = findStepperById(cfg_id);
+
+    if (existingStepper) {
+      Serial.printf("Updating stepper ID %s (%s)\n", cfg_id.c_str(),
+                    name.c_str());
+
+      // Store current values before updating
+      float currentSpeed = existingStepper->maxSpeed;
+      float currentAcceleration = existingStepper->acceleration;
+
+      // Update basic properties
+      existingStepper->name = name;
+      existingStepper->minPosition = minPosition;
+      existingStepper->maxPosition = maxPosition;
+      existingStepper->stepsPerInch = stepsPerInch;
+
+      // Update speed and acceleration, preserving existing values if not
+      // specified
+      existingStepper->maxSpeed =
+          config.containsKey("maxSpeed") ? maxSpeed : currentSpeed;
+      existingStepper->acceleration = config.containsKey("acceleration")
+                                          ? acceleration
+                                          : currentAcceleration;
+
+      // Update homing properties
+      existingStepper->homeSensorId = homeSensorId;
+      existingStepper->homingDirection = homingDirection;
+      existingStepper->homingSpeed = homingSpeed;
+      existingStepper->homeSensorPinActiveState = homeSensorPinActiveState;
+      existingStepper->homePositionOffset = homePositionOffset;
+
+      // Update speed and acceleration in the FastAccelStepper instance
+      if (existingStepper->stepper) {
+        existingStepper->stepper->setSpeedInHz(existingStepper->maxSpeed);
+        existingStepper->stepper->setAcceleration(
+            existingStepper->acceleration);
+
+        // Log the actual values being set
+        Serial.printf("  - Updated speed: %.2f steps/sec\n",
+                      existingStepper->maxSpeed);
+        Serial.printf("  - Updated acceleration: %.2f steps/sec²\n",
+                      existingStepper->acceleration);
+      }
+    } else {
+      Serial.printf("Adding stepper ID %s (%s) on PUL %d, DIR %d, ENA %d\n",
+                    cfg_id.c_str(), name.c_str(), pulPin, dirPin, enaPin);
+
+      // Create new stepper config
+      StepperConfig *newConfig = configuredSteppers.allocate();
+      if (!newConfig) {
+        sendWebSocketMessage(clientId, F("ERROR: No free stepper slots"));
+        return;
+      }
+      newConfig->id = cfg_id;
+      newConfig->name = name;
+      newConfig->pulPin = pulPin;
+      newConfig->dirPin = dirPin;
+      newConfig->enaPin = enaPin;
+      newConfig->minPosition = minPosition;
+      newConfig->maxPosition = maxPosition;
+      newConfig->stepsPerInch = stepsPerInch;
+      newConfig->maxSpeed = maxSpeed;
+      newConfig->acceleration = acceleration;
+      newConfig->homeSensorId = homeSensorId;
+      newConfig->homingDirection = homingDirection;
+      newConfig->homingSpeed = homingSpeed;
+      newConfig->homeSensorPinActiveState = homeSensorPinActiveState;
+      newConfig->homePositionOffset = homePositionOffset;
+      newConfig->isHomed = false;
+      newConfig->isHoming = false;
+
+      // Initialize the stepper
+      if (initializeStepper(*newConfig)) {
+        existingStepper = newConfig;
+      } else {
+        configuredSteppers.release(newConfig);
+        sendWebSocketMessage(
+            clientId, String(F("ERROR: Failed to create stepper on pin ")) +
+                        String(pulPin));
+        return;
+      }
+    }
+
+    // Send success response
+    StaticJsonDocument<256> response;
+    response["status"] = F("OK");
+    response["message"] = F("Stepper configured");
+    response["id"] = existingStepper->id.c_str();
+    response["minPosition"] = existingStepper->minPosition;
+    response["maxPosition"] = existingStepper->maxPosition;
+    response["stepsPerInch"] = existingStepper->stepsPerInch;
+    response["componentGroup"] = F("steppers");
+    String jsonResponse;
+    serializeJson(response, jsonResponse);
+    sendWebSocketMessage(clientId, jsonResponse);
+    return;  // Exit after configure
+  }
+
+  // For other actions, stepper must exist
+  StepperConfig *stepper = findStepperById(id);
+  if (!stepper || !stepper->stepper) {
+    sendStepperNotFoundError(clientId, id);
+    return;
+  }
+
+  if (strcmp(action, "control") == 0) {
+    const char *command = doc["command"];
+    if (!command) {
+      sendWebSocketMessage(clientId,
+                           F("ERROR: Missing 'command' for stepper control"));
+      return;
+    }
+
+    // Store command ID if provided (for sequence tracking)
+    if (doc.containsKey("commandId")) {
+      stepper->pendingCommandId = doc["commandId"].as<String>();
+    }
+
+    if (strcmp(command, "setParams") == 0) {
+      // Update stepper parameters
+      // Serial.printf("Updating parameters for stepper '%s':\n",
+      //               stepper->name.c_str());
+
+      float oldSpeed = stepper->maxSpeed;
+      float oldAcceleration = stepper->acceleration;
+      bool speedChanged = false;
+      bool accelerationChanged = false;
+
+      if (doc.containsKey("speed")) {
+        stepper->maxSpeed = doc["speed"].as<float>();
+        stepper->stepper->setSpeedInHz(stepper->maxSpeed);
+        speedChanged = true;
+        // Serial.printf("  - Speed updated: %.2f → %.2f steps/sec\n", oldSpeed,
+        //               stepper->maxSpeed);
+      }
+
+      if (doc.containsKey("acceleration")) {
+        stepper->acceleration = doc["acceleration"].as<float>();
+        stepper->stepper->setAcceleration(stepper->acceleration);
+        accelerationChanged = true;
+        // Serial.printf("  - Acceleration updated: %.2f → %.2f steps/sec²\n",
+        //               oldAcceleration, stepper->acceleration);
+      }
+
+      if (!speedChanged) {
+        // Serial.printf("  - Speed unchanged: %.2f steps/sec\n",
+        //               stepper->maxSpeed);
+      }
+
+      if (!accelerationChanged) {
+        // Serial.printf("  - Acceleration unchanged: %.2f steps/sec²\n",
+        //               stepper->acceleration);
+      }
+
+      if (doc.containsKey("minPosition")) {
+        stepper->minPosition = doc["minPosition"].as<long>();
+        // Serial.printf("  - Min position updated to %ld steps\n",
+        //               stepper->minPosition);
+      }
+
+      if (doc.containsKey("maxPosition")) {
+        stepper->maxPosition = doc["maxPosition"].as<long>();
+        // Serial.printf("  - Max position updated to %ld steps\n",
+        //               stepper->maxPosition);
+      }
+
+      if (doc.containsKey("stepsPerInch")) {
+        stepper->stepsPerInch = doc["stepsPerInch"].as<float>();
+        // Serial.printf("  - Steps per inch updated to %.2f\n",
+        //               stepper->stepsPerInch);
+      }
+
+      // Update homing parameters
+      if (doc.containsKey("homeSensorId"))
+        stepper->homeSensorId = doc["homeSensorId"].as<String>();
+      if (doc.containsKey("homingDirection"))
+        stepper->homingDirection = doc["homingDirection"].as<int>();
+      if (doc.containsKey("homingSpeed"))
+        stepper->homingSpeed = doc["homingSpeed"].as<float>();
+      if (doc.containsKey("homeSensorPinActiveState"))
+        stepper->homeSensorPinActiveState =
+            doc["homeSensorPinActiveState"].as<int>();
+      if (doc.containsKey("homePositionOffset"))
+        stepper->homePositionOffset = doc["homePositionOffset"].as<long>();
+
+      String response = String(F("OK: Stepper params updated for ")) + id;
+      sendWebSocketMessage(clientId, response);
+    } else if (strcmp(command, "move") == 0) {
+      if (doc.containsKey("value")) {
+        long targetPos = doc["value"].as<long>();
+
+        if (moveStepperToPosition(*stepper, targetPos)) {
+          char buffer[100];
+          snprintf(buffer, sizeof(buffer), "OK: Stepper %s moving to %ld",
+                   id.c_str(), targetPos);
+          sendWebSocketMessage(clientId, buffer);
+        } else {
+          sendWebSocketMessage(
+              clientId, String(F("ERROR: Failed to move stepper ")) + id);
+        }
+      } else {
+        sendWebSocketMessage(clientId,
+                             F("ERROR: Missing 'value' for move command"));
+      }
+    } else if (strcmp(command, "step") == 0) {
+      if (doc.containsKey("value")) {
+        long steps = doc["value"].as<long>();
+
+        // Get current position
+        long currentPos = stepper->stepper->getCurrentPosition();
+
+        // Get starting position for limit checking
+        long startPos;
+        if (stepper->stepper->isRunning()) {
+          // If already running, check against target position
+          startPos = stepper->targetPosition;
+        } else {
+          // If not running, check against current position
+          startPos = currentPos;
+        }
+
+        // Check if the requested movement would exceed limits
+        long requestedPos = startPos + steps;
+        bool wouldExceedLimit = (requestedPos < stepper->minPosition) ||
+                                (requestedPos > stepper->maxPosition);
+
+        // Check if we're already at the limit in the direction of movement
+        bool atLimit = false;
+
+        if (steps > 0 && startPos >= stepper->maxPosition) {
+          Serial.printf("Stepper '%s' already at max position limit (%ld)\n",
+                        stepper->name.c_str(), stepper->maxPosition);
+          atLimit = true;
+        } else if (steps < 0 && startPos <= stepper->minPosition) {
+          Serial.printf("Stepper '%s' already at min position limit (%ld)\n",
+                        stepper->name.c_str(), stepper->minPosition);
+          atLimit = true;
+        }
+
+        if (atLimit) {
+          // If at limit, don't attempt to move and send completion immediately
+          if (!stepper->pendingCommandId.isEmpty()) {
+            sendStepperActionComplete(*stepper, true);
+            stepper->pendingCommandId = "";
+          }
+          String response =
+              String(F("OK: Stepper ")) + id + F(" at limit, no movement");
+          sendWebSocketMessage(clientId, response);
+          return;
+        }
+
+        // If the requested movement would exceed limits, log it
+        if (wouldExceedLimit) {
+          Serial.printf(
+              "Clamping movement: requested position %ld outside limits [%ld, "
+              "%ld]\n",
+              requestedPos, stepper->minPosition, stepper->maxPosition);
+        }
+
+        if (moveStepperRelative(*stepper, steps)) {
+          // Movement accepted and started
+          char buffer[128];
+          snprintf(buffer, sizeof(buffer), "OK: Stepper %s stepping %ld",
+                   id.c_str(), steps);
+          sendWebSocketMessage(clientId, buffer);
+        } else {
+          // If no actual movement due to clamping, send completion immediately
+          if (!stepper->pendingCommandId.isEmpty()) {
+            sendStepperActionComplete(*stepper, true);
+            stepper->pendingCommandId = "";
+          }
+          String response =
+              String(F("OK: Stepper ")) + id + F(" at limit, no movement");
+          sendWebSocketMessage(clientId, response);
+        }
+      } else {
+        sendWebSocketMessage(clientId,
+                             F("ERROR: Missing 'value' for step command"));
+      }
+    } else if (strcmp(command, "home") == 0) {
+      // Check if we have a home sensor configured
+      if (!stepper->homeSensorId.isEmpty()) {
+        Serial.printf("[StepperCard %s] Starting homing with sensor: %s\n",
+                      id.c_str(), stepper->homeSensorId.c_str());
+        // Use sensor-based homing
+        if (homeStepperWithSensor(*stepper)) {
+          String response =
+              String(F("OK: Stepper ")) + id + F(" homing with sensor");
+          sendWebSocketMessage(clientId, response);
+        } else {
+          String response =
+              String(F("ERROR: Failed to start homing for stepper ")) + id;
+          sendWebSocketMessage(clientId, response);
+        }
+      } else {
+        // No sensor, just move to middle position
+        long homePos = (stepper->minPosition + stepper->maxPosition) / 2;
+        if (moveStepperToPosition(*stepper, homePos)) {
+          char buffer[100];
+          snprintf(buffer, sizeof(buffer), "OK: Stepper %s homing to %ld",
+                   id.c_str(), homePos);
+          sendWebSocketMessage(clientId, buffer);
+        } else {
+          String response = String(F("ERROR: Failed to home stepper ")) + id;
+          sendWebSocketMessage(clientId, response);
+        }
+      }
+    } else if (strcmp(command, "stop") == 0) {
+      stopStepper(*stepper);
+      String response = String(F("OK: Stepper ")) + id + F(" emergency stop");
+      sendWebSocketMessage(clientId, response);
+    } else if (strcmp(command, "setCurrentPosition") == 0) {
+      if (doc.containsKey("value")) {
+        long newPosition = doc["value"].as<long>();
+
+        if (setStepperCurrentPosition(*stepper, newPosition)) {
+          char buffer[128];
+          snprintf(buffer, sizeof(buffer),
+                   "OK: Stepper %s current position set to %ld", id.c_str(),
+                   newPosition);
+          sendWebSocketMessage(clientId, buffer);
+
+          // Send an immediate position update to UI
+          sendStepperPositionUpdate(*stepper);
+        } else {
+          String response =
+              String("ERROR: Failed to set position for stepper ") + id;
+          sendWebSocketMessage(clientId, response);
+        }
+      } else {
+        sendWebSocketMessage(
+            clientId,
+            F("ERROR: Missing 'value' for setCurrentPosition command"));
+      }
+    } else {
+      sendWebSocketMessage(clientId, F("ERROR: Unknown stepper command"));
+    }
+  } else if (strcmp(action, "remove") == 0) {
+    StepperConfig *stepperToRemove = findStepperById(id);
+    if (stepperToRemove) {
+      cleanupStepper(*stepperToRemove);  // Clean up before releasing the slot
+      configuredSteppers.release(stepperToRemove);
+      String response = String(F("OK: Stepper removed: ")) + id;
+      sendWebSocketMessage(clientId, response);
+    } else {
+      String response =
+          String(F("ERROR: Stepper not found for removal: ")) + id;
+      sendWebSocketMessage(clientId, response);
+    }
+  } else {
+    sendWebSocketMessage(clientId, F("ERROR: Unknown stepper action"));
+  }
+}
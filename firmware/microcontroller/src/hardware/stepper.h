@@ -1,7 +1,7 @@
 #ifndef STEPPER_H
 #define STEPPER_H
 
-#include <AsyncWebSocket.h>
+#include <ArduinoJson.h>
 
 #include "../config.h"
 
@@ -34,7 +34,10 @@ long clampPosition(StepperConfig* stepper, long position);
 // --- WebSocket Communication ---
 
 // Send JSON error message for when a stepper is not found
-void sendStepperNotFoundError(AsyncWebSocketClient* client, const String& id);
+void sendStepperNotFoundError(uint32_t clientId, const String& id);
+
+// Handle stepper-related WebSocket messages
+void handleStepperMessage(uint32_t clientId, JsonDocument& doc);
 
 // Send position update for a stepper
 void sendStepperPositionUpdate(const StepperConfig& config);
@@ -45,7 +48,10 @@ void sendStepperActionComplete(const StepperConfig& config, bool success,
 
 // --- Periodic Updates ---
 
-// Update and report stepper positions, check for completion of moves and homing
+// Enforce position limits and check home sensors (runs at the limits rate)
+void updateStepperLimits();
+
+// Report stepper positions and check for completion of moves
 void updateStepperPositions();
 
 #endif  // STEPPER_H
\ No newline at end of file
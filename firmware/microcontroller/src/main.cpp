@@ -5,49 +5,56 @@
 #include "hardware/servo.h"
 #include "hardware/stepper.h"
 #include "message_handler.h"
+#include "network/discovery.h"
+#include "network/metrics_endpoint.h"
+#include "network/udp_transport.h"
 #include "network/wifi_manager.h"
-
-// FastAccelStepper engine setup
-FastAccelStepperEngine engine = FastAccelStepperEngine();
+#include "system/health.h"
+#include "system/tasks.h"
 
 // WebSocket and server instances
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
+AsyncWebSocket wsControl("/ws/control");
+AsyncWebSocket wsTelemetry("/ws/telemetry");
 
 void setup() {
   Serial.begin(115200);
-  delay(1000);  // Give serial monitor a chance to connect
 
   Serial.println(F("\n\n===== Everwood CNC Firmware Starting ====="));
-  Serial.println(F("Version: 1.0.0"));
+  Serial.printf("Version: %s\n", firmwareVersion);
   Serial.println(F("Build Date: " __DATE__ " " __TIME__ "\n"));
 
-  // Initialize WiFi connection
+  // Count failed heap allocations from the start
+  initHealthMonitor();
+
+  // Hostname for DHCP and mDNS, set before WiFi starts
+  initDiscovery();
+
+  // Start the stepper pulse engine
+  halStepperInit();
+
+  // Start connecting in the background; the servers accept clients once
+  // the link is up and control runs meanwhile
   initWiFi();
 
-  // Initialize FastAccelStepper engine
-  engine.init();
+  // Prometheus scrape endpoint (registered before the server starts)
+  initMetricsEndpoint();
 
   // Initialize WebSocket server
   initWebSocketServer();
 
+  // Optional UDP lane for jog commands and telemetry
+  initUdpTransport();
+
+  // Control on core 1; network, telemetry and logging on core 0
+  startTasks();
+
   Serial.println(F("System initialized and ready"));
   Serial.println(F("Waiting for web client connections..."));
 }
 
 void loop() {
-  // Clean up WebSocket clients
-  ws.cleanupClients();
-
-  // Check and maintain WiFi connection
-  updateWiFiStatus();
-
-  // Check and update input pins
-  updatePinValues();
-
-  // Update and report stepper positions
-  updateStepperPositions();
-
-  // Update servo action status
-  updateServoActionStatus();
-}
\ No newline at end of file
+  // All work runs in the tasks created by startTasks()
+  vTaskDelete(NULL);
+}
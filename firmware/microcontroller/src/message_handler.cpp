@@ -3,30 +3,84 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
+#include "hal/hal_transport.h"
+#include "hardware/adc_engine.h"
 #include "hardware/io_pin.h"
+#include "hardware/pulse_output.h"
+#include "hardware/pwm_output.h"
 #include "hardware/servo.h"
 #include "hardware/stepper.h"
+#include "system/allocation_counter.h"
+#include "system/counters.h"
+#include "system/health.h"
+#include "system/metrics.h"
+#include "system/scheduler.h"
+#include "system/state_snapshot.h"
+#include "system/tasks.h"
+#include "system/trace.h"
+
+// Handler latency metrics, recorded on the control task
+static LatencyMetric *parseLatency = nullptr;
+static LatencyMetric *pinsHandlerLatency = nullptr;
+static LatencyMetric *servosHandlerLatency = nullptr;
+static LatencyMetric *steppersHandlerLatency = nullptr;
+static LatencyMetric *systemHandlerLatency = nullptr;
+
+// Helper function to log and broadcast WebSocket messages to all clients.
+// From the control task the message is queued for the network task.
+void broadcastWebSocketMessage(const String &message) {
+  if (postOutboundText(0, message)) return;
+  logLine("WS_BROADCAST: ", message);
+  transportSendText(0, message);
+}
 
-// FastAccelStepper engine instance (declared in main.cpp.new)
-extern FastAccelStepperEngine engine;
+// Helper function to broadcast position and pin reports, status and other
+// periodic messages to /ws and /ws/telemetry only
+void broadcastTelemetryMessage(const String &message) {
+  if (postOutboundText(TRANSPORT_TELEMETRY_BROADCAST, message)) return;
+  logLine("WS_BROADCAST: ", message);
+  transportSendText(TRANSPORT_TELEMETRY_BROADCAST, message);
+}
 
-// Helper function to log and broadcast WebSocket messages to all clients
-void broadcastWebSocketMessage(const String &message) {
-  Serial.print("WS_BROADCAST: ");
-  Serial.println(message);
-  ws.textAll(message);
+// Helper function to broadcast binary stream frames (not echoed to Serial)
+// to /ws and /ws/telemetry
+void broadcastWebSocketBinary(const uint8_t *data, size_t len) {
+  if (postOutboundBinary(TRANSPORT_TELEMETRY_BROADCAST,
+                         std::vector<uint8_t>(data, data + len))) {
+    return;
+  }
+  transportSendBinary(TRANSPORT_TELEMETRY_BROADCAST, data, len);
+}
+
+// Helper function to send one binary frame to a client by address
+void sendWebSocketBinary(uint32_t clientId, std::vector<uint8_t> &&payload) {
+  if (postOutboundBinary(clientId, std::move(payload))) return;
+  transportSendBinary(clientId, payload.data(), payload.size());
 }
 
-// Helper function to log and send WebSocket messages
-void sendWebSocketMessage(AsyncWebSocketClient *client, const String &message) {
-  Serial.print("WS_OUT: ");
-  Serial.println(message);
-  client->text(message);
+// Helper function to log and send WebSocket messages to one client by
+// address (0 = nobody). The client is looked up by the network task, which
+// skips it if it has disconnected meanwhile.
+void sendWebSocketMessage(uint32_t clientId, const String &message) {
+  if (clientId == 0) return;
+  if (postOutboundText(clientId, message)) return;
+  logLine("WS_OUT: ", message);
+  transportSendText(clientId, message);
 }
 
 void initWebSocketServer() {
+  parseLatency = registerLatencyMetric("handler", "parse");
+  pinsHandlerLatency = registerLatencyMetric("handler", "pins");
+  servosHandlerLatency = registerLatencyMetric("handler", "servos");
+  steppersHandlerLatency = registerLatencyMetric("handler", "steppers");
+  systemHandlerLatency = registerLatencyMetric("handler", "system");
+
   ws.onEvent(onWebSocketEvent);
+  wsControl.onEvent(onWebSocketEvent);
+  wsTelemetry.onEvent(onWebSocketEvent);
   server.addHandler(&ws);
+  server.addHandler(&wsControl);
+  server.addHandler(&wsTelemetry);
   server.begin();
   Serial.println(F("WebSocket server started"));
 }
@@ -35,68 +89,41 @@ void onWebSocketEvent(AsyncWebSocket *server_instance,
                       AsyncWebSocketClient *client, AwsEventType type,
                       void *arg, uint8_t *data, size_t len) {
   switch (type) {
-    case WS_EVT_CONNECT:
-      Serial.printf("WebSocket client #%u connected from %s\n", client->id(),
+    case WS_EVT_CONNECT: {
+      Serial.printf("WebSocket client %s#%u connected from %s\n",
+                    server_instance->url(), client->id(),
                     client->remoteIP().toString().c_str());
+      // Components belong to the control task, so the snapshot is built
+      // there, queued like a getState command from the new client
+      static const char GET_STATE[] =
+          "{\"componentGroup\":\"system\",\"action\":\"getState\"}";
+      if (!postInboundCommand(transportAddressOf(client),
+                              (const uint8_t *)GET_STATE,
+                              sizeof(GET_STATE) - 1)) {
+        Serial.printf("Client #%u: state snapshot dropped, queue full\n",
+                      client->id());
+      }
       break;
+    }
 
     case WS_EVT_DISCONNECT:
-      Serial.printf("WebSocket client #%u disconnected\n", client->id());
+      Serial.printf("WebSocket client %s#%u disconnected\n",
+                    server_instance->url(), client->id());
       break;
 
     case WS_EVT_DATA: {
       AwsFrameInfo *info = (AwsFrameInfo *)arg;
+      incrementCounter(protocolCounters.bytesIn, len);
       if (info->final && info->index == 0 && info->len == len &&
           info->opcode == WS_TEXT) {
-        data[len] = 0;  // Null-terminate the received data
-        // Serial.printf("Received WS [%u]: %s\n", client->id(), (char *)data);
-
-        StaticJsonDocument<512> doc;  // Adjust size as needed
-        DeserializationError error = deserializeJson(doc, (char *)data);
-        if (error) {
-          Serial.printf("JSON DeserializationError: %s\n", error.c_str());
-          sendWebSocketMessage(client, F("ERROR: Invalid JSON"));
-          return;
-        }
-
-        if (doc.containsKey("action")) {
-          const char *action = doc["action"];
-          if (!strcmp(action, "ping") == 0) {
-            // Debug: Print received message to Serial
-            Serial.println(F("Received JSON message:"));
-            serializeJsonPretty(doc, Serial);
-            Serial.println();
-          }
-        }
-
-        const char *action = doc["action"];
-        const char *group = doc["componentGroup"];
-
-        if (!action) {
-          sendWebSocketMessage(client, F("ERROR: Missing action field"));
-          return;
-        }
-
-        if (!group) {
-          sendWebSocketMessage(client,
-                               F("ERROR: Missing componentGroup field"));
-          return;
-        }
-
-        // Serial.printf("Processing action: %s for group: %s\n", action,
-        // group);
-
-        if (strcmp(group, "pins") == 0) {
-          handlePinMessage(client, doc);
-        } else if (strcmp(group, "servos") == 0) {
-          handleServoMessage(client, doc);
-        } else if (strcmp(group, "steppers") == 0) {
-          handleStepperMessage(client, doc);
-        } else if (strcmp(group, "system") == 0) {
-          handleSystemMessage(client, doc);
-        } else {
-          Serial.printf("Received unhandled group: %s\n", group);
-          sendWebSocketMessage(client, F("ERROR: Unhandled component group"));
+        // Parsed and executed on the control task, which only gets the
+        // client's address
+        uint32_t address = transportAddressOf(client);
+        if (len > INBOUND_COMMAND_MAX_BYTES) {
+          incrementCounter(protocolCounters.oversizeRejected);
+          sendWebSocketMessage(address, F("ERROR: Message too long"));
+        } else if (!postInboundCommand(address, data, len)) {
+          sendWebSocketMessage(address, F("ERROR: Command queue full"));
         }
       }
       break;
@@ -111,545 +138,252 @@ void onWebSocketEvent(AsyncWebSocket *server_instance,
   }
 }
 
-void handleSystemMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
+void handleWebSocketCommand(uint32_t clientId, char *text) {
+  // Debug: echo received commands (except pings) before parsing, which
+  // modifies the buffer in place
+  if (!strstr(text, "\"ping\"")) logLine("WS_IN: ", text);
+
+  StaticJsonDocument<512> doc;  // Adjust size as needed
+  DeserializationError error;
+  uint32_t parseStartUs = traceNow();
+  {
+    ScopedLatency timer(parseLatency);
+    error = deserializeJson(doc, text);
+  }
+  if (error) {
+    logLine("JSON DeserializationError: ", error.c_str());
+    incrementCounter(protocolCounters.parseErrors);
+    sendWebSocketMessage(clientId, F("ERROR: Invalid JSON"));
+    return;
+  }
+
   const char *action = doc["action"];
-  if (strcmp(action, "ping") == 0) {
-    StaticJsonDocument<128> response;
-    response["status"] = F("OK");
-    response["action"] = F("pong");
-    response["componentGroup"] = F("system");
-    response["timestamp"] = doc["timestamp"];  // Echo timestamp
+  const char *group = doc["componentGroup"];
+  incrementCounter(protocolCounters.messagesIn[messageGroupFromName(group)]);
 
-    String jsonResponse;
-    serializeJson(response, jsonResponse);
-    sendWebSocketMessage(client, jsonResponse);
+  if (!action) {
+    sendWebSocketMessage(clientId, F("ERROR: Missing action field"));
+    return;
+  }
+
+  if (!group) {
+    sendWebSocketMessage(clientId, F("ERROR: Missing componentGroup field"));
+    return;
+  }
+
+#ifdef EVERWOOD_NATIVE
+  AllocationScope allocations(group, action);
+#endif
+  uint32_t commandHash = traceCommandId(doc["commandId"]);
+  traceSpan(TRACE_PARSE, parseStartUs, commandHash);
+  uint32_t handlerStartUs = traceNow();
+
+  if (strcmp(group, "pins") == 0) {
+    ScopedLatency timer(pinsHandlerLatency);
+    handlePinMessage(clientId, doc);
+    traceSpan(TRACE_HANDLE_PINS, handlerStartUs, commandHash);
+  } else if (strcmp(group, "servos") == 0) {
+    ScopedLatency timer(servosHandlerLatency);
+    handleServoMessage(clientId, doc);
+    traceSpan(TRACE_HANDLE_SERVOS, handlerStartUs, commandHash);
+  } else if (strcmp(group, "steppers") == 0) {
+    ScopedLatency timer(steppersHandlerLatency);
+    handleStepperMessage(clientId, doc);
+    traceSpan(TRACE_HANDLE_STEPPERS, handlerStartUs, commandHash);
+  } else if (strcmp(group, "system") == 0) {
+    ScopedLatency timer(systemHandlerLatency);
+    handleSystemMessage(clientId, doc);
+    traceSpan(TRACE_HANDLE_SYSTEM, handlerStartUs, commandHash);
   } else {
-    sendWebSocketMessage(client, F("ERROR: Unknown system action"));
+    logLine("Received unhandled group: ", group);
+    sendWebSocketMessage(clientId, F("ERROR: Unhandled component group"));
   }
 }
 
-void handlePinMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
-  const char *action = doc["action"];
+// Reply with scheduler counters, every latency histogram and heap and stack
+// health; with "reset": true the statistics are cleared after they are read
+static void sendSystemStats(uint32_t clientId, bool reset) {
+  const SchedulerStats &scheduler = getSchedulerStats();
+  ControlSnapshot snapshot = getControlSnapshot();
+
+  DynamicJsonDocument response(1536 + MAX_LATENCY_METRICS * 320);
+  response["status"] = F("OK");
+  response["action"] = F("stats");
+  response["componentGroup"] = F("system");
+  response["cpuMhz"] = getCpuFrequencyMhz();
+  response["uptimeMs"] = millis();
+
+  JsonObject ticks = response.createNestedObject("scheduler");
+  ticks["tickHz"] = controlTickHz;
+  ticks["ticks"] = scheduler.ticks;
+  ticks["overruns"] = scheduler.overruns;
+  ticks["missedTicks"] = scheduler.missedTicks;
+  ticks["maxTickUs"] = scheduler.maxTickUs;
+
+  JsonObject queues = response.createNestedObject("queues");
+  queues["inboundDropped"] = snapshot.inboundDropped;
+  queues["outboundDropped"] = snapshot.outboundDropped;
+  queues["logDropped"] = snapshot.logDropped;
+
+  writeLatencyMetrics(response.createNestedArray("latency"));
+  writeHealth(response.createNestedObject("health"), getHealthSample());
+#ifdef EVERWOOD_NATIVE
+  writeAllocationCounts(response.createNestedArray("allocations"));
+#endif
+
+  String jsonResponse;
+  serializeJson(response, jsonResponse);
+  sendWebSocketMessage(clientId, jsonResponse);
+
+  if (reset) {
+    resetSchedulerStats();
+    requestLatencyMetricsReset();
+  }
+}
 
-  if (strcmp(action, "configure") == 0) {
-    JsonObject config = doc["config"];
-    String id = config["id"];
-    String name = config["name"];
-    uint8_t pin = config["pin"];
-    String mode = config["mode"] | "output";
-    String pinType = config["pinType"] | "digital";
-    PinPullMode pullMode = static_cast<PinPullMode>(config["pullMode"] | 0);
-    uint16_t debounceMs = config["debounceMs"] | 0;
-
-    Serial.printf("Configuring pin %s: %s, %d, %s, %s, %d, %d\n", id.c_str(),
-                  name.c_str(), pin, mode.c_str(), pinType.c_str(), pullMode,
-                  debounceMs);
-
-    if (id.isEmpty() || name.isEmpty()) {
-      sendWebSocketMessage(client,
-                           F("ERROR: Missing required config fields for pin"));
-      return;
-    }
+// Stop every stepper, servo move, pulse output and LEDC fade and drop the
+// commands still queued, so nothing already waiting can start motion again.
+// Pending actions complete as failed; every client is told about the stop.
+static void emergencyStop(uint32_t clientId) {
+  uint32_t discarded = discardQueuedCommands();
+  uint8_t stopped = 0;
+  for (auto &stepper : configuredSteppers) {
+    if (!stepper.stepper) continue;
+    stopStepper(stepper);
+    sendStepperActionComplete(stepper, false, F("Emergency stop"));
+    stepper.pendingCommandId = "";
+    stopped++;
+  }
+  uint8_t servosStopped = 0;
+  for (auto &servo : configuredServos) {
+    if (!stopServo(servo)) continue;
+    sendServoActionComplete(servo, false, F("Emergency stop"));
+    servo.pendingCommandId = "";
+    servosStopped++;
+  }
+  for (auto &pin : configuredPins) {
+    cancelPinPulse(pin);
+    cancelPwmFade(pin, F("Emergency stop"));
+  }
 
-    IoPinConfig *existingPin = findPinById(id);
-    if (existingPin) {
-      cleanupPin(*existingPin);  // Clean up before reconfiguring
-      existingPin->name = name;
-      existingPin->pin = pin;
-      existingPin->mode = mode;
-      existingPin->pinType = pinType;
-      existingPin->lastValue = -1;  // Reset last value
-      existingPin->pullMode = pullMode;
-      existingPin->debounceMs = debounceMs;
-      initializePin(*existingPin);
-    } else {
-      IoPinConfig newPin = {id, name,     pin,        pinType, mode,
-                            -1, pullMode, debounceMs, nullptr};
-      initializePin(newPin);
-      configuredPins.push_back(newPin);
-    }
+  StaticJsonDocument<192> event;
+  event["type"] = F("estop");
+  event["componentGroup"] = F("system");
+  event["steppersStopped"] = stopped;
+  event["servosStopped"] = servosStopped;
+  event["commandsDiscarded"] = discarded;
+  String eventJson;
+  serializeJson(event, eventJson);
+  broadcastWebSocketMessage(eventJson);
+
+  StaticJsonDocument<128> response;
+  response["status"] = F("OK");
+  response["action"] = F("estop");
+  response["componentGroup"] = F("system");
+  String jsonResponse;
+  serializeJson(response, jsonResponse);
+  sendWebSocketMessage(clientId, jsonResponse);
+}
+
+// Reply with the configuration hash and live state of every component
+static void sendStateSnapshot(uint32_t clientId) {
+  if (!clientId) return;  // Nobody to send it to
+
+  // Slack for the F() strings, which are copied into the document
+  DynamicJsonDocument response(JSON_OBJECT_SIZE(4) + 64 +
+                               stateSnapshotCapacity());
+  response["status"] = F("OK");
+  response["action"] = F("state");
+  response["componentGroup"] = F("system");
+  response["uptimeMs"] = millis();
+  writeStateSnapshot(response.as<JsonObject>());
+
+  String jsonResponse;
+  serializeJson(response, jsonResponse);
+  sendWebSocketMessage(clientId, jsonResponse);
+}
+
+void handleSystemMessage(uint32_t clientId, JsonDocument &doc) {
+  const char *action = doc["action"];
+  if (strcmp(action, "ping") == 0) {
     StaticJsonDocument<128> response;
     response["status"] = F("OK");
-    response["message"] = F("Pin configured");
-    response["id"] = id;
+    response["action"] = F("pong");
+    response["componentGroup"] = F("system");
+    response["timestamp"] = doc["timestamp"];  // Echo timestamp
+
     String jsonResponse;
     serializeJson(response, jsonResponse);
-    sendWebSocketMessage(client, jsonResponse);
+    sendWebSocketMessage(clientId, jsonResponse);
+  } else if (strcmp(action, "configureAdc") == 0) {
+    uint32_t requested = doc["sampleRateHz"] | adcSampleRateHz;
+    uint32_t applied = setAdcSampleRate(requested);
 
-  } else if (strcmp(action, "readPin") == 0) {
-    String id = doc["id"];
-    IoPinConfig *pinToRead = findPinById(id);
-    if (!pinToRead) {
-      sendWebSocketMessage(client, F("ERROR: Pin not found"));
-      return;
-    }
-    if (pinToRead->mode != "input") {
-      sendWebSocketMessage(client, F("ERROR: Pin is not configured as input"));
-      return;
-    }
-    int value = 0;
-    if (pinToRead->pinType == "digital") {
-      value = digitalRead(pinToRead->pin);
-    } else if (pinToRead->pinType == "analog") {
-      value = analogRead(pinToRead->pin);
-    }
-    pinToRead->lastValue = value;
     StaticJsonDocument<128> response;
     response["status"] = F("OK");
-    response["id"] = pinToRead->id;
-    response["value"] = value;
+    response["message"] = F("ADC engine configured");
+    response["componentGroup"] = F("system");
+    response["sampleRateHz"] = applied;
     String jsonResponse;
     serializeJson(response, jsonResponse);
-    sendWebSocketMessage(client, jsonResponse);
-
-  } else if (strcmp(action, "writePin") == 0) {
-    String id = doc["id"];
-    int value = doc["value"];
-    String type =
-        doc["type"] | "digital";  // Default to digital if not specified
-
-    IoPinConfig *pinToWrite = findPinById(id);
-    if (!pinToWrite) {
-      sendWebSocketMessage(client, F("ERROR: Pin not found"));
+    sendWebSocketMessage(clientId, jsonResponse);
+  } else if (strcmp(action, "stats") == 0) {
+    sendSystemStats(clientId, doc["reset"] | false);
+  } else if (strcmp(action, "traceDump") == 0) {
+    if (transportEndpoint(clientId) == ENDPOINT_UDP) {  // Dumps need WS
+      sendWebSocketMessage(clientId, F("ERROR: traceDump needs a WebSocket"));
       return;
     }
-    if (pinToWrite->mode != "output") {
-      sendWebSocketMessage(client, F("ERROR: Pin is not configured as output"));
+    if (!requestTraceDump(clientId, doc["clear"] | false)) {
+      sendWebSocketMessage(clientId,
+                           F("ERROR: Trace dump already in progress"));
       return;
     }
 
-    if (type == "digital") {
-      digitalWrite(pinToWrite->pin, value ? HIGH : LOW);
-    } else if (type == "pwm") {
-      ledcWrite(pinToWrite->pin % 16, value);
-    } else if (type == "analog") {  // ESP32 DAC
-      if (pinToWrite->pin == 25 || pinToWrite->pin == 26) {
-        // dacWrite(pinToWrite->pin, constrain(value, 0, 255));
-      } else {
-        sendWebSocketMessage(
-            client, F("ERROR: Pin does not support analog output (DAC)"));
-        return;
-      }
-    }
-    pinToWrite->lastValue = value;
     StaticJsonDocument<128> response;
     response["status"] = F("OK");
-    response["message"] = F("Pin value updated");
-    response["id"] = pinToWrite->id;
-    response["value"] = value;
+    response["message"] = F("Trace dump queued");
+    response["componentGroup"] = F("system");
     String jsonResponse;
     serializeJson(response, jsonResponse);
-    sendWebSocketMessage(client, jsonResponse);
-
-  } else if (strcmp(action, "remove") == 0) {
-    String id = doc["id"];
-    auto it = std::remove_if(configuredPins.begin(), configuredPins.end(),
-                             [&](const IoPinConfig &p) { return p.id == id; });
-    if (it != configuredPins.end()) {
-      cleanupPin(*it);  // Clean up before erasing
-      configuredPins.erase(it, configuredPins.end());
-      lastPinReadTime.erase(id);  // Remove from polling map
-      sendWebSocketMessage(client, F("OK: Pin removed"));
-    } else {
-      sendWebSocketMessage(client, F("ERROR: Pin not found for removal"));
-    }
-  } else {
-    sendWebSocketMessage(client, F("ERROR: Unknown pin action"));
-  }
-}
-
-// handleServoMessage is now implemented in hardware/servo.cpp
-
-void handleStepperMessage(AsyncWebSocketClient *client, JsonDocument &doc) {
-  const char *action = doc["action"];
-  String id = doc["id"];  // Common for most stepper actions
-
-  // Handle configuration action separately since it might create a new stepper
-  if (strcmp(action, "configure") == 0) {
-    JsonObject config = doc["config"];
-    String cfg_id = config["id"];
-    String name = config["name"];
-    uint8_t pulPin = config["pulPin"];
-    uint8_t dirPin = config["dirPin"];
-    uint8_t enaPin = config["enaPin"] | 0;
-    long minPosition = config["minPosition"] | -50000;
-    long maxPosition = config["maxPosition"] | 50000;
-    float stepsPerInch = config["stepsPerInch"] | 200.0;
-    float maxSpeed = config["maxSpeed"] |
-                     50000.0;  // Default to 50k steps/sec if not specified
-    float acceleration = config["acceleration"] |
-                         50000.0;  // Default to 50k steps/sec² if not specified
-
-    // Optional homing parameters
-    String homeSensorId = config["homeSensorId"] | "";
-    int homingDirection = config["homingDirection"] | 1;
-    float homingSpeed = config["homingSpeed"] | 500.0;
-    int homeSensorPinActiveState = config["homeSensorPinActiveState"] | 0;
-    long homePositionOffset = config["homePositionOffset"] | 0;
-
-    if (cfg_id.isEmpty() || name.isEmpty() || pulPin == 0 || dirPin == 0) {
-      sendWebSocketMessage(
-          client,
-          F("ERROR: Missing stepper config fields (id, name, pulPin, dirPin)"));
-      return;
-    }
-
-    // Serial.printf("Configuring stepper '%s' (ID: %s):\n", name.c_str(),
-    //               cfg_id.c_str());
-    // Serial.printf("  - Pins: PUL=%d, DIR=%d, ENA=%d\n", pulPin, dirPin,
-    // enaPin); Serial.printf("  - Speed: %.2f steps/sec\n", maxSpeed);
-    // Serial.printf("  - Acceleration: %.2f steps/sec²\n", acceleration);
-    // Serial.printf("  - Position Range: %ld to %ld steps\n", minPosition,
-    //               maxPosition);
-    // Serial.printf("  - Steps per inch: %.2f\n", stepsPerInch);
-
-    StepperConfig *existingStepper = findStepperById(cfg_id);
-
-    if (existingStepper) {
-      Serial.printf("Updating stepper ID %s (%s)\n", cfg_id.c_str(),
-                    name.c_str());
-
-      // Store current values before updating
-      float currentSpeed = existingStepper->maxSpeed;
-      float currentAcceleration = existingStepper->acceleration;
-
-      // Update basic properties
-      existingStepper->name = name;
-      existingStepper->minPosition = minPosition;
-      existingStepper->maxPosition = maxPosition;
-      existingStepper->stepsPerInch = stepsPerInch;
-
-      // Update speed and acceleration, preserving existing values if not
-      // specified
-      existingStepper->maxSpeed =
-          config.containsKey("maxSpeed") ? maxSpeed : currentSpeed;
-      existingStepper->acceleration = config.containsKey("acceleration")
-                                          ? acceleration
-                                          : currentAcceleration;
-
-      // Update homing properties
-      existingStepper->homeSensorId = homeSensorId;
-      existingStepper->homingDirection = homingDirection;
-      existingStepper->homingSpeed = homingSpeed;
-      existingStepper->homeSensorPinActiveState = homeSensorPinActiveState;
-      existingStepper->homePositionOffset = homePositionOffset;
-
-      // Update speed and acceleration in the FastAccelStepper instance
-      if (existingStepper->stepper) {
-        existingStepper->stepper->setSpeedInHz(existingStepper->maxSpeed);
-        existingStepper->stepper->setAcceleration(
-            existingStepper->acceleration);
-
-        // Log the actual values being set
-        Serial.printf("  - Updated speed: %.2f steps/sec\n",
-                      existingStepper->maxSpeed);
-        Serial.printf("  - Updated acceleration: %.2f steps/sec²\n",
-                      existingStepper->acceleration);
-      }
-    } else {
-      Serial.printf("Adding stepper ID %s (%s) on PUL %d, DIR %d, ENA %d\n",
-                    cfg_id.c_str(), name.c_str(), pulPin, dirPin, enaPin);
-
-      // Create new stepper config
-      StepperConfig newConfig;
-      newConfig.id = cfg_id;
-      newConfig.name = name;
-      newConfig.pulPin = pulPin;
-      newConfig.dirPin = dirPin;
-      newConfig.enaPin = enaPin;
-      newConfig.minPosition = minPosition;
-      newConfig.maxPosition = maxPosition;
-      newConfig.stepsPerInch = stepsPerInch;
-      newConfig.maxSpeed = maxSpeed;
-      newConfig.acceleration = acceleration;
-      newConfig.homeSensorId = homeSensorId;
-      newConfig.homingDirection = homingDirection;
-      newConfig.homingSpeed = homingSpeed;
-      newConfig.homeSensorPinActiveState = homeSensorPinActiveState;
-      newConfig.homePositionOffset = homePositionOffset;
-      newConfig.isHomed = false;
-      newConfig.isHoming = false;
-
-      // Initialize the stepper
-      if (initializeStepper(newConfig)) {
-        configuredSteppers.push_back(newConfig);
-        existingStepper = &configuredSteppers.back();
-      } else {
-        sendWebSocketMessage(
-            client, String(F("ERROR: Failed to create stepper on pin ")) +
-                        String(pulPin));
-        return;
-      }
-    }
-
-    // Send success response
-    StaticJsonDocument<256> response;
+    sendWebSocketMessage(clientId, jsonResponse);
+  } else if (strcmp(action, "configureHealth") == 0) {
+    // Thresholds not given keep their current value
+    HealthThresholds thresholds = healthThresholds.read();
+    thresholds.minFreeHeapBytes =
+        doc["minFreeHeap"] | thresholds.minFreeHeapBytes;
+    thresholds.minLargestBlockBytes =
+        doc["minLargestBlock"] | thresholds.minLargestBlockBytes;
+    thresholds.minStackFreeBytes =
+        doc["minStackFree"] | thresholds.minStackFreeBytes;
+    healthThresholds.publish(thresholds);
+
+    StaticJsonDocument<192> response;
     response["status"] = F("OK");
-    response["message"] = F("Stepper configured");
-    response["id"] = existingStepper->id;
-    response["minPosition"] = existingStepper->minPosition;
-    response["maxPosition"] = existingStepper->maxPosition;
-    response["stepsPerInch"] = existingStepper->stepsPerInch;
-    response["componentGroup"] = F("steppers");
+    response["message"] = F("Health thresholds configured");
+    response["componentGroup"] = F("system");
+    response["minFreeHeap"] = thresholds.minFreeHeapBytes;
+    response["minLargestBlock"] = thresholds.minLargestBlockBytes;
+    response["minStackFree"] = thresholds.minStackFreeBytes;
     String jsonResponse;
     serializeJson(response, jsonResponse);
-    sendWebSocketMessage(client, jsonResponse);
-    return;  // Exit after configure
-  }
-
-  // For other actions, stepper must exist
-  StepperConfig *stepper = findStepperById(id);
-  if (!stepper || !stepper->stepper) {
-    sendStepperNotFoundError(client, id);
-    return;
-  }
-
-  if (strcmp(action, "control") == 0) {
-    const char *command = doc["command"];
-    if (!command) {
-      sendWebSocketMessage(client,
-                           F("ERROR: Missing 'command' for stepper control"));
-      return;
-    }
-
-    // Store command ID if provided (for sequence tracking)
-    if (doc.containsKey("commandId")) {
-      stepper->pendingCommandId = doc["commandId"].as<String>();
-    }
-
-    if (strcmp(command, "setParams") == 0) {
-      // Update stepper parameters
-      // Serial.printf("Updating parameters for stepper '%s':\n",
-      //               stepper->name.c_str());
-
-      float oldSpeed = stepper->maxSpeed;
-      float oldAcceleration = stepper->acceleration;
-      bool speedChanged = false;
-      bool accelerationChanged = false;
-
-      if (doc.containsKey("speed")) {
-        stepper->maxSpeed = doc["speed"].as<float>();
-        stepper->stepper->setSpeedInHz(stepper->maxSpeed);
-        speedChanged = true;
-        // Serial.printf("  - Speed updated: %.2f → %.2f steps/sec\n", oldSpeed,
-        //               stepper->maxSpeed);
-      }
-
-      if (doc.containsKey("acceleration")) {
-        stepper->acceleration = doc["acceleration"].as<float>();
-        stepper->stepper->setAcceleration(stepper->acceleration);
-        accelerationChanged = true;
-        // Serial.printf("  - Acceleration updated: %.2f → %.2f steps/sec²\n",
-        //               oldAcceleration, stepper->acceleration);
-      }
-
-      if (!speedChanged) {
-        // Serial.printf("  - Speed unchanged: %.2f steps/sec\n",
-        //               stepper->maxSpeed);
-      }
+    sendWebSocketMessage(clientId, jsonResponse);
+  } else if (strcmp(action, "estop") == 0) {
+    emergencyStop(clientId);
+  } else if (strcmp(action, "getState") == 0) {
+    sendStateSnapshot(clientId);
+  } else if (strcmp(action, "resetStats") == 0) {
+    resetSchedulerStats();
+    requestLatencyMetricsReset();
 
-      if (!accelerationChanged) {
-        // Serial.printf("  - Acceleration unchanged: %.2f steps/sec²\n",
-        //               stepper->acceleration);
-      }
-
-      if (doc.containsKey("minPosition")) {
-        stepper->minPosition = doc["minPosition"].as<long>();
-        // Serial.printf("  - Min position updated to %ld steps\n",
-        //               stepper->minPosition);
-      }
-
-      if (doc.containsKey("maxPosition")) {
-        stepper->maxPosition = doc["maxPosition"].as<long>();
-        // Serial.printf("  - Max position updated to %ld steps\n",
-        //               stepper->maxPosition);
-      }
-
-      if (doc.containsKey("stepsPerInch")) {
-        stepper->stepsPerInch = doc["stepsPerInch"].as<float>();
-        // Serial.printf("  - Steps per inch updated to %.2f\n",
-        //               stepper->stepsPerInch);
-      }
-
-      // Update homing parameters
-      if (doc.containsKey("homeSensorId"))
-        stepper->homeSensorId = doc["homeSensorId"].as<String>();
-      if (doc.containsKey("homingDirection"))
-        stepper->homingDirection = doc["homingDirection"].as<int>();
-      if (doc.containsKey("homingSpeed"))
-        stepper->homingSpeed = doc["homingSpeed"].as<float>();
-      if (doc.containsKey("homeSensorPinActiveState"))
-        stepper->homeSensorPinActiveState =
-            doc["homeSensorPinActiveState"].as<int>();
-      if (doc.containsKey("homePositionOffset"))
-        stepper->homePositionOffset = doc["homePositionOffset"].as<long>();
-
-      String response = String(F("OK: Stepper params updated for ")) + id;
-      sendWebSocketMessage(client, response);
-    } else if (strcmp(command, "move") == 0) {
-      if (doc.containsKey("value")) {
-        long targetPos = doc["value"].as<long>();
-
-        if (moveStepperToPosition(*stepper, targetPos)) {
-          char buffer[100];
-          snprintf(buffer, sizeof(buffer), "OK: Stepper %s moving to %ld",
-                   id.c_str(), targetPos);
-          sendWebSocketMessage(client, buffer);
-        } else {
-          sendWebSocketMessage(
-              client, String(F("ERROR: Failed to move stepper ")) + id);
-        }
-      } else {
-        sendWebSocketMessage(client,
-                             F("ERROR: Missing 'value' for move command"));
-      }
-    } else if (strcmp(command, "step") == 0) {
-      if (doc.containsKey("value")) {
-        long steps = doc["value"].as<long>();
-
-        // Get current position
-        long currentPos = stepper->stepper->getCurrentPosition();
-
-        // Get starting position for limit checking
-        long startPos;
-        if (stepper->stepper->isRunning()) {
-          // If already running, check against target position
-          startPos = stepper->targetPosition;
-        } else {
-          // If not running, check against current position
-          startPos = currentPos;
-        }
-
-        // Check if the requested movement would exceed limits
-        long requestedPos = startPos + steps;
-        bool wouldExceedLimit = (requestedPos < stepper->minPosition) ||
-                                (requestedPos > stepper->maxPosition);
-
-        // Check if we're already at the limit in the direction of movement
-        bool atLimit = false;
-
-        if (steps > 0 && startPos >= stepper->maxPosition) {
-          Serial.printf("Stepper '%s' already at max position limit (%ld)\n",
-                        stepper->name.c_str(), stepper->maxPosition);
-          atLimit = true;
-        } else if (steps < 0 && startPos <= stepper->minPosition) {
-          Serial.printf("Stepper '%s' already at min position limit (%ld)\n",
-                        stepper->name.c_str(), stepper->minPosition);
-          atLimit = true;
-        }
-
-        if (atLimit) {
-          // If at limit, don't attempt to move and send completion immediately
-          if (!stepper->pendingCommandId.isEmpty()) {
-            sendStepperActionComplete(*stepper, true);
-            stepper->pendingCommandId = "";
-          }
-          String response =
-              String(F("OK: Stepper ")) + id + F(" at limit, no movement");
-          sendWebSocketMessage(client, response);
-          return;
-        }
-
-        // If the requested movement would exceed limits, log it
-        if (wouldExceedLimit) {
-          Serial.printf(
-              "Clamping movement: requested position %ld outside limits [%ld, "
-              "%ld]\n",
-              requestedPos, stepper->minPosition, stepper->maxPosition);
-        }
-
-        if (moveStepperRelative(*stepper, steps)) {
-          // Movement accepted and started
-          char buffer[128];
-          snprintf(buffer, sizeof(buffer), "OK: Stepper %s stepping %ld",
-                   id.c_str(), steps);
-          sendWebSocketMessage(client, buffer);
-        } else {
-          // If no actual movement due to clamping, send completion immediately
-          if (!stepper->pendingCommandId.isEmpty()) {
-            sendStepperActionComplete(*stepper, true);
-            stepper->pendingCommandId = "";
-          }
-          String response =
-              String(F("OK: Stepper ")) + id + F(" at limit, no movement");
-          sendWebSocketMessage(client, response);
-        }
-      } else {
-        sendWebSocketMessage(client,
-                             F("ERROR: Missing 'value' for step command"));
-      }
-    } else if (strcmp(command, "home") == 0) {
-      // Check if we have a home sensor configured
-      if (!stepper->homeSensorId.isEmpty()) {
-        Serial.printf("[StepperCard %s] Starting homing with sensor: %s\n",
-                      id.c_str(), stepper->homeSensorId.c_str());
-        // Use sensor-based homing
-        if (homeStepperWithSensor(*stepper)) {
-          String response =
-              String(F("OK: Stepper ")) + id + F(" homing with sensor");
-          sendWebSocketMessage(client, response);
-        } else {
-          String response =
-              String(F("ERROR: Failed to start homing for stepper ")) + id;
-          sendWebSocketMessage(client, response);
-        }
-      } else {
-        // No sensor, just move to middle position
-        long homePos = (stepper->minPosition + stepper->maxPosition) / 2;
-        if (moveStepperToPosition(*stepper, homePos)) {
-          char buffer[100];
-          snprintf(buffer, sizeof(buffer), "OK: Stepper %s homing to %ld",
-                   id.c_str(), homePos);
-          sendWebSocketMessage(client, buffer);
-        } else {
-          String response = String(F("ERROR: Failed to home stepper ")) + id;
-          sendWebSocketMessage(client, response);
-        }
-      }
-    } else if (strcmp(command, "stop") == 0) {
-      stopStepper(*stepper);
-      String response = String(F("OK: Stepper ")) + id + F(" emergency stop");
-      sendWebSocketMessage(client, response);
-    } else if (strcmp(command, "setCurrentPosition") == 0) {
-      if (doc.containsKey("value")) {
-        long newPosition = doc["value"].as<long>();
-
-        if (setStepperCurrentPosition(*stepper, newPosition)) {
-          char buffer[128];
-          snprintf(buffer, sizeof(buffer),
-                   "OK: Stepper %s current position set to %ld", id.c_str(),
-                   newPosition);
-          sendWebSocketMessage(client, buffer);
-
-          // Send an immediate position update to UI
-          sendStepperPositionUpdate(*stepper);
-        } else {
-          String response =
-              String("ERROR: Failed to set position for stepper ") + id;
-          sendWebSocketMessage(client, response);
-        }
-      } else {
-        sendWebSocketMessage(
-            client, F("ERROR: Missing 'value' for setCurrentPosition command"));
-      }
-    } else {
-      sendWebSocketMessage(client, F("ERROR: Unknown stepper command"));
-    }
-  } else if (strcmp(action, "remove") == 0) {
-    auto it =
-        std::remove_if(configuredSteppers.begin(), configuredSteppers.end(),
-                       [&](const StepperConfig &s) { return s.id == id; });
-    if (it != configuredSteppers.end()) {
-      cleanupStepper(*it);  // Clean up before erasing
-      configuredSteppers.erase(it, configuredSteppers.end());
-      String response = String(F("OK: Stepper removed: ")) + id;
-      sendWebSocketMessage(client, response);
-    } else {
-      String response =
-          String(F("ERROR: Stepper not found for removal: ")) + id;
-      sendWebSocketMessage(client, response);
-    }
+    StaticJsonDocument<128> response;
+    response["status"] = F("OK");
+    response["message"] = F("Statistics reset");
+    response["componentGroup"] = F("system");
+    String jsonResponse;
+    serializeJson(response, jsonResponse);
+    sendWebSocketMessage(clientId, jsonResponse);
   } else {
-    sendWebSocketMessage(client, F("ERROR: Unknown stepper action"));
+    sendWebSocketMessage(clientId, F("ERROR: Unknown system action"));
   }
-}
\ No newline at end of file
+}
@@ -4,25 +4,38 @@
 #include <ArduinoJson.h>
 #include <AsyncWebSocket.h>
 
+#include <vector>
+
 #include "config.h"
 
-// WebSocket server instance
+// WebSocket server and endpoints (see hal/hal_transport.h)
 extern AsyncWebServer server;
-extern AsyncWebSocket ws;
+extern AsyncWebSocket ws;           // /ws: everything
+extern AsyncWebSocket wsControl;    // /ws/control: commands and replies
+extern AsyncWebSocket wsTelemetry;  // /ws/telemetry: reports and streams
 
 // WebSocket message helpers
-void sendWebSocketMessage(AsyncWebSocketClient *client, const String &message);
+void sendWebSocketMessage(uint32_t clientId, const String &message);
 void broadcastWebSocketMessage(const String &message);
+void broadcastTelemetryMessage(const String &message);
+void broadcastWebSocketBinary(const uint8_t *data, size_t len);
+void sendWebSocketBinary(uint32_t clientId, std::vector<uint8_t> &&payload);
 
 // Main WebSocket event handler
 void onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
                       AwsEventType type, void *arg, uint8_t *data, size_t len);
 
+// Parse and dispatch one text command (runs on the control task). Replies
+// go to clientId, a transport address (see hal/hal_transport.h): client
+// objects belong to the AsyncTCP and network tasks and may be freed at any
+// time, so handlers never hold one.
+void handleWebSocketCommand(uint32_t clientId, char *text);
+
 // Message handler function types
-void handlePinMessage(AsyncWebSocketClient *client, JsonDocument &doc);
-void handleServoMessage(AsyncWebSocketClient *client, JsonDocument &doc);
-void handleStepperMessage(AsyncWebSocketClient *client, JsonDocument &doc);
-void handleSystemMessage(AsyncWebSocketClient *client, JsonDocument &doc);
+void handlePinMessage(uint32_t clientId, JsonDocument &doc);
+void handleServoMessage(uint32_t clientId, JsonDocument &doc);
+void handleStepperMessage(uint32_t clientId, JsonDocument &doc);
+void handleSystemMessage(uint32_t clientId, JsonDocument &doc);
 
 // Initialize WebSocket server
 void initWebSocketServer();
@@ -0,0 +1,152 @@
+#ifdef EVERWOOD_NATIVE
+
+// --- Native Simulator Entry Point ---
+// Runs the pin, servo and stepper command handlers and their periodic
+// updates on simulated hardware (pin peripherals the simulation lacks are
+// listed in hal/native/pins_native.cpp). Reads one JSON message per line from
+// stdin:
+//   {"componentGroup":"steppers","action":"configure",...}  firmware command
+//   {"sim":"advance","ms":250}          run the control tick for 250 ms
+//   {"sim":"input","pin":4,"level":1}   drive a digital input
+//   {"sim":"analog","pin":34,"value":2048}
+//   {"sim":"clients","count":8}         connected clients seen by broadcasts
+// Lines prefixed "IN <clientId> " come from that client (default client 1),
+// so one process can stand in for a server with several connections.
+// Everything the firmware sends is printed as "OUT <clientId> <message>",
+// client 0 meaning a broadcast.
+// At end of input the allocation counts per message type are printed.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "config.h"
+#include "hal/native/sim.h"
+#include "hardware/io_pin.h"
+#include "hardware/servo.h"
+#include "hardware/stepper.h"
+#include "system/allocation_counter.h"
+#include "system/counters.h"
+
+// Forward declaration for WebSocket message sending function
+// (hal/native/host_runtime.cpp)
+extern void sendWebSocketMessage(uint32_t clientId, const String &message);
+
+static const uint32_t NATIVE_CLIENT_ID = 1;
+static const size_t NATIVE_LINE_MAX_BYTES = INBOUND_COMMAND_MAX_BYTES;
+
+static void printOutbound(uint32_t clientId, const uint8_t *data, size_t len,
+                          bool binary) {
+  if (binary) {
+    printf("OUT %u <%u binary bytes>\n", clientId, (unsigned)len);
+  } else {
+    printf("OUT %u %.*s\n", clientId, (int)len, (const char *)data);
+  }
+}
+
+// Run the control tick for a stretch of virtual time, calling each
+// subsystem at its configured rate
+static void runControl(uint32_t ms) {
+  static uint32_t tick = 0;
+  const uint32_t tickPeriodUs = 1000000 / controlTickHz;
+  const uint32_t ticks = (uint32_t)((uint64_t)ms * controlTickHz / 1000);
+
+  for (uint32_t i = 0; i < ticks; i++) {
+    simAdvanceUs(tickPeriodUs);
+    tick++;
+    if (tick % (controlTickHz / limitsSubsystem.rateHz) == 0) {
+      updateStepperLimits();
+    }
+    if (tick % (controlTickHz / pinsSubsystem.rateHz) == 0) {
+      updatePinValues();
+    }
+    if (tick % (controlTickHz / steppersSubsystem.rateHz) == 0) {
+      updateStepperPositions();
+    }
+    if (tick % (controlTickHz / servosSubsystem.rateHz) == 0) {
+      updateServoActionStatus();
+    }
+  }
+}
+
+static void handleSimMessage(JsonDocument &doc) {
+  const char *sim = doc["sim"];
+  if (strcmp(sim, "advance") == 0) {
+    runControl(doc["ms"] | 0);
+  } else if (strcmp(sim, "input") == 0) {
+    simSetDigitalInput(doc["pin"] | 0, doc["level"] | 0);
+  } else if (strcmp(sim, "analog") == 0) {
+    simSetAnalogInput(doc["pin"] | 0, doc["value"] | 0);
+  } else if (strcmp(sim, "clients") == 0) {
+    simSetClientCount(doc["count"] | 1);
+  } else {
+    Serial.printf("ERROR: Unknown sim action '%s'\n", sim);
+  }
+}
+
+static void handleLine(uint32_t clientId, char *line) {
+  StaticJsonDocument<512> doc;
+  DeserializationError error = deserializeJson(doc, line);
+  if (error) {
+    Serial.printf("JSON DeserializationError: %s\n", error.c_str());
+    incrementCounter(protocolCounters.parseErrors);
+    return;
+  }
+
+  if (doc.containsKey("sim")) {
+    handleSimMessage(doc);
+    return;
+  }
+
+  const char *action = doc["action"];
+  const char *group = doc["componentGroup"];
+  incrementCounter(protocolCounters.messagesIn[messageGroupFromName(group)]);
+  if (!action || !group) {
+    sendWebSocketMessage(clientId, F("ERROR: Missing action field"));
+    return;
+  }
+
+  AllocationScope allocations(group, action);
+  if (strcmp(group, "pins") == 0) {
+    handlePinMessage(clientId, doc);
+  } else if (strcmp(group, "servos") == 0) {
+    handleServoMessage(clientId, doc);
+  } else if (strcmp(group, "steppers") == 0) {
+    handleStepperMessage(clientId, doc);
+  } else {
+    Serial.printf("Received unhandled group: %s\n", group);
+    sendWebSocketMessage(clientId, F("ERROR: Unhandled component group"));
+  }
+}
+
+#ifndef UNIT_TEST  // The test runner brings its own main
+int main() {
+  // Line buffered so a driving process sees each reply as it is made
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  simSetTransportSink(printOutbound);
+  halStepperInit();
+
+  static char line[NATIVE_LINE_MAX_BYTES + 16];
+  while (fgets(line, sizeof(line), stdin)) {
+    size_t length = strcspn(line, "\r\n");
+    line[length] = '\0';
+    if (length == 0) continue;
+
+    uint32_t clientId = NATIVE_CLIENT_ID;
+    char *message = line;
+    if (strncmp(line, "IN ", 3) == 0) {
+      clientId = strtoul(line + 3, &message, 10);
+      while (*message == ' ') message++;
+    }
+    handleLine(clientId, message);
+  }
+
+  StaticJsonDocument<2048> counts;
+  writeAllocationCounts(counts.to<JsonArray>());
+  String out;
+  serializeJson(counts, out);
+  printf("ALLOCATIONS %s\n", out.c_str());
+  return 0;
+}
+#endif  // UNIT_TEST
+
+#endif  // EVERWOOD_NATIVE
@@ -0,0 +1,84 @@
+#include "discovery.h"
+
+#include <Arduino.h>
+#include <ESPmDNS.h>
+#include <WiFi.h>
+
+#include "../config.h"
+#include "../system/tasks.h"
+#include "wifi_manager.h"
+
+static const char* SERVICE_NAME = "everwood";
+static const char* SERVICE_PROTO = "tcp";
+static const uint16_t SERVICE_PORT = 80;
+// Component groups and optional features this build handles
+static const char* CAPABILITIES =
+    "pins,servos,steppers,pwm,counter,capture,pulse,trace,metrics";
+
+static char hostname[32];
+static bool advertising = false;
+static uint32_t advertisedHash = 0;
+
+static void formatHash(uint32_t hash, char* out, size_t size) {
+  snprintf(out, size, "%08x", (unsigned)hash);
+}
+
+// Build the hostname and apply it for DHCP (call before initWiFi)
+void initDiscovery() {
+  uint64_t mac = ESP.getEfuseMac();  // Byte 0 is the first MAC byte
+  snprintf(hostname, sizeof(hostname), "%s-%02x%02x%02x", mdnsHostPrefix,
+           (unsigned)(mac >> 24) & 0xff, (unsigned)(mac >> 32) & 0xff,
+           (unsigned)(mac >> 40) & 0xff);
+  WiFi.setHostname(hostname);
+}
+
+// Register the hostname and service; the responder follows later
+// reconnects by itself
+static void startAdvertising() {
+  if (!MDNS.begin(hostname)) {
+    Serial.println(F("mDNS: failed to start responder"));
+    return;
+  }
+  MDNS.setInstanceName(String(F("Everwood ")) + hostname);
+  MDNS.addService(SERVICE_NAME, SERVICE_PROTO, SERVICE_PORT);
+
+  char hash[9];
+  advertisedHash = getControlSnapshot().configHash;
+  formatHash(advertisedHash, hash, sizeof(hash));
+  MDNS.addServiceTxt(SERVICE_NAME, SERVICE_PROTO, "fw", firmwareVersion);
+  MDNS.addServiceTxt(SERVICE_NAME, SERVICE_PROTO, "cfg", hash);
+  MDNS.addServiceTxt(SERVICE_NAME, SERVICE_PROTO, "caps", CAPABILITIES);
+  MDNS.addServiceTxt(SERVICE_NAME, SERVICE_PROTO, "ws", "/ws");
+  MDNS.addServiceTxt(SERVICE_NAME, SERVICE_PROTO, "wsctl", "/ws/control");
+  MDNS.addServiceTxt(SERVICE_NAME, SERVICE_PROTO, "wstlm", "/ws/telemetry");
+  MDNS.addServiceTxt(SERVICE_NAME, SERVICE_PROTO, "metrics", "/metrics");
+  if (udpTransportEnabled) {
+    char port[6];
+    snprintf(port, sizeof(port), "%u", udpTransportPort);
+    MDNS.addServiceTxt(SERVICE_NAME, SERVICE_PROTO, "udp", port);
+  }
+  MDNS.addServiceTxt(SERVICE_NAME, SERVICE_PROTO, "board",
+                     ESP.getChipModel());
+
+  advertising = true;
+  Serial.printf("mDNS: advertising %s.local (_%s._%s)\n", hostname,
+                SERVICE_NAME, SERVICE_PROTO);
+}
+
+// Start advertising once WiFi is up and refresh the configuration hash
+void updateDiscovery() {
+  if (!advertising) {
+    if (isWiFiConnected()) startAdvertising();
+    return;
+  }
+
+  // Setting an existing TXT key replaces its value
+  uint32_t configHash = getControlSnapshot().configHash;
+  if (configHash == advertisedHash) return;
+  advertisedHash = configHash;
+  char hash[9];
+  formatHash(configHash, hash, sizeof(hash));
+  MDNS.addServiceTxt(SERVICE_NAME, SERVICE_PROTO, "cfg", hash);
+}
+
+const char* getDiscoveryHostname() { return hostname; }
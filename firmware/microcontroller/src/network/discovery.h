@@ -0,0 +1,21 @@
+#ifndef DISCOVERY_H
+#define DISCOVERY_H
+
+// --- mDNS / DNS-SD Discovery ---
+// Each station answers as <mdnsHostPrefix>-<mac>.local and advertises an
+// _everwood._tcp service on port 80 with TXT records:
+//   fw=<firmware version>  cfg=<configuration hash, hex>  caps=<groups>
+//   ws=/ws  metrics=/metrics  board=<chip model>
+//   udp=<port>  (when the UDP transport is enabled)
+
+// Build the hostname and apply it for DHCP (call before initWiFi)
+void initDiscovery();
+
+// Start advertising once WiFi is up and refresh the configuration hash
+// (network task, about once a second)
+void updateDiscovery();
+
+// "everwood-a1b2c3"
+const char* getDiscoveryHostname();
+
+#endif  // DISCOVERY_H
@@ -0,0 +1,407 @@
+#include "metrics_endpoint.h"
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <WiFi.h>
+
+#include <memory>
+
+#include "../config.h"
+#include "../hal/hal_transport.h"
+#include "../system/counters.h"
+#include "../system/health.h"
+#include "../system/tasks.h"
+#include "udp_transport.h"
+#include "wifi_manager.h"
+
+extern AsyncWebServer server;
+
+// Everything a scrape reports, sampled when the request arrives
+struct MetricsView {
+  ControlSnapshot control;
+  QueueDepths queues;
+  uint32_t messagesIn[MESSAGE_GROUP_COUNT];
+  uint32_t messagesOut[MESSAGE_GROUP_COUNT];
+  uint32_t bytesIn;
+  uint32_t bytesOut;
+  uint32_t parseErrors;
+  uint32_t oversizeRejected;
+  uint32_t freeHeap;
+  uint32_t minFreeHeap;
+  uint32_t largestFreeBlock;
+  HealthSample health;
+  bool wifiConnected;
+  int32_t rssi;
+  WiFiStats wifi;
+  UdpStats udp;
+  uint32_t clients;
+  uint32_t uptimeSeconds;
+};
+
+// One metric family: a HELP/TYPE header followed by count() samples.
+// sample() writes one complete "name{labels} value\n" line.
+struct MetricFamily {
+  const char *name;
+  const char *type;
+  const char *help;
+  size_t (*count)(const MetricsView &view);
+  int (*sample)(const MetricsView &view, size_t index, const char *name,
+                char *out, size_t size);
+};
+
+static size_t one(const MetricsView &) { return 1; }
+
+static int writeValue(char *out, size_t size, const char *name,
+                      uint64_t value) {
+  return snprintf(out, size, "%s %llu\n", name, (unsigned long long)value);
+}
+
+// Label values with \, " and newlines escaped
+static void escapeLabel(const char *in, char *out, size_t size) {
+  size_t o = 0;
+  for (; *in && o + 2 < size; in++) {
+    if (*in == '\\' || *in == '"') {
+      out[o++] = '\\';
+      out[o++] = *in;
+    } else if (*in == '\n') {
+      out[o++] = '\\';
+      out[o++] = 'n';
+    } else {
+      out[o++] = *in;
+    }
+  }
+  out[o] = 0;
+}
+
+// Index of the n-th stepper (or servo) in the snapshot's axis list
+static const AxisCounters *nthAxis(const MetricsView &view, size_t n,
+                                   bool stepper) {
+  for (uint8_t i = 0; i < view.control.axisCount; i++) {
+    if (view.control.axes[i].stepper != stepper) continue;
+    if (n-- == 0) return &view.control.axes[i];
+  }
+  return nullptr;
+}
+
+static size_t stepperCount(const MetricsView &view) {
+  size_t count = 0;
+  for (uint8_t i = 0; i < view.control.axisCount; i++) {
+    if (view.control.axes[i].stepper) count++;
+  }
+  return count;
+}
+
+static size_t subsystemCount(const MetricsView &view) {
+  return view.control.scheduler.subsystemCount;
+}
+
+// Index of the n-th task whose stack has been found
+static const TaskStackHealth *nthTaskStack(const MetricsView &view, size_t n) {
+  for (uint8_t i = 0; i < view.health.taskCount; i++) {
+    if (!view.health.tasks[i].found) continue;
+    if (n-- == 0) return &view.health.tasks[i];
+  }
+  return nullptr;
+}
+
+static size_t taskStackCount(const MetricsView &view) {
+  size_t count = 0;
+  for (uint8_t i = 0; i < view.health.taskCount; i++) {
+    if (view.health.tasks[i].found) count++;
+  }
+  return count;
+}
+
+static const char *const queueNames[] = {"inbound", "outbound", "log"};
+
+static const MetricFamily families[] = {
+    {"everwood_uptime_seconds", "gauge", "Seconds since boot", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.uptimeSeconds);
+     }},
+    {"everwood_ws_clients", "gauge", "Connected WebSocket clients", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.clients);
+     }},
+    {"everwood_ws_messages_in_total", "counter",
+     "WebSocket commands received, by componentGroup",
+     [](const MetricsView &) { return (size_t)MESSAGE_GROUP_COUNT; },
+     [](const MetricsView &v, size_t i, const char *n, char *o, size_t s) {
+       return snprintf(o, s, "%s{group=\"%s\"} %u\n", n, messageGroupNames[i],
+                       v.messagesIn[i]);
+     }},
+    {"everwood_ws_messages_out_total", "counter",
+     "WebSocket messages sent (broadcasts once), by componentGroup",
+     [](const MetricsView &) { return (size_t)MESSAGE_GROUP_COUNT; },
+     [](const MetricsView &v, size_t i, const char *n, char *o, size_t s) {
+       return snprintf(o, s, "%s{group=\"%s\"} %u\n", n, messageGroupNames[i],
+                       v.messagesOut[i]);
+     }},
+    {"everwood_ws_bytes_total", "counter", "WebSocket payload bytes",
+     [](const MetricsView &) { return (size_t)2; },
+     [](const MetricsView &v, size_t i, const char *n, char *o, size_t s) {
+       return snprintf(o, s, "%s{direction=\"%s\"} %u\n", n,
+                       i == 0 ? "in" : "out", i == 0 ? v.bytesIn : v.bytesOut);
+     }},
+    {"everwood_ws_parse_errors_total", "counter",
+     "Commands that were not valid JSON", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.parseErrors);
+     }},
+    {"everwood_dropped_total", "counter",
+     "Messages dropped because a queue was full or a frame too long",
+     [](const MetricsView &) { return (size_t)4; },
+     [](const MetricsView &v, size_t i, const char *n, char *o, size_t s) {
+       static const char *const reasons[] = {"inbound", "outbound", "log",
+                                             "oversize"};
+       const uint32_t values[] = {
+           v.control.inboundDropped, v.control.outboundDropped,
+           v.control.logDropped, v.oversizeRejected};
+       return snprintf(o, s, "%s{queue=\"%s\"} %u\n", n, reasons[i],
+                       values[i]);
+     }},
+    {"everwood_queue_depth", "gauge", "Items waiting in inter-task queues",
+     [](const MetricsView &) { return (size_t)3; },
+     [](const MetricsView &v, size_t i, const char *n, char *o, size_t s) {
+       const uint32_t values[] = {v.queues.inbound, v.queues.outbound,
+                                  v.queues.log};
+       return snprintf(o, s, "%s{queue=\"%s\"} %u\n", n, queueNames[i],
+                       values[i]);
+     }},
+    {"everwood_heap_free_bytes", "gauge", "Free heap", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.freeHeap);
+     }},
+    {"everwood_heap_min_free_bytes", "gauge", "Lowest free heap since boot",
+     one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.minFreeHeap);
+     }},
+    {"everwood_heap_largest_free_block_bytes", "gauge",
+     "Largest allocatable heap block", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.largestFreeBlock);
+     }},
+    {"everwood_heap_fragmentation_percent", "gauge",
+     "Free heap not usable by the largest single allocation", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.health.fragmentationPct);
+     }},
+    {"everwood_heap_alloc_failures_total", "counter",
+     "Heap allocations that failed", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.health.allocFailures);
+     }},
+    {"everwood_health_warnings_total", "counter",
+     "Heap and stack health warnings raised", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.health.warningsRaised);
+     }},
+    {"everwood_task_stack_min_free_bytes", "gauge",
+     "Least stack headroom seen per task (high-water mark)", taskStackCount,
+     [](const MetricsView &v, size_t i, const char *n, char *o, size_t s) {
+       const TaskStackHealth *stack = nthTaskStack(v, i);
+       return snprintf(o, s, "%s{task=\"%s\"} %u\n", n,
+                       stack ? stack->name : "",
+                       stack ? stack->minFreeBytes : 0);
+     }},
+    {"everwood_control_tick_rate_hz", "gauge", "Configured control tick rate",
+     one,
+     [](const MetricsView &, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, controlTickHz);
+     }},
+    {"everwood_control_ticks_total", "counter", "Control ticks executed", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.control.scheduler.ticks);
+     }},
+    {"everwood_control_busy_seconds_total", "counter",
+     "Time spent running control ticks", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return snprintf(o, s, "%s %.6f\n", n,
+                       v.control.scheduler.busyUs / 1000000.0);
+     }},
+    {"everwood_control_overruns_total", "counter",
+     "Control ticks longer than the tick period", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.control.scheduler.overruns);
+     }},
+    {"everwood_control_missed_ticks_total", "counter",
+     "Control ticks coalesced because the previous tick ran late", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.control.scheduler.missedTicks);
+     }},
+    {"everwood_subsystem_runs_total", "counter", "Control subsystem runs",
+     subsystemCount,
+     [](const MetricsView &v, size_t i, const char *n, char *o, size_t s) {
+       const SubsystemStats &entry = v.control.scheduler.subsystems[i];
+       return snprintf(o, s, "%s{subsystem=\"%s\"} %u\n", n, entry.name,
+                       entry.runs);
+     }},
+    {"everwood_subsystem_over_budget_total", "counter",
+     "Control subsystem runs longer than their budget",
+     subsystemCount,
+     [](const MetricsView &v, size_t i, const char *n, char *o, size_t s) {
+       const SubsystemStats &entry = v.control.scheduler.subsystems[i];
+       return snprintf(o, s, "%s{subsystem=\"%s\"} %u\n", n, entry.name,
+                       entry.overBudget);
+     }},
+    {"everwood_wifi_rssi_dbm", "gauge", "WiFi signal strength",
+     [](const MetricsView &v) { return (size_t)(v.wifiConnected ? 1 : 0); },
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return snprintf(o, s, "%s %d\n", n, v.rssi);
+     }},
+    {"everwood_wifi_disconnects_total", "counter",
+     "WiFi links lost after connecting", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.wifi.disconnects);
+     }},
+    {"everwood_wifi_failed_attempts_total", "counter",
+     "WiFi connect attempts that timed out or were refused", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.wifi.failedAttempts);
+     }},
+    {"everwood_wifi_connect_ms", "gauge",
+     "Time from attempt start to IP for the last connect", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.wifi.lastConnectMs);
+     }},
+    {"everwood_udp_peers", "gauge", "Registered UDP transport peers", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.udp.peers);
+     }},
+    {"everwood_udp_frames_total", "counter", "UDP transport frames",
+     [](const MetricsView &) { return (size_t)2; },
+     [](const MetricsView &v, size_t i, const char *n, char *o, size_t s) {
+       return snprintf(o, s, "%s{direction=\"%s\"} %u\n", n,
+                       i == 0 ? "in" : "out",
+                       i == 0 ? v.udp.framesIn : v.udp.framesOut);
+     }},
+    {"everwood_udp_duplicate_commands_total", "counter",
+     "UDP commands acked again instead of run (repeated seq or commandId)",
+     one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.udp.duplicates);
+     }},
+    {"everwood_udp_resends_total", "counter",
+     "UDP reply frames sent again for want of an ack", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.udp.resends);
+     }},
+    {"everwood_udp_lost_total", "counter",
+     "UDP reply frames given up on after every resend", one,
+     [](const MetricsView &v, size_t, const char *n, char *o, size_t s) {
+       return writeValue(o, s, n, v.udp.lost);
+     }},
+    {"everwood_stepper_steps_total", "counter", "Steps generated per stepper",
+     stepperCount,
+     [](const MetricsView &v, size_t i, const char *n, char *o, size_t s) {
+       const AxisCounters *axis = nthAxis(v, i, true);
+       char id[48];
+       escapeLabel(axis ? axis->id.c_str() : "", id, sizeof(id));
+       return snprintf(o, s, "%s{stepper=\"%s\"} %llu\n", n, id,
+                       (unsigned long long)(axis ? axis->steps : 0));
+     }},
+    {"everwood_moves_completed_total", "counter",
+     "Moves completed per stepper or servo",
+     [](const MetricsView &v) { return (size_t)v.control.axisCount; },
+     [](const MetricsView &v, size_t i, const char *n, char *o, size_t s) {
+       const AxisCounters &axis = v.control.axes[i];
+       char id[48];
+       escapeLabel(axis.id.c_str(), id, sizeof(id));
+       return snprintf(o, s, "%s{group=\"%s\",id=\"%s\"} %u\n", n,
+                       axis.stepper ? "steppers" : "servos", id,
+                       axis.movesCompleted);
+     }},
+};
+
+static const size_t FAMILY_COUNT = sizeof(families) / sizeof(families[0]);
+
+// Cursor through the families; lives as long as the chunked response
+struct MetricsRender {
+  MetricsView view;
+  size_t family = 0;
+  size_t sample = 0;  // 0 = header, then 1..count
+  char line[256];
+  size_t lineLength = 0;
+  size_t lineSent = 0;
+};
+
+static void sampleView(MetricsView &view) {
+  view.control = getControlSnapshot();
+  view.queues = getQueueDepths();
+  for (uint8_t i = 0; i < MESSAGE_GROUP_COUNT; i++) {
+    view.messagesIn[i] = protocolCounters.messagesIn[i].load();
+    view.messagesOut[i] = protocolCounters.messagesOut[i].load();
+  }
+  view.bytesIn = protocolCounters.bytesIn.load();
+  view.bytesOut = protocolCounters.bytesOut.load();
+  view.parseErrors = protocolCounters.parseErrors.load();
+  view.oversizeRejected = protocolCounters.oversizeRejected.load();
+  view.freeHeap = ESP.getFreeHeap();
+  view.minFreeHeap = ESP.getMinFreeHeap();
+  view.largestFreeBlock = ESP.getMaxAllocHeap();
+  view.health = getHealthSample();
+  view.wifiConnected = isWiFiConnected();
+  view.wifi = getWiFiStats();
+  view.rssi = view.wifiConnected ? WiFi.RSSI() : 0;
+  view.udp = getUdpStats();
+  view.clients = transportClientCount();
+  view.uptimeSeconds = millis() / 1000;
+}
+
+// Render the next line into render.line. Returns false when done.
+static bool nextLine(MetricsRender &render) {
+  while (render.family < FAMILY_COUNT) {
+    const MetricFamily &family = families[render.family];
+    int length = 0;
+    if (render.sample == 0) {
+      length = snprintf(render.line, sizeof(render.line),
+                        "# HELP %s %s\n# TYPE %s %s\n", family.name,
+                        family.help, family.name, family.type);
+    } else if (render.sample - 1 < family.count(render.view)) {
+      length = family.sample(render.view, render.sample - 1, family.name,
+                             render.line, sizeof(render.line));
+    } else {
+      render.family++;
+      render.sample = 0;
+      continue;
+    }
+
+    render.sample++;
+    if (length <= 0) continue;
+    render.lineLength = min((size_t)length, sizeof(render.line) - 1);
+    render.lineSent = 0;
+    return true;
+  }
+  return false;
+}
+
+// Copy as many rendered bytes as fit; 0 ends the response
+static size_t fillMetrics(MetricsRender &render, uint8_t *buffer,
+                          size_t maxLen) {
+  size_t written = 0;
+  while (written < maxLen) {
+    if (render.lineSent == render.lineLength && !nextLine(render)) break;
+    size_t count = min(maxLen - written, render.lineLength - render.lineSent);
+    memcpy(buffer + written, render.line + render.lineSent, count);
+    render.lineSent += count;
+    written += count;
+  }
+  return written;
+}
+
+void initMetricsEndpoint() {
+  server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+    std::shared_ptr<MetricsRender> render = std::make_shared<MetricsRender>();
+    sampleView(render->view);
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        "text/plain; version=0.0.4",
+        [render](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          return fillMetrics(*render, buffer, maxLen);
+        });
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+  });
+  Serial.println(F("Metrics endpoint ready at /metrics"));
+}
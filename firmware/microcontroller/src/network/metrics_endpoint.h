@@ -0,0 +1,9 @@
+#ifndef METRICS_ENDPOINT_H
+#define METRICS_ENDPOINT_H
+
+// Register GET /metrics (Prometheus text exposition format) on the HTTP
+// server. Values are sampled once per request and rendered line by line
+// into a chunked response, so no full-size String is ever built.
+void initMetricsEndpoint();
+
+#endif  // METRICS_ENDPOINT_H
@@ -0,0 +1,60 @@
+#include "udp_reliability.h"
+
+// Seqs more than 32 behind the newest are treated as already received
+bool udpAlreadyReceived(const UdpReceiveWindow &window, uint32_t seq) {
+  if (window.newestSeq == 0 || (int32_t)(seq - window.newestSeq) > 0) {
+    return false;
+  }
+  uint32_t behind = window.newestSeq - seq;
+  return behind == 0 || behind > 32 || ((window.bits >> (behind - 1)) & 1);
+}
+
+void udpMarkReceived(UdpReceiveWindow &window, uint32_t seq) {
+  if (window.newestSeq == 0 || (int32_t)(seq - window.newestSeq) > 0) {
+    uint32_t shift = seq - window.newestSeq;
+    if (window.newestSeq == 0 || shift > 32) {
+      window.bits = 0;
+    } else {
+      // The previous newest seq becomes bit shift - 1
+      uint32_t bits = shift == 32 ? 0 : window.bits << shift;
+      window.bits = bits | (1u << (shift - 1));
+    }
+    window.newestSeq = seq;
+    return;
+  }
+  uint32_t behind = window.newestSeq - seq;
+  if (behind >= 1 && behind <= 32) window.bits |= 1u << (behind - 1);
+}
+
+bool udpRecentCommandId(const UdpReceiveWindow &window, uint32_t hash) {
+  if (hash == 0) return false;
+  for (uint32_t recent : window.recentCommandIds) {
+    if (recent == hash) return true;
+  }
+  return false;
+}
+
+void udpRememberCommandId(UdpReceiveWindow &window, uint32_t hash) {
+  if (hash == 0) return;
+  window.recentCommandIds[window.nextRecentCommandId] = hash;
+  window.nextRecentCommandId =
+      (window.nextRecentCommandId + 1) % UDP_RECENT_COMMAND_IDS;
+}
+
+bool udpSeqAcked(uint32_t seq, uint32_t ack, uint32_t ackBits) {
+  uint32_t behind = ack - seq;  // Huge when seq is ahead of ack
+  return behind == 0 || (behind <= 32 && ((ackBits >> (behind - 1)) & 1));
+}
+
+size_t udpApplyAcks(PendingReply *pending, size_t count, uint32_t ack,
+                    uint32_t ackBits) {
+  size_t released = 0;
+  for (size_t i = 0; i < count; i++) {
+    PendingReply &reply = pending[i];
+    if (reply.seq == 0 || !udpSeqAcked(reply.seq, ack, ackBits)) continue;
+    reply.seq = 0;
+    reply.payload = String();
+    released++;
+  }
+  return released;
+}
@@ -0,0 +1,46 @@
+#ifndef UDP_RELIABILITY_H
+#define UDP_RELIABILITY_H
+
+#include <Arduino.h>
+
+#include "../config.h"
+
+// --- UDP Reliability ---
+// Sequence window, ack and commandId bookkeeping of the UDP transport (see
+// udp_transport.h), kept free of sockets and locks so it also builds in the
+// native env and is covered by test/test_udp_reliability.
+
+// Commands received from one peer: the newest seq, the 32 before it, and the
+// commandId hashes of the last UDP_RECENT_COMMAND_IDS commands accepted
+struct UdpReceiveWindow {
+  uint32_t newestSeq = 0;  // 0 = nothing received yet
+  uint32_t bits = 0;       // Bit n set: seq newestSeq - 1 - n was received
+  uint32_t recentCommandIds[UDP_RECENT_COMMAND_IDS] = {0};
+  uint8_t nextRecentCommandId = 0;
+};
+
+// A reply frame waiting for its ack
+struct PendingReply {
+  uint32_t seq = 0;  // 0 = free slot
+  String payload;
+  unsigned long sentAt = 0;
+  uint8_t resends = 0;
+};
+
+// Seqs more than 32 behind the newest are treated as already received
+bool udpAlreadyReceived(const UdpReceiveWindow &window, uint32_t seq);
+void udpMarkReceived(UdpReceiveWindow &window, uint32_t seq);
+
+// commandId hashes of accepted commands, so a client resending a command
+// under a new seq does not run it twice (0 = no commandId, never matched)
+bool udpRecentCommandId(const UdpReceiveWindow &window, uint32_t hash);
+void udpRememberCommandId(UdpReceiveWindow &window, uint32_t hash);
+
+// Whether an ack header (ack, ackBits) covers seq
+bool udpSeqAcked(uint32_t seq, uint32_t ack, uint32_t ackBits);
+
+// Release the replies an ack header covers. Returns how many were released.
+size_t udpApplyAcks(PendingReply *pending, size_t count, uint32_t ack,
+                    uint32_t ackBits);
+
+#endif  // UDP_RELIABILITY_H
@@ -0,0 +1,325 @@
+#include "udp_transport.h"
+
+#include <AsyncUDP.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "../config.h"
+#include "../hal/hal_transport.h"
+#include "../system/counters.h"
+#include "../system/tasks.h"
+#include "../system/trace.h"
+#include "udp_reliability.h"
+
+static const uint8_t UDP_VERSION = 1;
+static const size_t UDP_HEADER_BYTES = 16;
+static const size_t UDP_PAYLOAD_MAX_BYTES =
+    UDP_FRAME_MAX_BYTES - UDP_HEADER_BYTES;
+
+enum UdpFrameType : uint8_t {
+  UDP_FRAME_COMMAND = 1,
+  UDP_FRAME_REPLY = 2,
+  UDP_FRAME_TELEMETRY = 3,
+  UDP_FRAME_ACK = 4,
+};
+
+struct UdpHeader {
+  uint8_t type;
+  uint32_t seq;
+  uint32_t ack;
+  uint32_t ackBits;
+};
+
+struct UdpPeer {
+  uint32_t address = 0;  // Transport address; 0 = free slot
+  bool announced = false;  // Logged by the network task
+  IPAddress ip;
+  uint16_t port = 0;
+  unsigned long lastHeard = 0;
+
+  UdpReceiveWindow received;  // Commands received, sent back as the ack
+
+  uint32_t nextReplySeq = 1;
+  uint32_t nextTelemetrySeq = 1;
+  PendingReply pending[UDP_RESEND_SLOTS];
+};
+
+// The peer table is shared by the AsyncUDP task (receive, acks) and the
+// network task (send, resend, expiry). Frames are sent with the mutex held.
+static SemaphoreHandle_t peersMutex = nullptr;
+static AsyncUDP udp;
+static UdpPeer peers[MAX_UDP_PEERS];
+static uint32_t nextPeerId = 1;
+static UdpStats stats;
+static uint8_t frameBuffer[UDP_FRAME_MAX_BYTES];
+static char commandText[INBOUND_COMMAND_MAX_BYTES + 1];  // AsyncUDP task
+
+struct PeersLock {
+  PeersLock() { xSemaphoreTake(peersMutex, portMAX_DELAY); }
+  ~PeersLock() { xSemaphoreGive(peersMutex); }
+};
+
+static void putU32(uint8_t *out, uint32_t value) {
+  out[0] = value;
+  out[1] = value >> 8;
+  out[2] = value >> 16;
+  out[3] = value >> 24;
+}
+
+static uint32_t getU32(const uint8_t *in) {
+  return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) |
+         ((uint32_t)in[3] << 24);
+}
+
+static bool parseHeader(const uint8_t *data, size_t len, UdpHeader &header) {
+  if (len < UDP_HEADER_BYTES || data[0] != 'E' || data[1] != 'W' ||
+      data[2] != UDP_VERSION) {
+    return false;
+  }
+  header.type = data[3];
+  header.seq = getU32(data + 4);
+  header.ack = getU32(data + 8);
+  header.ackBits = getU32(data + 12);
+  return header.type >= UDP_FRAME_COMMAND && header.type <= UDP_FRAME_ACK;
+}
+
+// Every frame carries the peer's receive window as its ack
+static void sendFrame(const UdpPeer &peer, UdpFrameType type, uint32_t seq,
+                      const String *payload) {
+  size_t payloadLen = payload ? payload->length() : 0;
+  frameBuffer[0] = 'E';
+  frameBuffer[1] = 'W';
+  frameBuffer[2] = UDP_VERSION;
+  frameBuffer[3] = type;
+  putU32(frameBuffer + 4, seq);
+  putU32(frameBuffer + 8, peer.received.newestSeq);
+  putU32(frameBuffer + 12, peer.received.bits);
+  if (payloadLen) {
+    memcpy(frameBuffer + UDP_HEADER_BYTES, payload->c_str(), payloadLen);
+  }
+  size_t len = UDP_HEADER_BYTES + payloadLen;
+  if (udp.writeTo(frameBuffer, len, peer.ip, peer.port) == len) {
+    stats.framesOut++;
+  }
+}
+
+static UdpPeer *findPeer(const IPAddress &ip, uint16_t port) {
+  for (UdpPeer &peer : peers) {
+    if (peer.address && peer.port == port && peer.ip == ip) return &peer;
+  }
+  return nullptr;
+}
+
+static UdpPeer *findPeer(uint32_t address) {
+  for (UdpPeer &peer : peers) {
+    if (peer.address == address) return &peer;
+  }
+  return nullptr;
+}
+
+static UdpPeer *addPeer(const IPAddress &ip, uint16_t port) {
+  for (UdpPeer &peer : peers) {
+    if (peer.address) continue;
+    peer = UdpPeer();
+    peer.address = transportAddress(ENDPOINT_UDP, nextPeerId);
+    peer.ip = ip;
+    peer.port = port;
+    nextPeerId = (nextPeerId + 1) & TRANSPORT_SOCKET_MASK;
+    if (nextPeerId == 0) nextPeerId = 1;
+    return &peer;
+  }
+  return nullptr;
+}
+
+// Send a reliable frame and keep it until the peer acknowledges it; with
+// every slot taken the oldest reply is given up on
+static void sendReply(UdpPeer &peer, const String &text) {
+  if (text.length() > UDP_PAYLOAD_MAX_BYTES) {
+    stats.oversize++;
+    sendReply(peer, F("ERROR: Reply too long for UDP, use the WebSocket"));
+    return;
+  }
+
+  PendingReply *slot = &peer.pending[0];
+  for (PendingReply &reply : peer.pending) {
+    if (reply.seq == 0) {
+      slot = &reply;
+      break;
+    }
+    if ((int32_t)(reply.seq - slot->seq) < 0) slot = &reply;
+  }
+  if (slot->seq != 0) stats.lost++;
+
+  slot->seq = peer.nextReplySeq++;
+  if (peer.nextReplySeq == 0) peer.nextReplySeq = 1;
+  slot->payload = text;
+  slot->sentAt = millis();
+  slot->resends = 0;
+  sendFrame(peer, UDP_FRAME_REPLY, slot->seq, &slot->payload);
+}
+
+// Unreliable: dropped if too long, never resent
+static void sendTelemetry(UdpPeer &peer, const String &text) {
+  if (text.length() > UDP_PAYLOAD_MAX_BYTES) {
+    stats.oversize++;
+    return;
+  }
+  sendFrame(peer, UDP_FRAME_TELEMETRY, peer.nextTelemetrySeq++, &text);
+}
+
+// Queue a command frame for the control task unless it is a repeat. A
+// command that does not fit the queue stays unacked, so the client resends.
+static void acceptCommand(UdpPeer &peer, uint32_t seq, const uint8_t *payload,
+                          size_t len) {
+  if (seq == 0 || udpAlreadyReceived(peer.received, seq)) {
+    stats.duplicates++;
+    return;
+  }
+  if (len > INBOUND_COMMAND_MAX_BYTES) {
+    udpMarkReceived(peer.received, seq);
+    incrementCounter(protocolCounters.oversizeRejected);
+    sendReply(peer, F("ERROR: Message too long"));
+    return;
+  }
+
+  memcpy(commandText, payload, len);
+  commandText[len] = 0;
+  uint32_t commandHash = traceCommandIdInText(commandText);
+  if (udpRecentCommandId(peer.received, commandHash)) {
+    udpMarkReceived(peer.received, seq);
+    stats.duplicates++;
+    return;
+  }
+
+  if (!postUdpCommand(peer.address, (const uint8_t *)commandText, len)) {
+    stats.deferred++;
+    return;
+  }
+  udpMarkReceived(peer.received, seq);
+  udpRememberCommandId(peer.received, commandHash);
+}
+
+// Runs on the AsyncUDP task
+static void onUdpPacket(AsyncUDPPacket &packet) {
+  const uint8_t *data = packet.data();
+  size_t len = packet.length();
+  UdpHeader header;
+  bool valid = parseHeader(data, len, header);
+
+  PeersLock lock;
+  if (!valid) {
+    stats.rejected++;
+    return;
+  }
+  IPAddress ip = packet.remoteIP();
+  uint16_t port = packet.remotePort();
+  UdpPeer *peer = findPeer(ip, port);
+  if (!peer) peer = addPeer(ip, port);
+  if (!peer) {
+    stats.rejected++;  // Peer table full
+    return;
+  }
+
+  stats.framesIn++;
+  incrementCounter(protocolCounters.bytesIn, len);
+  peer->lastHeard = millis();
+  udpApplyAcks(peer->pending, UDP_RESEND_SLOTS, header.ack, header.ackBits);
+  if (header.type != UDP_FRAME_COMMAND) return;
+
+  acceptCommand(*peer, header.seq, data + UDP_HEADER_BYTES,
+                len - UDP_HEADER_BYTES);
+  sendFrame(*peer, UDP_FRAME_ACK, 0, nullptr);
+}
+
+// Start listening on udpTransportPort when udpTransportEnabled
+void initUdpTransport() {
+  if (!udpTransportEnabled) return;
+  peersMutex = xSemaphoreCreateMutex();
+  if (!udp.listen(udpTransportPort)) {
+    Serial.printf("UDP transport: could not listen on port %u\n",
+                  udpTransportPort);
+    return;
+  }
+  udp.onPacket(onUdpPacket);
+  Serial.printf("UDP transport listening on port %u\n", udpTransportPort);
+}
+
+// Resend unacknowledged replies and drop silent peers. Peer changes are
+// logged here, through the network task's log queue, rather than on the
+// AsyncUDP task.
+void updateUdpTransport() {
+  if (!peersMutex) return;
+  unsigned long now = millis();
+  PeersLock lock;
+  for (UdpPeer &peer : peers) {
+    if (!peer.address) continue;
+    if (!peer.announced) {
+      peer.announced = true;
+      logLine("UDP: ", String(F("peer #")) +
+                           transportSocketId(peer.address) +
+                           F(" connected from ") + peer.ip.toString() + ':' +
+                           peer.port);
+    }
+    if (now - peer.lastHeard >= udpPeerTimeout) {
+      logLine("UDP: ", String(F("peer #")) +
+                           transportSocketId(peer.address) +
+                           F(" timed out"));
+      peer = UdpPeer();
+      continue;
+    }
+
+    for (PendingReply &reply : peer.pending) {
+      if (reply.seq == 0 || now - reply.sentAt < udpResendInterval) continue;
+      if (reply.resends >= udpMaxResends) {
+        stats.lost++;
+        reply.seq = 0;
+        reply.payload = String();
+        continue;
+      }
+      reply.resends++;
+      reply.sentAt = now;
+      stats.resends++;
+      sendFrame(peer, UDP_FRAME_REPLY, reply.seq, &reply.payload);
+    }
+  }
+}
+
+// Send text to one peer, or to every peer for socket id 0
+void udpSendText(uint32_t address, const String &text) {
+  if (!peersMutex) return;
+  PeersLock lock;
+  if (transportSocketId(address) != 0) {
+    if (UdpPeer *peer = findPeer(address)) sendReply(*peer, text);
+    return;
+  }
+
+  bool telemetry = transportEndpoint(address) == ENDPOINT_TELEMETRY;
+  for (UdpPeer &peer : peers) {
+    if (!peer.address) continue;
+    if (telemetry) {
+      sendTelemetry(peer, text);
+    } else {
+      sendReply(peer, text);
+    }
+  }
+}
+
+size_t udpPeerCount() {
+  if (!peersMutex) return 0;
+  PeersLock lock;
+  size_t count = 0;
+  for (const UdpPeer &peer : peers) {
+    if (peer.address) count++;
+  }
+  return count;
+}
+
+UdpStats getUdpStats() {
+  if (!peersMutex) return UdpStats();
+  PeersLock lock;
+  UdpStats copy = stats;
+  for (const UdpPeer &peer : peers) {
+    if (peer.address) copy.peers++;
+  }
+  return copy;
+}
@@ -0,0 +1,60 @@
+#ifndef UDP_TRANSPORT_H
+#define UDP_TRANSPORT_H
+
+#include <Arduino.h>
+
+// --- UDP Transport ---
+// Optional low-latency lane next to the WebSockets: the same JSON command
+// set in datagrams, so a lost packet delays only itself instead of every
+// frame queued behind a TCP retransmit. Configuration, state snapshots,
+// trace dumps and captures stay on the WebSocket.
+//
+// Every datagram starts with a 16-byte little-endian header
+//   u8 'E', u8 'W', u8 version (1), u8 type
+//   u32 seq      frame number (reliable frames, per peer and direction)
+//   u32 ack      highest reliable seq received from the other side
+//   u32 ackBits  bit n set: seq ack - 1 - n was received as well
+// followed by the frame's JSON text, if any. Frame types:
+//   1 command    client -> device, reliable; resent by the client until its
+//                seq shows up in an ack
+//   2 reply      device -> client, reliable; replies and broadcast events,
+//                resent every udpResendInterval, at most udpMaxResends times
+//   3 telemetry  device -> client, never resent or acked; seq counts
+//                telemetry frames only and the newest frame wins
+//   4 ack        header only, either way; doubles as the keepalive
+// Every command frame is answered by an ack. A command whose seq was already
+// received, or whose commandId matches one of the peer's last
+// UDP_RECENT_COMMAND_IDS, is acked again but not run twice. Any valid frame
+// registers its sender; peers silent for udpPeerTimeout are dropped.
+//
+// Peers are addressed as ENDPOINT_UDP (see hal/hal_transport.h). Their
+// commands take the priority lane (see system/tasks.h).
+
+// Frames, peers and reliability counters for the metrics endpoint
+struct UdpStats {
+  uint32_t peers = 0;
+  uint32_t framesIn = 0;
+  uint32_t framesOut = 0;
+  uint32_t duplicates = 0;  // Commands acked again instead of run
+  uint32_t deferred = 0;    // Commands left unacked because the queue was full
+  uint32_t resends = 0;     // Reply frames sent again
+  uint32_t lost = 0;        // Reply frames given up on
+  uint32_t rejected = 0;    // Malformed frames, or the peer table was full
+  uint32_t oversize = 0;    // Messages too long for one datagram
+};
+
+// Start listening on udpTransportPort when udpTransportEnabled
+void initUdpTransport();
+
+// Resend unacknowledged replies and drop silent peers (network task, every
+// pass)
+void updateUdpTransport();
+
+// Send text to a peer by transport address, or to every peer for socket id
+// 0: as telemetry frames for the telemetry audience, otherwise as replies
+void udpSendText(uint32_t address, const String &text);
+
+size_t udpPeerCount();
+UdpStats getUdpStats();
+
+#endif  // UDP_TRANSPORT_H
@@ -1,30 +1,152 @@
 #include "wifi_manager.h"
 
 #include <Arduino.h>
+#include <Preferences.h>
+#include <esp_attr.h>
+
+#include <atomic>
 
 #include "../config.h"
 
+// --- Connection State Machine ---
+// WiFi events arrive on the Arduino event task and only set flags; the
+// network task advances the state in updateWiFiStatus(). Nothing here
+// blocks, so motion and local sequences run while the link comes up.
+
+enum WiFiState : uint8_t {
+  WIFI_STATE_CONNECTING,  // begin() issued, waiting for an IP
+  WIFI_STATE_CONNECTED,
+  WIFI_STATE_BACKOFF,  // Waiting to retry
+};
+
+// Event flags set by onWiFiEvent()
+static const uint32_t WIFI_EVENT_GOT_IP = 1 << 0;
+static const uint32_t WIFI_EVENT_DISCONNECTED = 1 << 1;
+
+// Attempts that try the cached channel and BSSID before falling back to a
+// full scan (the access point may have moved channel)
+static const uint8_t WIFI_CACHED_ATTEMPTS = 2;
+static const uint32_t WIFI_CACHE_MAGIC = 0x57494631;  // "WIF1"
+
+// Channel and BSSID of the last access point we joined. Kept in RTC memory
+// across resets and in NVS across power cycles; joining with them skips
+// the scan, which is most of the connect time.
+struct WiFiLinkCache {
+  uint32_t magic;
+  uint8_t channel;
+  uint8_t bssid[6];
+};
+
+RTC_DATA_ATTR static WiFiLinkCache rtcLinkCache;
+
+static std::atomic<uint32_t> pendingEvents(0);
+static std::atomic<uint8_t> lastDisconnectReason(0);
+static WiFiLinkCache connectedLink;  // Written before WIFI_EVENT_GOT_IP
+
+static WiFiState state = WIFI_STATE_BACKOFF;
+static WiFiStats stats;
+static uint8_t failures = 0;  // Consecutive failed attempts
+static unsigned long attemptStart = 0;
+static unsigned long nextAttempt = 0;
+static bool attemptUsedCache = false;
+
 // Variables for IP printing
 unsigned long ipPrintStopTime = 0;
 unsigned long lastIpPrintTime = 0;
 
-// Initialize WiFi connection
-void initWiFi() {
-  Serial.print(F("Connecting to WiFi"));
-  WiFi.begin(ssid, password);
+// Runs on the Arduino event task
+static void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+      connectedLink.magic = WIFI_CACHE_MAGIC;
+      connectedLink.channel = info.wifi_sta_connected.channel;
+      memcpy(connectedLink.bssid, info.wifi_sta_connected.bssid,
+             sizeof(connectedLink.bssid));
+      break;
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      pendingEvents.fetch_or(WIFI_EVENT_GOT_IP);
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      lastDisconnectReason.store(info.wifi_sta_disconnected.reason);
+      pendingEvents.fetch_or(WIFI_EVENT_DISCONNECTED);
+      break;
+    default:
+      break;
+  }
+}
+
+// A zeroed cache (first boot) or channel 0 means "scan"
+static bool cacheValid(const WiFiLinkCache& cache) {
+  return cache.magic == WIFI_CACHE_MAGIC && cache.channel != 0;
+}
+
+// RTC memory survives a reset; after a power cycle fall back to NVS
+static void loadLinkCache() {
+  if (cacheValid(rtcLinkCache)) return;
 
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(500);
-    Serial.print(F("."));
+  Preferences prefs;
+  if (prefs.begin("wifi", true)) {
+    WiFiLinkCache stored;
+    if (prefs.getBytes("link", &stored, sizeof(stored)) == sizeof(stored) &&
+        cacheValid(stored)) {
+      rtcLinkCache = stored;
+    }
+    prefs.end();
   }
+}
 
-  Serial.print(F("\nConnected to "));
-  Serial.println(ssid);
-  Serial.print(F("IP_READY:"));
-  Serial.println(WiFi.localIP());
+// Only written when the access point changes, to spare the flash
+static void saveLinkCache(const WiFiLinkCache& link) {
+  if (memcmp(&link, &rtcLinkCache, sizeof(link)) == 0) return;
+  rtcLinkCache = link;
+
+  Preferences prefs;
+  if (prefs.begin("wifi", false)) {
+    prefs.putBytes("link", &link, sizeof(link));
+    prefs.end();
+  }
+}
+
+// Join with the cached access point for the first attempts, then scan
+static void startAttempt(unsigned long now) {
+  attemptUsedCache =
+      failures < WIFI_CACHED_ATTEMPTS && cacheValid(rtcLinkCache);
+  if (attemptUsedCache) {
+    WiFi.begin(ssid, password, rtcLinkCache.channel, rtcLinkCache.bssid);
+  } else {
+    WiFi.begin(ssid, password);
+  }
+  state = WIFI_STATE_CONNECTING;
+  attemptStart = now;
+}
+
+// Schedule the next attempt after an exponential backoff
+static void attemptFailed(unsigned long now) {
+  stats.failedAttempts++;
+  unsigned long delayMs = wifiBackoffMax;
+  if (failures < 16) {
+    delayMs = min(wifiBackoffMin << failures, wifiBackoffMax);
+  }
+  if (failures < 255) failures++;
 
-  ipPrintStopTime = millis() + ipPrintDuration;
-  lastIpPrintTime = millis();
+  state = WIFI_STATE_BACKOFF;
+  nextAttempt = now + delayMs;
+  Serial.printf("WiFi: attempt failed (reason %u), retrying in %lu ms\n",
+                lastDisconnectReason.load(), delayMs);
+}
+
+// Start connecting in the background; returns immediately
+void initWiFi() {
+  WiFi.persistent(false);  // Credentials come from config.cpp, not flash
+  WiFi.mode(WIFI_STA);
+  WiFi.setSleep(false);          // Modem sleep adds latency to every frame
+  WiFi.setAutoReconnect(false);  // Reconnects are driven from here
+  WiFi.onEvent(onWiFiEvent);
+
+  loadLinkCache();
+  Serial.printf("Connecting to WiFi %s%s\n", ssid,
+                cacheValid(rtcLinkCache) ? " (cached channel)" : "");
+  startAttempt(millis());
 }
 
 // Print IP address information
@@ -33,21 +155,68 @@ void printIPAddress() {
   Serial.println(WiFi.localIP());
 }
 
-// Check and maintain WiFi connection
+// Advance the connection state machine
 void updateWiFiStatus() {
   unsigned long now = millis();
+  uint32_t events = pendingEvents.exchange(0);
+
+  if (events & WIFI_EVENT_DISCONNECTED) {
+    if (state == WIFI_STATE_CONNECTED) {
+      // Retry at once; the cached access point usually answers right away
+      stats.disconnects++;
+      failures = 0;
+      Serial.printf("WiFi connection lost (reason %u). Reconnecting...\n",
+                    lastDisconnectReason.load());
+      startAttempt(now);
+    } else if (state == WIFI_STATE_CONNECTING) {
+      attemptFailed(now);
+    }
+    // A disconnect that raced a later GOT_IP is superseded by it below
+  }
+
+  if ((events & WIFI_EVENT_GOT_IP) && state != WIFI_STATE_CONNECTED &&
+      WiFi.status() == WL_CONNECTED) {
+    state = WIFI_STATE_CONNECTED;
+    failures = 0;
+    stats.connects++;
+    stats.lastConnectMs = now - attemptStart;
+    stats.lastUsedCache = attemptUsedCache;
+    saveLinkCache(connectedLink);
 
-  // Print IP address periodically during startup
-  if (ipPrintStopTime && now < ipPrintStopTime &&
-      now - lastIpPrintTime >= ipPrintInterval) {
+    Serial.printf("Connected to %s in %lu ms (channel %u%s)\n", ssid,
+                  stats.lastConnectMs, connectedLink.channel,
+                  attemptUsedCache ? ", cached" : "");
     printIPAddress();
-    lastIpPrintTime = now;
+    if (stats.connects == 1) {
+      // Repeat the address for a while so the IP finder can pick it up
+      ipPrintStopTime = now + ipPrintDuration;
+      lastIpPrintTime = now;
+    }
   }
 
-  // Check if WiFi is still connected, attempt to reconnect if needed
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println(F("WiFi connection lost. Reconnecting..."));
-    WiFi.disconnect();
-    WiFi.begin(ssid, password);
+  switch (state) {
+    case WIFI_STATE_CONNECTING:
+      if (now - attemptStart >= wifiConnectTimeout) {
+        WiFi.disconnect();
+        attemptFailed(now);
+      }
+      break;
+    case WIFI_STATE_BACKOFF:
+      if ((long)(now - nextAttempt) >= 0) startAttempt(now);
+      break;
+    case WIFI_STATE_CONNECTED:
+      // Print IP address periodically during startup
+      if (ipPrintStopTime && now < ipPrintStopTime &&
+          now - lastIpPrintTime >= ipPrintInterval) {
+        printIPAddress();
+        lastIpPrintTime = now;
+      }
+      break;
   }
-}
\ No newline at end of file
+}
+
+// True once an IP address has been assigned
+bool isWiFiConnected() { return state == WIFI_STATE_CONNECTED; }
+
+// Connection history for the metrics endpoint
+const WiFiStats& getWiFiStats() { return stats; }
@@ -3,13 +3,27 @@
 
 #include <WiFi.h>
 
-// Initialize WiFi connection
+// Connection history, read by the metrics endpoint
+struct WiFiStats {
+  uint32_t connects = 0;        // Successful connections (incl. the first)
+  uint32_t disconnects = 0;     // Links lost after being connected
+  uint32_t failedAttempts = 0;  // Attempts that timed out or were refused
+  uint32_t lastConnectMs = 0;   // Attempt start to IP for the last connect
+  bool lastUsedCache = false;   // Last connect skipped the scan
+};
+
+// Start connecting in the background; returns immediately
 void initWiFi();
 
 // Print IP address information
 void printIPAddress();
 
-// Check and maintain WiFi connection
+// Advance the connection state machine (network task, every pass)
 void updateWiFiStatus();
 
-#endif  // WIFI_MANAGER_H
\ No newline at end of file
+// True once an IP address has been assigned
+bool isWiFiConnected();
+
+const WiFiStats& getWiFiStats();
+
+#endif  // WIFI_MANAGER_H
@@ -0,0 +1,111 @@
+#ifdef EVERWOOD_NATIVE
+
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+static const uint8_t MAX_ALLOCATION_TYPES = 32;
+struct AllocationType {
+  char key[40];  // "componentGroup.action"
+  uint32_t messages;
+  uint64_t allocations;
+};
+
+static std::atomic<uint32_t> allocations{0};
+static AllocationType allocationTypes[MAX_ALLOCATION_TYPES];
+static uint8_t allocationTypeCount = 0;
+
+#ifdef EVERWOOD_COUNT_MALLOC
+// Every malloc, calloc and realloc call in the program's own objects
+// (operator new below included) is redirected here by the linker
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *block, size_t size);
+
+void *__wrap_malloc(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *block, size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  return __real_realloc(block, size);
+}
+}
+#endif
+
+void *operator new(size_t size) {
+#ifndef EVERWOOD_COUNT_MALLOC
+  allocations.fetch_add(1, std::memory_order_relaxed);  // Else in malloc
+#endif
+  void *block = malloc(size ? size : 1);
+  if (!block) throw std::bad_alloc();
+  return block;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *block) noexcept { free(block); }
+void operator delete[](void *block) noexcept { free(block); }
+void operator delete(void *block, size_t) noexcept { free(block); }
+void operator delete[](void *block, size_t) noexcept { free(block); }
+
+uint32_t allocationCount() {
+  return allocations.load(std::memory_order_relaxed);
+}
+
+bool allocationCountIncludesMalloc() {
+#ifdef EVERWOOD_COUNT_MALLOC
+  return true;
+#else
+  return false;
+#endif
+}
+
+static AllocationType *findAllocationType(const char *group,
+                                          const char *action) {
+  char key[sizeof(AllocationType::key)];
+  snprintf(key, sizeof(key), "%s.%s", group ? group : "?",
+           action ? action : "?");
+  for (uint8_t i = 0; i < allocationTypeCount; i++) {
+    if (strcmp(allocationTypes[i].key, key) == 0) return &allocationTypes[i];
+  }
+  if (allocationTypeCount >= MAX_ALLOCATION_TYPES) return nullptr;
+  AllocationType &type = allocationTypes[allocationTypeCount++];
+  memcpy(type.key, key, sizeof(key));
+  return &type;
+}
+
+AllocationScope::AllocationScope(const char *group, const char *action)
+    : group_(group), action_(action), start_(allocationCount()) {}
+
+AllocationScope::~AllocationScope() {
+  uint32_t made = allocationCount() - start_;
+  AllocationType *type = findAllocationType(group_, action_);
+  if (!type) return;
+  type->messages++;
+  type->allocations += made;
+}
+
+void writeAllocationCounts(JsonArray out) {
+  for (uint8_t i = 0; i < allocationTypeCount; i++) {
+    const AllocationType &type = allocationTypes[i];
+    JsonObject item = out.createNestedObject();
+    item["type"] = type.key;
+    item["messages"] = type.messages;
+    item["allocations"] = type.allocations;
+    item["perMessage"] =
+        type.messages ? (float)type.allocations / type.messages : 0;
+    item["includesMalloc"] = allocationCountIncludesMalloc();
+  }
+}
+
+#endif  // EVERWOOD_NATIVE
@@ -0,0 +1,39 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#ifdef EVERWOOD_NATIVE
+
+#include <ArduinoJson.h>
+#include <stdint.h>
+
+// --- Allocation Counting (native builds only) ---
+// Global operator new is replaced to count allocations, and on Linux hosts
+// malloc, calloc and realloc are wrapped at link time too (see
+// native_alloc_flags.py), which covers ArduinoJson's DynamicJsonDocument
+// pools. Each handled message records how many allocations it made, per
+// componentGroup and action, so allocation-heavy handlers show up in host
+// tests. The native String allocates like the device's (compat/Arduino.h).
+uint32_t allocationCount();
+
+// Whether allocationCount() includes the malloc family; without it the
+// counts undercount the device by every JSON document pool
+bool allocationCountIncludesMalloc();
+
+class AllocationScope {
+ public:
+  AllocationScope(const char *group, const char *action);
+  ~AllocationScope();
+
+ private:
+  const char *group_;
+  const char *action_;
+  uint32_t start_;
+};
+
+// Per message type: messages handled and allocations made, each flagged
+// with allocationCountIncludesMalloc()
+void writeAllocationCounts(JsonArray out);
+
+#endif  // EVERWOOD_NATIVE
+
+#endif  // ALLOCATION_COUNTER_H
@@ -0,0 +1,28 @@
+#include "counters.h"
+
+const char* const messageGroupNames[MESSAGE_GROUP_COUNT] = {
+    "pins", "servos", "steppers", "system", "binary", "other"};
+
+ProtocolCounters protocolCounters;  // Zero-initialized (static storage)
+
+MessageGroup messageGroupFromName(const char* group) {
+  if (!group) return GROUP_OTHER;
+  for (uint8_t i = 0; i < GROUP_BINARY; i++) {
+    if (strcmp(group, messageGroupNames[i]) == 0) return (MessageGroup)i;
+  }
+  return GROUP_OTHER;
+}
+
+MessageGroup messageGroupInText(const char* json) {
+  static const char KEY[] = "\"componentGroup\":\"";
+  const char* start = json ? strstr(json, KEY) : nullptr;
+  if (!start) return GROUP_OTHER;
+  start += sizeof(KEY) - 1;
+  for (uint8_t i = 0; i < GROUP_BINARY; i++) {
+    size_t len = strlen(messageGroupNames[i]);
+    if (strncmp(start, messageGroupNames[i], len) == 0 && start[len] == '"') {
+      return (MessageGroup)i;
+    }
+  }
+  return GROUP_OTHER;
+}
@@ -0,0 +1,48 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <Arduino.h>
+
+#include <atomic>
+
+// --- Protocol Counters ---
+// Monotonic message and byte counts, updated by the task that sees each
+// message (AsyncTCP, control or network) and read by the /metrics endpoint.
+// 32-bit so updates stay single atomic instructions; scrapers treat a wrap
+// like a restart.
+
+enum MessageGroup : uint8_t {
+  GROUP_PINS = 0,
+  GROUP_SERVOS,
+  GROUP_STEPPERS,
+  GROUP_SYSTEM,
+  GROUP_BINARY,  // Binary frames (streams, captures)
+  GROUP_OTHER,   // Missing or unknown componentGroup
+  MESSAGE_GROUP_COUNT
+};
+
+extern const char* const messageGroupNames[MESSAGE_GROUP_COUNT];
+
+struct ProtocolCounters {
+  std::atomic<uint32_t> messagesIn[MESSAGE_GROUP_COUNT];
+  std::atomic<uint32_t> messagesOut[MESSAGE_GROUP_COUNT];
+  std::atomic<uint32_t> bytesIn;
+  std::atomic<uint32_t> bytesOut;
+  std::atomic<uint32_t> parseErrors;
+  std::atomic<uint32_t> oversizeRejected;  // Frames too long to queue
+};
+
+extern ProtocolCounters protocolCounters;
+
+inline void incrementCounter(std::atomic<uint32_t>& counter,
+                             uint32_t amount = 1) {
+  counter.fetch_add(amount, std::memory_order_relaxed);
+}
+
+// Group for a componentGroup name (GROUP_OTHER if null or unknown)
+MessageGroup messageGroupFromName(const char* group);
+
+// Group named by the "componentGroup" field inside raw JSON text
+MessageGroup messageGroupInText(const char* json);
+
+#endif  // COUNTERS_H
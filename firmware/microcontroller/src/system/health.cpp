@@ -0,0 +1,189 @@
+#include "health.h"
+
+#include <esp_timer.h>
+
+#ifndef EVERWOOD_NATIVE
+#include <esp_heap_caps.h>
+#endif
+
+#include <atomic>
+
+#include "../util/double_buffer.h"
+#include "tasks.h"
+
+// Forward declaration for WebSocket broadcast function
+extern void broadcastWebSocketMessage(const String &message);
+
+struct HealthTask {
+  const char *name;
+  TaskHandle_t handle;
+  uint32_t stackBytes;
+  bool warned;  // High-water marks never recover, so warn once per task
+};
+
+static HealthTask healthTasks[MAX_HEALTH_TASKS];
+static std::atomic<uint8_t> healthTaskCount{0};
+
+static std::atomic<uint32_t> allocFailures{0};
+static std::atomic<uint32_t> lastFailedAllocBytes{0};
+static uint32_t reportedAllocFailures = 0;
+
+static DoubleBuffer<HealthSample> publishedHealth;
+static uint8_t activeWarnings = 0;
+static uint32_t warningsRaised = 0;
+static unsigned long lastSampleMs = 0;
+
+#ifndef EVERWOOD_NATIVE
+// Runs in the allocating task, possibly inside a critical section, so it
+// only counts; the warning goes out with the next sample
+static void onAllocFailed(size_t size, uint32_t caps, const char *function) {
+  allocFailures.fetch_add(1, std::memory_order_relaxed);
+  lastFailedAllocBytes.store(size, std::memory_order_relaxed);
+}
+#endif
+
+void initHealthMonitor() {
+#ifndef EVERWOOD_NATIVE
+  if (heap_caps_register_failed_alloc_callback(onAllocFailed) != ESP_OK) {
+    Serial.println(F("ERROR: Could not install failed allocation hook"));
+  }
+#endif
+}
+
+void registerHealthTask(const char *name, TaskHandle_t handle,
+                        uint32_t stackBytes) {
+  uint8_t index = healthTaskCount.load();
+  if (index >= MAX_HEALTH_TASKS) {
+    Serial.printf("ERROR: Health task table full, cannot add '%s'\n", name);
+    return;
+  }
+  healthTasks[index] = {name, handle, stackBytes, false};
+  healthTaskCount.store(index + 1);  // Publish after the entry is complete
+}
+
+// Broadcast one warning and log it (threshold 0 = not a threshold warning)
+static void raiseWarning(const char *warning, uint32_t value,
+                         uint32_t threshold, const char *task = nullptr) {
+  warningsRaised++;
+
+  StaticJsonDocument<192> msg;
+  msg["type"] = "healthWarning";
+  msg["componentGroup"] = "system";
+  msg["warning"] = warning;
+  msg["value"] = value;
+  if (threshold) msg["threshold"] = threshold;
+  if (task) msg["task"] = task;
+
+  String out;
+  serializeJson(msg, out);
+  logLine("HEALTH: ", out);
+  broadcastWebSocketMessage(out);
+}
+
+// Raise a warning when a value first drops below its threshold; clear it
+// once the value is back above the threshold plus 1/8, so a value hovering
+// at the limit does not flood clients
+static void checkThreshold(HealthWarning bit, const char *warning,
+                           uint32_t value, uint32_t threshold) {
+  if (value < threshold) {
+    if (!(activeWarnings & bit)) raiseWarning(warning, value, threshold);
+    activeWarnings |= bit;
+  } else if (value >= threshold + threshold / 8) {
+    activeWarnings &= ~bit;
+  }
+}
+
+static void sampleHealth(HealthSample &sample) {
+  sample.freeHeap = ESP.getFreeHeap();
+  sample.minFreeHeap = ESP.getMinFreeHeap();
+  sample.largestFreeBlock = ESP.getMaxAllocHeap();
+  sample.fragmentationPct =
+      sample.freeHeap
+          ? 100 - (uint8_t)((uint64_t)sample.largestFreeBlock * 100 /
+                            sample.freeHeap)
+          : 0;
+
+  HealthThresholds thresholds = healthThresholds.read();
+  checkThreshold(HEALTH_WARN_FREE_HEAP, "freeHeap", sample.freeHeap,
+                 thresholds.minFreeHeapBytes);
+  checkThreshold(HEALTH_WARN_LARGEST_BLOCK, "largestFreeBlock",
+                 sample.largestFreeBlock, thresholds.minLargestBlockBytes);
+
+  sample.taskCount = healthTaskCount.load();
+  for (uint8_t i = 0; i < sample.taskCount; i++) {
+    HealthTask &task = healthTasks[i];
+    if (!task.handle) task.handle = xTaskGetHandle(task.name);
+
+    TaskStackHealth &stack = sample.tasks[i];
+    stack.name = task.name;
+    stack.stackBytes = task.stackBytes;
+    stack.found = task.handle != nullptr;
+    // ESP-IDF reports the high-water mark in bytes
+    stack.minFreeBytes =
+        stack.found ? uxTaskGetStackHighWaterMark(task.handle) : 0;
+
+    if (stack.found && !task.warned &&
+        stack.minFreeBytes < thresholds.minStackFreeBytes) {
+      task.warned = true;
+      activeWarnings |= HEALTH_WARN_STACK;
+      raiseWarning("stack", stack.minFreeBytes, thresholds.minStackFreeBytes,
+                   task.name);
+    }
+  }
+
+  // Raised for the one sample that saw new failures
+  activeWarnings &= ~HEALTH_WARN_ALLOC_FAILED;
+  uint32_t failures = allocFailures.load(std::memory_order_relaxed);
+  if (failures != reportedAllocFailures) {
+    reportedAllocFailures = failures;
+    activeWarnings |= HEALTH_WARN_ALLOC_FAILED;
+    raiseWarning("allocFailed", lastFailedAllocBytes.load(), 0);
+  }
+
+  sample.activeWarnings = activeWarnings;
+  sample.warningsRaised = warningsRaised;
+  sample.allocFailures = failures;
+  sample.lastFailedAllocBytes = lastFailedAllocBytes.load();
+  sample.timestampUs = esp_timer_get_time();
+}
+
+void updateHealthMonitor() {
+  unsigned long now = millis();
+  if (lastSampleMs != 0 && now - lastSampleMs < healthSampleInterval) return;
+  lastSampleMs = now;
+
+  HealthSample sample = {};
+  sampleHealth(sample);
+  publishedHealth.publish(sample);
+}
+
+HealthSample getHealthSample() { return publishedHealth.read(); }
+
+void writeHealth(JsonObject out, const HealthSample &sample) {
+  out["freeHeap"] = sample.freeHeap;
+  out["minFreeHeap"] = sample.minFreeHeap;
+  out["largestFreeBlock"] = sample.largestFreeBlock;
+  out["fragmentationPct"] = sample.fragmentationPct;
+  out["activeWarnings"] = sample.activeWarnings;
+  out["warningsRaised"] = sample.warningsRaised;
+  out["allocFailures"] = sample.allocFailures;
+  if (sample.allocFailures) {
+    out["lastFailedAllocBytes"] = sample.lastFailedAllocBytes;
+  }
+
+  JsonArray stacks = out.createNestedArray("stacks");
+  for (uint8_t i = 0; i < sample.taskCount; i++) {
+    const TaskStackHealth &stack = sample.tasks[i];
+    if (!stack.found) continue;
+    JsonObject item = stacks.createNestedObject();
+    item["task"] = stack.name;
+    item["minFreeBytes"] = stack.minFreeBytes;
+    if (stack.stackBytes) item["stackBytes"] = stack.stackBytes;
+  }
+
+  HealthThresholds current = healthThresholds.read();
+  JsonObject thresholds = out.createNestedObject("thresholds");
+  thresholds["minFreeHeap"] = current.minFreeHeapBytes;
+  thresholds["minLargestBlock"] = current.minLargestBlockBytes;
+  thresholds["minStackFree"] = current.minStackFreeBytes;
+}
@@ -0,0 +1,68 @@
+#ifndef HEALTH_H
+#define HEALTH_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "../config.h"
+
+// --- Heap and Stack Health ---
+// The telemetry task samples free heap, the largest free block, the lowest
+// free heap since boot and every registered task's stack high-water mark
+// each healthSampleInterval, and publishes the sample for other tasks.
+//
+// When a value drops below its threshold in healthThresholds a
+// "healthWarning" message is broadcast once; it is raised again only after
+// the value has recovered. A shrinking largest free block is the warning
+// that comes before an allocation fails. Failed allocations are counted by
+// a heap hook and reported on the next sample.
+
+enum HealthWarning : uint8_t {
+  HEALTH_WARN_FREE_HEAP = 1 << 0,
+  HEALTH_WARN_LARGEST_BLOCK = 1 << 1,
+  HEALTH_WARN_STACK = 1 << 2,
+  HEALTH_WARN_ALLOC_FAILED = 1 << 3
+};
+
+struct TaskStackHealth {
+  const char *name;
+  uint32_t stackBytes;     // 0 if not known (tasks created elsewhere)
+  uint32_t minFreeBytes;   // Stack high-water mark: least headroom seen
+  bool found;              // False until the task exists
+};
+
+struct HealthSample {
+  uint32_t freeHeap;
+  uint32_t minFreeHeap;       // Lowest free heap since boot
+  uint32_t largestFreeBlock;  // Largest single allocation possible
+  uint8_t fragmentationPct;   // 100 - largest block as a share of free heap
+  uint8_t activeWarnings;     // HealthWarning bits currently raised
+  uint32_t warningsRaised;    // healthWarning messages since boot
+  uint32_t allocFailures;     // Failed heap allocations since boot
+  uint32_t lastFailedAllocBytes;
+  uint8_t taskCount;
+  TaskStackHealth tasks[MAX_HEALTH_TASKS];
+  int64_t timestampUs;        // 0 until the first sample
+};
+
+// Install the failed-allocation hook (call early in setup())
+void initHealthMonitor();
+
+// Track a task's stack. A null handle is looked up by name when sampling,
+// for tasks created by libraries (e.g. "async_tcp").
+void registerHealthTask(const char *name, TaskHandle_t handle,
+                        uint32_t stackBytes);
+
+// Sample and raise warnings when healthSampleInterval has elapsed
+// (telemetry task only)
+void updateHealthMonitor();
+
+// Latest published sample (any task)
+HealthSample getHealthSample();
+
+// Write a sample and the active thresholds into a stats reply
+void writeHealth(JsonObject out, const HealthSample &sample);
+
+#endif  // HEALTH_H
@@ -0,0 +1,65 @@
+#include "metrics.h"
+
+#include <freertos/FreeRTOS.h>
+
+static LatencyMetric metrics[MAX_LATENCY_METRICS];
+static uint8_t metricCount = 0;
+static portMUX_TYPE registryMux = portMUX_INITIALIZER_UNLOCKED;
+
+LatencyMetric* registerLatencyMetric(const char* group, const char* name,
+                                     uint32_t budgetUs) {
+  LatencyMetric* metric = nullptr;
+  portENTER_CRITICAL(&registryMux);
+  if (metricCount < MAX_LATENCY_METRICS) metric = &metrics[metricCount++];
+  portEXIT_CRITICAL(&registryMux);
+
+  if (!metric) {
+    Serial.printf("ERROR: Latency metric table full, cannot add '%s'\n", name);
+    return nullptr;
+  }
+  metric->group = group;
+  metric->name = name;
+  metric->budgetCycles = budgetUs * getCpuFrequencyMhz();
+  return metric;
+}
+
+void requestLatencyMetricsReset() {
+  for (uint8_t i = 0; i < metricCount; i++) {
+    metrics[i].resetPending.store(true, std::memory_order_relaxed);
+  }
+}
+
+// Cycles to microseconds, rounded to 0.01 us
+static float cyclesToUs(uint64_t cycles, uint32_t cpuMhz) {
+  return roundf((float)cycles * 100.0f / cpuMhz) / 100.0f;
+}
+
+void writeLatencyMetrics(JsonArray out) {
+  const uint32_t cpuMhz = getCpuFrequencyMhz();
+
+  for (uint8_t i = 0; i < metricCount; i++) {
+    const LatencyMetric& metric = metrics[i];
+    if (!metric.name) continue;  // Registered, name not yet set
+    bool pending = metric.resetPending.load(std::memory_order_relaxed);
+    const LatencyHistogram& h = metric.histogram;
+    uint32_t count = pending ? 0 : h.count();
+
+    JsonObject item = out.createNestedObject();
+    item["group"] = metric.group;
+    item["name"] = metric.name;
+    item["count"] = count;
+    if (count > 0) {
+      item["minUs"] = cyclesToUs(h.min(), cpuMhz);
+      item["meanUs"] = cyclesToUs(h.sum() / count, cpuMhz);
+      item["p50Us"] = cyclesToUs(h.percentile(50), cpuMhz);
+      item["p90Us"] = cyclesToUs(h.percentile(90), cpuMhz);
+      item["p99Us"] = cyclesToUs(h.percentile(99), cpuMhz);
+      item["p999Us"] = cyclesToUs(h.percentile(99.9f), cpuMhz);
+      item["maxUs"] = cyclesToUs(h.max(), cpuMhz);
+    }
+    if (metric.budgetCycles) {
+      item["budgetUs"] = metric.budgetCycles / cpuMhz;
+      item["overBudget"] = pending ? 0 : metric.overBudget;
+    }
+  }
+}
@@ -0,0 +1,67 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <hal/cpu_hal.h>
+
+#include <atomic>
+
+#include "../config.h"
+#include "../util/latency_histogram.h"
+
+// --- Latency Metrics ---
+// Named histograms of CPU cycle counts. Each metric is recorded by a single
+// task (the cycle counter is per core, and every task is pinned). Reads and
+// resets may come from the control task: a reset only raises a flag that
+// the recording task applies on its next sample, and a pending reset reads
+// as empty.
+
+struct LatencyMetric {
+  const char* group;  // "subsystem", "handler" or "io"
+  const char* name;
+  uint32_t budgetCycles;  // 0 = no budget
+  uint32_t overBudget;    // Samples above budgetCycles
+  std::atomic<bool> resetPending{false};
+  LatencyHistogram histogram;
+
+  void record(uint32_t cycles) {
+    if (resetPending.load(std::memory_order_relaxed)) {
+      histogram.reset();
+      overBudget = 0;
+      resetPending.store(false, std::memory_order_relaxed);
+    }
+    histogram.record(cycles);
+    if (budgetCycles && cycles > budgetCycles) overBudget++;
+  }
+};
+
+// Current CPU cycle count of the calling core
+inline uint32_t readCycleCounter() { return cpu_hal_get_cycle_count(); }
+
+// Add a metric (group and name must outlive it, e.g. string literals).
+// Returns nullptr if all MAX_LATENCY_METRICS are in use.
+LatencyMetric* registerLatencyMetric(const char* group, const char* name,
+                                     uint32_t budgetUs = 0);
+
+// Clear every metric (applied by each recording task on its next sample)
+void requestLatencyMetricsReset();
+
+// Append one object per metric: count, min/mean/percentiles/max in us
+void writeLatencyMetrics(JsonArray out);
+
+// Times a scope into a metric (no-op if the metric is null)
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(LatencyMetric* metric)
+      : metric_(metric), start_(readCycleCounter()) {}
+  ~ScopedLatency() {
+    if (metric_) metric_->record(readCycleCounter() - start_);
+  }
+
+ private:
+  LatencyMetric* metric_;
+  uint32_t start_;
+};
+
+#endif  // METRICS_H
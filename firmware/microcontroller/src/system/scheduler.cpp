@@ -0,0 +1,151 @@
+#include "scheduler.h"
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "metrics.h"
+
+struct Subsystem {
+  SubsystemFunction run;
+  uint16_t divider;    // Ticks between runs
+  uint16_t countdown;  // Ticks until the next run
+  LatencyMetric* latency;
+  uint64_t totalCycles;  // Kept in cycles so sub-microsecond runs add up
+};
+
+static Subsystem subsystems[MAX_SUBSYSTEMS];
+static SchedulerStats stats = {};
+static esp_timer_handle_t tickTimer = nullptr;
+static TaskHandle_t schedulerTask = nullptr;
+static LatencyMetric* tickLatency = nullptr;
+
+// Runs on the esp_timer task; only wakes the scheduler
+static void onTick(void* arg) { xTaskNotifyGive(schedulerTask); }
+
+bool registerSubsystem(const SubsystemSpec& spec, SubsystemFunction run) {
+  if (stats.subsystemCount >= MAX_SUBSYSTEMS) {
+    Serial.printf("ERROR: Subsystem table full, cannot add '%s'\n", spec.name);
+    return false;
+  }
+  if (spec.rateHz == 0 || spec.rateHz > controlTickHz ||
+      controlTickHz % spec.rateHz != 0) {
+    Serial.printf("ERROR: Subsystem '%s' rate %u Hz does not divide the %u Hz "
+                  "tick\n",
+                  spec.name, spec.rateHz, controlTickHz);
+    return false;
+  }
+
+  uint8_t index = stats.subsystemCount++;
+  Subsystem& subsystem = subsystems[index];
+  subsystem.run = run;
+  subsystem.divider = controlTickHz / spec.rateHz;
+  // Stagger slower subsystems so they do not all land on the same tick
+  subsystem.countdown = index % subsystem.divider + 1;
+  subsystem.latency =
+      registerLatencyMetric("subsystem", spec.name, spec.budgetUs);
+
+  SubsystemStats& entry = stats.subsystems[index];
+  entry = {};
+  entry.name = spec.name;
+  entry.rateHz = spec.rateHz;
+  entry.budgetUs = spec.budgetUs;
+  return true;
+}
+
+bool startScheduler() {
+  schedulerTask = xTaskGetCurrentTaskHandle();
+  tickLatency =
+      registerLatencyMetric("subsystem", "tick", 1000000 / controlTickHz);
+
+  esp_timer_create_args_t args = {};
+  args.callback = onTick;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "control_tick";
+  args.skip_unhandled_events = true;
+  if (esp_timer_create(&args, &tickTimer) != ESP_OK ||
+      esp_timer_start_periodic(tickTimer, 1000000 / controlTickHz) != ESP_OK) {
+    Serial.println(F("ERROR: Could not start control tick timer"));
+    return false;
+  }
+
+  Serial.printf("Scheduler: %u Hz tick, %u subsystems\n", controlTickHz,
+                stats.subsystemCount);
+  for (uint8_t i = 0; i < stats.subsystemCount; i++) {
+    Serial.printf("  %-10s %5u Hz, budget %u us\n", stats.subsystems[i].name,
+                  stats.subsystems[i].rateHz, stats.subsystems[i].budgetUs);
+  }
+  return true;
+}
+
+void runScheduler() {
+  const uint32_t tickPeriodUs = 1000000 / controlTickHz;
+  const uint32_t cpuMhz = getCpuFrequencyMhz();
+  int64_t windowStartUs = esp_timer_get_time();
+  uint64_t busyCycles = 0;
+
+  for (;;) {
+    uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (pending > 1) stats.missedTicks += pending - 1;
+
+    int64_t nowUs = esp_timer_get_time();
+    if (nowUs - windowStartUs >= (int64_t)telemetryInterval * 1000) {
+      windowStartUs = nowUs;
+      stats.maxTickUs = 0;
+      for (uint8_t i = 0; i < stats.subsystemCount; i++) {
+        stats.subsystems[i].maxUs = 0;
+      }
+    }
+
+    // Timed with the cycle counter: one register read per measurement
+    const uint32_t tickStart = readCycleCounter();
+    uint32_t runStart = tickStart;
+    for (uint8_t i = 0; i < stats.subsystemCount; i++) {
+      Subsystem& subsystem = subsystems[i];
+      if (--subsystem.countdown != 0) continue;
+      subsystem.countdown = subsystem.divider;
+
+      subsystem.run();
+
+      uint32_t runEnd = readCycleCounter();
+      uint32_t elapsedCycles = runEnd - runStart;
+      uint32_t elapsedUs = elapsedCycles / cpuMhz;
+      runStart = runEnd;
+      if (subsystem.latency) subsystem.latency->record(elapsedCycles);
+
+      SubsystemStats& entry = stats.subsystems[i];
+      entry.runs++;
+      entry.lastUs = elapsedUs;
+      subsystem.totalCycles += elapsedCycles;
+      entry.totalUs = subsystem.totalCycles / cpuMhz;
+      if (elapsedUs > entry.maxUs) entry.maxUs = elapsedUs;
+      if (elapsedUs > entry.budgetUs) entry.overBudget++;
+    }
+
+    uint32_t tickCycles = runStart - tickStart;
+    uint32_t tickUs = tickCycles / cpuMhz;
+    if (tickLatency) tickLatency->record(tickCycles);
+    stats.ticks++;
+    stats.lastTickUs = tickUs;
+    busyCycles += tickCycles;
+    stats.busyUs = busyCycles / cpuMhz;
+    if (tickUs > stats.maxTickUs) stats.maxTickUs = tickUs;
+    if (tickUs > tickPeriodUs) stats.overruns++;
+  }
+}
+
+void resetSchedulerStats() {
+  stats.overruns = 0;
+  stats.missedTicks = 0;
+  stats.maxTickUs = 0;
+  for (uint8_t i = 0; i < stats.subsystemCount; i++) {
+    SubsystemStats& entry = stats.subsystems[i];
+    entry.runs = 0;
+    entry.maxUs = 0;
+    entry.overBudget = 0;
+    entry.totalUs = 0;
+    subsystems[i].totalCycles = 0;
+  }
+}
+
+const SchedulerStats& getSchedulerStats() { return stats; }
@@ -0,0 +1,63 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#include "../config.h"
+
+// --- Control Tick Scheduler ---
+// A periodic esp_timer at controlTickHz notifies the control task, which
+// blocks on the notification between ticks so the core idles (and the idle
+// time is available to the rest of the system). Each tick runs the
+// subsystems that are due, in registration order, at their declared rate.
+//
+// Every run is timed with the CPU cycle counter and recorded in a latency
+// histogram (system/metrics.h) as well as the counters below:
+// - a run longer than its budgetUs counts as over budget
+// - a tick whose work exceeds the tick period counts as an overrun
+// - timer ticks that fire while a tick is still running are counted as
+//   missed; the due subsystems then run once for the coalesced ticks
+
+typedef void (*SubsystemFunction)();
+
+struct SubsystemStats {
+  const char* name;
+  uint16_t rateHz;
+  uint32_t budgetUs;
+  uint32_t runs;
+  uint32_t lastUs;
+  uint32_t maxUs;       // Longest run in the current telemetry interval
+  uint32_t overBudget;  // Runs longer than budgetUs
+  uint64_t totalUs;     // Cumulative run time
+};
+
+struct SchedulerStats {
+  uint32_t ticks;
+  uint32_t overruns;     // Ticks longer than the tick period
+  uint32_t missedTicks;  // Timer ticks coalesced into a later tick
+  uint32_t lastTickUs;
+  uint32_t maxTickUs;  // Longest tick in the current telemetry interval
+  uint64_t busyUs;     // Cumulative time spent running subsystems
+  uint8_t subsystemCount;
+  SubsystemStats subsystems[MAX_SUBSYSTEMS];
+};
+
+// Add a subsystem (before startScheduler). Returns false if the table is
+// full or the rate does not divide controlTickHz.
+bool registerSubsystem(const SubsystemSpec& spec, SubsystemFunction run);
+
+// Start the tick timer, notifying the calling task. Returns false if the
+// timer could not be created.
+bool startScheduler();
+
+// Run ticks forever (call from the task that called startScheduler)
+void runScheduler();
+
+// Current statistics (control task only; other tasks read the snapshot)
+const SchedulerStats& getSchedulerStats();
+
+// Clear overrun, missed tick and per-subsystem counters (control task only).
+// ticks and busyUs keep counting so load can still be derived from deltas.
+void resetSchedulerStats();
+
+#endif  // SCHEDULER_H
@@ -0,0 +1,140 @@
+#include "state_snapshot.h"
+
+static const uint32_t FNV_OFFSET = 2166136261u;
+
+static uint32_t hashBytes(uint32_t hash, const void* data, size_t len) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < len; i++) hash = (hash ^ bytes[i]) * 16777619u;
+  return hash;
+}
+
+template <typename T>
+static uint32_t hashValue(uint32_t hash, const T& value) {
+  return hashBytes(hash, &value, sizeof(value));
+}
+
+template <size_t N>
+static uint32_t hashText(uint32_t hash, const FixedString<N>& text) {
+  // Include the terminator so "ab"+"c" and "a"+"bc" differ
+  return hashBytes(hash, text.c_str(), text.length() + 1);
+}
+
+// FNV-1a over every configured field of one component (runtime state such
+// as positions, values and allocated channels is left out)
+uint32_t hashPinConfig(const IoPinConfig& pin) {
+  uint32_t hash = hashText(FNV_OFFSET, pin.id);
+  hash = hashText(hash, pin.name);
+  hash = hashValue(hash, pin.pin);
+  hash = hashText(hash, pin.pinType);
+  hash = hashText(hash, pin.mode);
+  hash = hashValue(hash, pin.pullMode);
+  hash = hashValue(hash, pin.debounceMs);
+  hash = hashValue(hash, pin.useInterrupt);
+  hash = hashValue(hash, pin.adcOversample);
+  hash = hashValue(hash, pin.adcFilter);
+  hash = hashValue(hash, pin.adcFilterWindow);
+  hash = hashValue(hash, pin.adcDeadband);
+  hash = hashValue(hash, pin.adcReportIntervalMs);
+  hash = hashValue(hash, pin.counterEdge);
+  hash = hashValue(hash, pin.counterGlitchFilterNs);
+  hash = hashValue(hash, pin.counterReportIntervalMs);
+  hash = hashValue(hash, pin.pwmFrequency);
+  return hashValue(hash, pin.pwmResolution);
+}
+
+uint32_t hashServoConfig(const ServoConfig& servo) {
+  uint32_t hash = hashText(FNV_OFFSET, servo.id);
+  hash = hashText(hash, servo.name);
+  hash = hashValue(hash, servo.pin);
+  hash = hashValue(hash, servo.minAngle);
+  hash = hashValue(hash, servo.maxAngle);
+  hash = hashValue(hash, servo.minPulseWidth);
+  return hashValue(hash, servo.maxPulseWidth);
+}
+
+uint32_t hashStepperConfig(const StepperConfig& stepper) {
+  uint32_t hash = hashText(FNV_OFFSET, stepper.id);
+  hash = hashText(hash, stepper.name);
+  hash = hashValue(hash, stepper.pulPin);
+  hash = hashValue(hash, stepper.dirPin);
+  hash = hashValue(hash, stepper.enaPin);
+  hash = hashValue(hash, stepper.minPosition);
+  hash = hashValue(hash, stepper.maxPosition);
+  hash = hashValue(hash, stepper.maxSpeed);
+  hash = hashValue(hash, stepper.acceleration);
+  hash = hashValue(hash, stepper.stepsPerInch);
+  hash = hashText(hash, stepper.homeSensorId);
+  hash = hashValue(hash, stepper.homingDirection);
+  hash = hashValue(hash, stepper.homingSpeed);
+  hash = hashValue(hash, stepper.homeSensorPinActiveState);
+  return hashValue(hash, stepper.homePositionOffset);
+}
+
+// Combined hash of every configured component
+uint32_t hashConfiguration() {
+  uint32_t hash = FNV_OFFSET;
+  for (const auto& pin : configuredPins) {
+    hash = hashValue(hash, hashPinConfig(pin));
+  }
+  for (const auto& stepper : configuredSteppers) {
+    hash = hashValue(hash, hashStepperConfig(stepper));
+  }
+  for (const auto& servo : configuredServos) {
+    hash = hashValue(hash, hashServoConfig(servo));
+  }
+  return hash;
+}
+
+// Strings are stored as pointers into the component pools, so only the
+// JSON nodes count towards the capacity
+size_t stateSnapshotCapacity() {
+  return JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(configuredSteppers.size()) +
+         configuredSteppers.size() * JSON_OBJECT_SIZE(7) +
+         JSON_ARRAY_SIZE(configuredServos.size()) +
+         configuredServos.size() * JSON_OBJECT_SIZE(6) +
+         JSON_ARRAY_SIZE(configuredPins.size()) +
+         configuredPins.size() * JSON_OBJECT_SIZE(6);
+}
+
+// Fill "configHash", "steppers", "servos" and "pins" into out. Optional
+// fields ("pending", "homing") are left out when not set.
+void writeStateSnapshot(JsonObject out) {
+  out["configHash"] = hashConfiguration();
+
+  JsonArray steppers = out.createNestedArray("steppers");
+  for (const auto& config : configuredSteppers) {
+    JsonObject stepper = steppers.createNestedObject();
+    stepper["id"] = config.id.c_str();
+    stepper["cfg"] = hashStepperConfig(config);
+    stepper["position"] = config.currentPosition;
+    stepper["target"] = config.targetPosition;
+    stepper["homed"] = config.isHomed;
+    if (config.isHoming) stepper["homing"] = true;
+    if (config.isActionPending || !config.pendingCommandId.isEmpty()) {
+      stepper["pending"] = config.pendingCommandId.c_str();
+    }
+  }
+
+  JsonArray servos = out.createNestedArray("servos");
+  for (const auto& config : configuredServos) {
+    JsonObject servo = servos.createNestedObject();
+    servo["id"] = config.id.c_str();
+    servo["cfg"] = hashServoConfig(config);
+    servo["angle"] = config.currentAngle;
+    servo["target"] = config.targetAngle;
+    if (config.isActionPending || !config.pendingCommandId.isEmpty()) {
+      servo["pending"] = config.pendingCommandId.c_str();
+    }
+  }
+
+  JsonArray pins = out.createNestedArray("pins");
+  for (const auto& config : configuredPins) {
+    JsonObject pin = pins.createNestedObject();
+    pin["id"] = config.id.c_str();
+    pin["cfg"] = hashPinConfig(config);
+    pin["pin"] = config.pin;
+    pin["type"] = config.pinType.c_str();
+    pin["mode"] = config.mode.c_str();
+    pin["value"] = config.lastValue;
+  }
+}
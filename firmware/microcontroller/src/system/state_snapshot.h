@@ -0,0 +1,29 @@
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include <ArduinoJson.h>
+
+#include "../config.h"
+
+// --- Component State Snapshot ---
+// Everything a UI needs to redraw after connecting: per component a hash of
+// its configuration plus its live state (positions, angles, pin values,
+// homed flags and the commandId of a pending action). Sent to each client
+// when it connects and in reply to the system "getState" action. Control
+// task only: it reads the component pools directly.
+
+// FNV-1a over one component's configuration
+uint32_t hashPinConfig(const IoPinConfig& pin);
+uint32_t hashServoConfig(const ServoConfig& servo);
+uint32_t hashStepperConfig(const StepperConfig& stepper);
+
+// Combined hash of every configured component (also advertised over mDNS)
+uint32_t hashConfiguration();
+
+// Document capacity writeStateSnapshot needs for the current components
+size_t stateSnapshotCapacity();
+
+// Fill "configHash", "steppers", "servos" and "pins" into out
+void writeStateSnapshot(JsonObject out);
+
+#endif  // STATE_SNAPSHOT_H
@@ -0,0 +1,582 @@
+#include "tasks.h"
+
+#include <ArduinoJson.h>
+#include <AsyncWebSocket.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#include <cstdarg>
+
+#include "../hal/hal_transport.h"
+#include "../hardware/io_pin.h"
+#include "../hardware/servo.h"
+#include "../hardware/stepper.h"
+#include "../message_handler.h"
+#include "../network/discovery.h"
+#include "../network/udp_transport.h"
+#include "../network/wifi_manager.h"
+#include "../util/double_buffer.h"
+#include "../util/ring_buffer.h"
+#include "counters.h"
+#include "health.h"
+#include "metrics.h"
+#include "state_snapshot.h"
+#include "trace.h"
+
+// Commands handled per run, so a burst cannot starve the other subsystems
+static const uint8_t MAX_COMMANDS_PER_CYCLE = 4;
+static const uint8_t MAX_DELIVERIES_PER_PASS = 16;
+static const unsigned long CLIENT_CLEANUP_INTERVAL = 1000;
+static const unsigned long TELEMETRY_POLL_MS = 50;  // Trace dump latency
+
+struct InboundCommand {
+  uint32_t clientId;
+  uint32_t sequence;  // Arrival order across the /ws lanes
+  uint16_t length;    // 0 = cancelled while queued
+  char text[INBOUND_COMMAND_MAX_BYTES + 1];
+};
+
+struct OutboundMessage {
+  uint32_t clientId = 0;  // 0 = broadcast
+  bool binary = false;
+  String text;
+  std::vector<uint8_t> payload;
+};
+
+struct LogEntry {
+  char text[LOG_LINE_MAX_BYTES];
+};
+
+typedef SpscRing<OutboundMessage, OUTBOUND_MESSAGE_QUEUE_SIZE> OutboundQueue;
+typedef SpscRing<LogEntry, LOG_QUEUE_SIZE> LogQueue;
+
+static TaskHandle_t controlTaskHandle = nullptr;
+static TaskHandle_t networkTaskHandle = nullptr;
+static TaskHandle_t telemetryTaskHandle = nullptr;
+static TaskHandle_t loggingTaskHandle = nullptr;
+
+// AsyncTCP -> control
+static SpscRing<InboundCommand, INBOUND_COMMAND_QUEUE_SIZE> inboundCommands;
+static SpscRing<InboundCommand, PRIORITY_COMMAND_QUEUE_SIZE> priorityCommands;
+static InboundCommand inboundStaging;  // Producer side (AsyncTCP task)
+static InboundCommand inboundCurrent;  // Consumer side (control task)
+static uint32_t inboundSequence = 0;   // Producer side (AsyncTCP task)
+static bool handlingPriority = false;  // Control task: replies jump the queue
+
+// AsyncUDP -> control
+static SpscRing<InboundCommand, UDP_COMMAND_QUEUE_SIZE> udpCommands;
+static InboundCommand udpStaging;  // Producer side (AsyncUDP task)
+
+// control / telemetry -> network
+static SpscRing<OutboundMessage, PRIORITY_OUTBOUND_QUEUE_SIZE>
+    priorityOutbound;  // Control task only
+static OutboundQueue controlOutbound;
+static OutboundQueue telemetryOutbound;
+
+// Client state published by the network task for tasks that must not touch
+// client objects
+static std::atomic<bool> telemetryWritable{false};
+static std::atomic<uint32_t> connectedClients{0};
+
+// control / network / telemetry -> logging
+static LogQueue controlLog;
+static LogQueue networkLog;
+static LogQueue telemetryLog;
+
+static DoubleBuffer<ControlSnapshot> controlSnapshot;
+
+static LatencyMetric *deliverLatency = nullptr;  // Network task
+static LatencyMetric *serialLatency = nullptr;   // Logging task
+
+bool isControlTask() {
+  return controlTaskHandle &&
+         xTaskGetCurrentTaskHandle() == controlTaskHandle;
+}
+
+// Control task messages take the priority ring while a priority command
+// is being handled or when they go to a /ws/control client or UDP peer
+static bool pushOutbound(OutboundMessage &&message) {
+  TaskHandle_t current = xTaskGetCurrentTaskHandle();
+  if (current == nullptr) return false;
+  if (current == controlTaskHandle) {
+    TransportEndpoint endpoint = transportEndpoint(message.clientId);
+    bool priority = handlingPriority ||
+                    (message.clientId != 0 && (endpoint == ENDPOINT_CONTROL ||
+                                               endpoint == ENDPOINT_UDP));
+    if (priority) {
+      priorityOutbound.push(std::move(message));
+    } else {
+      controlOutbound.push(std::move(message));
+    }
+    return true;
+  }
+  if (current == telemetryTaskHandle) {
+    telemetryOutbound.push(std::move(message));
+    return true;
+  }
+  return false;
+}
+
+static LogQueue *logQueueForCurrentTask() {
+  TaskHandle_t current = xTaskGetCurrentTaskHandle();
+  if (current == nullptr) return nullptr;
+  if (current == controlTaskHandle) return &controlLog;
+  if (current == networkTaskHandle) return &networkLog;
+  if (current == telemetryTaskHandle) return &telemetryLog;
+  return nullptr;
+}
+
+// Copy the top-level string value of key in a JSON object into out,
+// scanning instead of parsing (this runs on the AsyncTCP task for every
+// frame). Strings and nested objects and arrays are skipped, so ids, names
+// and values that happen to read "stop" do not match. Returns false if there
+// is no such string value or it does not fit.
+static bool findTopLevelString(const char *json, const char *key, char *out,
+                               size_t size) {
+  size_t keyLength = strlen(key);
+  uint8_t depth = 0;
+  bool expectKey = false;    // Next string at depth 1 is a key
+  bool keyMatched = false;   // The last key at depth 1 was key
+  for (const char *p = json; *p; p++) {
+    char c = *p;
+    if (c == '"') {
+      const char *start = p + 1;
+      const char *end = start;
+      while (*end && *end != '"') end += (*end == '\\' && end[1]) ? 2 : 1;
+      if (!*end) return false;
+      size_t len = end - start;
+      if (depth == 1 && expectKey) {
+        keyMatched = len == keyLength && memcmp(start, key, len) == 0;
+        expectKey = false;
+      } else if (depth == 1 && keyMatched) {
+        if (len >= size) return false;
+        memcpy(out, start, len);
+        out[len] = 0;
+        return true;
+      }
+      p = end;
+    } else if (c == '{' || c == '[') {
+      depth++;
+      expectKey = depth == 1 && c == '{';
+    } else if (c == '}' || c == ']') {
+      if (depth > 0) depth--;
+    } else if (c == ',' && depth == 1) {
+      expectKey = true;
+      keyMatched = false;
+    }
+  }
+  return false;
+}
+
+// Stepper "stop" commands ({"action":"control","command":"stop"}) and the
+// system "estop" action
+static bool isStopCommand(const char *text) {
+  char action[8];
+  if (!findTopLevelString(text, "action", action, sizeof(action))) {
+    return false;
+  }
+  if (strcmp(action, "stop") == 0 || strcmp(action, "estop") == 0) {
+    return true;
+  }
+  char command[8];
+  return strcmp(action, "control") == 0 &&
+         findTopLevelString(text, "command", command, sizeof(command)) &&
+         strcmp(command, "stop") == 0;
+}
+
+bool postInboundCommand(uint32_t clientId, const uint8_t *data, size_t len) {
+  if (len > INBOUND_COMMAND_MAX_BYTES) return false;
+  inboundStaging.clientId = clientId;
+  inboundStaging.sequence = inboundSequence++;
+  inboundStaging.length = (uint16_t)len;
+  memcpy(inboundStaging.text, data, len);
+  inboundStaging.text[len] = 0;
+  traceInstant(TRACE_WS_RECEIVE, traceCommandIdInText(inboundStaging.text));
+  if (transportEndpoint(clientId) == ENDPOINT_CONTROL ||
+      isStopCommand(inboundStaging.text)) {
+    return priorityCommands.push(inboundStaging);
+  }
+  return inboundCommands.push(inboundStaging);
+}
+
+bool postUdpCommand(uint32_t address, const uint8_t *data, size_t len) {
+  if (len > INBOUND_COMMAND_MAX_BYTES) return false;
+  udpStaging.clientId = address;
+  udpStaging.length = (uint16_t)len;
+  memcpy(udpStaging.text, data, len);
+  udpStaging.text[len] = 0;
+  traceInstant(TRACE_WS_RECEIVE, traceCommandIdInText(udpStaging.text));
+  return udpCommands.push(udpStaging);
+}
+
+bool postOutboundText(uint32_t clientId, const String &text) {
+  OutboundMessage message;
+  message.clientId = clientId;
+  message.text = text;
+  return pushOutbound(std::move(message));
+}
+
+bool postOutboundBinary(uint32_t clientId, std::vector<uint8_t> &&payload) {
+  OutboundMessage message;
+  message.clientId = clientId;
+  message.binary = true;
+  message.payload = std::move(payload);
+  return pushOutbound(std::move(message));
+}
+
+void logLine(const char *prefix, const String &text) {
+  LogQueue *queue = logQueueForCurrentTask();
+  if (!queue) {
+    Serial.print(prefix);
+    Serial.println(text);
+    return;
+  }
+
+  LogEntry entry;
+  int written = snprintf(entry.text, sizeof(entry.text), "%s%s", prefix,
+                         text.c_str());
+  if (written >= (int)sizeof(entry.text)) {
+    memcpy(entry.text + sizeof(entry.text) - 4, "...", 4);
+  }
+  queue->push(entry);
+}
+
+void logPrintf(const char *format, ...) {
+  LogEntry entry;
+  va_list args;
+  va_start(args, format);
+  int written = vsnprintf(entry.text, sizeof(entry.text), format, args);
+  va_end(args);
+  if (written >= (int)sizeof(entry.text)) {
+    memcpy(entry.text + sizeof(entry.text) - 4, "...", 4);
+  }
+  size_t length = strlen(entry.text);
+  if (length > 0 && entry.text[length - 1] == '\n') {
+    entry.text[length - 1] = '\0';
+  }
+
+  LogQueue *queue = logQueueForCurrentTask();
+  if (!queue) {
+    Serial.println(entry.text);
+    return;
+  }
+  queue->push(entry);
+}
+
+ControlSnapshot getControlSnapshot() { return controlSnapshot.read(); }
+
+bool isTelemetryWritable() { return telemetryWritable.load(); }
+
+uint32_t getConnectedClientCount() { return connectedClients.load(); }
+
+QueueDepths getQueueDepths() {
+  QueueDepths depths;
+  depths.inbound = inboundCommands.size() + priorityCommands.size() +
+                   udpCommands.size();
+  depths.outbound = priorityOutbound.size() + controlOutbound.size() +
+                    telemetryOutbound.size();
+  depths.log = controlLog.size() + networkLog.size() + telemetryLog.size();
+  return depths;
+}
+
+// --- Control task ---
+
+// Handlers get the sender's address only; the client may disconnect while
+// the command runs, and replies to it are then dropped by the network task
+static void runInboundCommand() {
+  if (inboundCurrent.length == 0) return;  // Cancelled by a stop
+  handleWebSocketCommand(inboundCurrent.clientId, inboundCurrent.text);
+}
+
+// A stepper stop on the priority lane overtakes move, step and home commands
+// still queued for the same stepper; left alone they would run after the
+// stop. Cancel those that arrived before it and tell their senders.
+static void cancelMotionBeforeStop(const InboundCommand &stop) {
+  char group[16];
+  char id[COMPONENT_ID_MAX_CHARS + 1];
+  char command[8];
+  if (!findTopLevelString(stop.text, "componentGroup", group,
+                          sizeof(group)) ||
+      strcmp(group, "steppers") != 0 ||
+      !findTopLevelString(stop.text, "command", command, sizeof(command)) ||
+      strcmp(command, "stop") != 0 ||
+      !findTopLevelString(stop.text, "id", id, sizeof(id))) {
+    return;
+  }
+
+  inboundCommands.forEachQueued([&](InboundCommand &queued) {
+    if (queued.length == 0) return;
+    if ((int32_t)(queued.sequence - stop.sequence) > 0) return;
+    char queuedValue[COMPONENT_ID_MAX_CHARS + 1];
+    if (!findTopLevelString(queued.text, "componentGroup", queuedValue,
+                            sizeof(queuedValue)) ||
+        strcmp(queuedValue, "steppers") != 0 ||
+        !findTopLevelString(queued.text, "id", queuedValue,
+                            sizeof(queuedValue)) ||
+        strcmp(queuedValue, id) != 0 ||
+        !findTopLevelString(queued.text, "command", command,
+                            sizeof(command))) {
+      return;
+    }
+    if (strcmp(command, "move") != 0 && strcmp(command, "step") != 0 &&
+        strcmp(command, "home") != 0) {
+      return;
+    }
+    queued.length = 0;
+    char reply[96];
+    snprintf(reply, sizeof(reply), "ERROR: Stepper %s %s cancelled by stop",
+             id, command);
+    sendWebSocketMessage(queued.clientId, reply);
+  });
+}
+
+// Every tick, before anything else: the lanes hold at most a few commands
+static void processPriorityCommands() {
+  handlingPriority = true;
+  while (priorityCommands.pop(inboundCurrent)) {
+    cancelMotionBeforeStop(inboundCurrent);
+    runInboundCommand();
+  }
+  while (udpCommands.pop(inboundCurrent)) runInboundCommand();
+  handlingPriority = false;
+}
+
+static void processInboundCommands() {
+  for (uint8_t i = 0; i < MAX_COMMANDS_PER_CYCLE; i++) {
+    if (!inboundCommands.pop(inboundCurrent)) return;
+    runInboundCommand();
+  }
+}
+
+// inboundCurrent holds the estop being handled, so nothing is popped. The
+// priority and UDP lanes are drained too: a command queued there behind the
+// estop would otherwise run later in this same tick.
+uint32_t discardQueuedCommands() {
+  return inboundCommands.discard() + priorityCommands.discard() +
+         udpCommands.discard();
+}
+
+static void addAxis(ControlSnapshot &snapshot, const ComponentId &id,
+                    bool stepper,
+                    uint64_t steps, uint32_t movesCompleted) {
+  if (snapshot.axisCount >= MAX_SNAPSHOT_AXES) return;
+  AxisCounters &axis = snapshot.axes[snapshot.axisCount++];
+  axis.id = id;
+  axis.stepper = stepper;
+  axis.steps = steps;
+  axis.movesCompleted = movesCompleted;
+}
+
+static void publishSnapshot() {
+  ControlSnapshot snapshot;
+  snapshot.scheduler = getSchedulerStats();
+  snapshot.axisCount = 0;
+  for (const auto &stepper : configuredSteppers) {
+    addAxis(snapshot, stepper.id, true, stepper.stepsGenerated,
+            stepper.movesCompleted);
+  }
+  for (const auto &servo : configuredServos) {
+    addAxis(snapshot, servo.id, false, 0, servo.movesCompleted);
+  }
+  snapshot.inboundDropped = inboundCommands.dropped() +
+                            priorityCommands.dropped() + udpCommands.dropped();
+  snapshot.outboundDropped = priorityOutbound.dropped() +
+                             controlOutbound.dropped() +
+                             telemetryOutbound.dropped();
+  snapshot.logDropped =
+      controlLog.dropped() + networkLog.dropped() + telemetryLog.dropped();
+  snapshot.configHash = hashConfiguration();
+  snapshot.timestampUs = esp_timer_get_time();
+  controlSnapshot.publish(snapshot);
+}
+
+static void controlTask(void *arg) {
+  // Registration order is run order within a tick
+  registerSubsystem(prioritySubsystem, processPriorityCommands);
+  registerSubsystem(limitsSubsystem, updateStepperLimits);
+  registerSubsystem(commandsSubsystem, processInboundCommands);
+  registerSubsystem(pinsSubsystem, updatePinValues);
+  registerSubsystem(steppersSubsystem, updateStepperPositions);
+  registerSubsystem(servosSubsystem, updateServoActionStatus);
+  registerSubsystem(snapshotSubsystem, publishSnapshot);
+
+  if (!startScheduler()) {
+    vTaskDelete(NULL);
+    return;
+  }
+  runScheduler();
+}
+
+// --- Network task ---
+
+static void deliverOutbound(OutboundMessage &message) {
+  if (message.binary) {
+    incrementCounter(protocolCounters.messagesOut[GROUP_BINARY]);
+    incrementCounter(protocolCounters.bytesOut, message.payload.size());
+    transportSendBinary(message.clientId, message.payload.data(),
+                        message.payload.size());
+    return;
+  }
+
+  MessageGroup group = messageGroupInText(message.text.c_str());
+  incrementCounter(protocolCounters.messagesOut[group]);
+  incrementCounter(protocolCounters.bytesOut, message.text.length());
+  logLine(transportSocketId(message.clientId) == 0 ? "WS_BROADCAST: "
+                                                   : "WS_OUT: ",
+          message.text);
+  transportSendText(message.clientId, message.text);
+}
+
+static void networkTask(void *arg) {
+  OutboundMessage message;
+  unsigned long lastCleanup = 0;
+
+  for (;;) {
+    uint8_t delivered = 0;
+    while (delivered < MAX_DELIVERIES_PER_PASS &&
+           (priorityOutbound.pop(message) || controlOutbound.pop(message) ||
+            telemetryOutbound.pop(message))) {
+      {
+        ScopedLatency timer(deliverLatency);
+        uint32_t startUs = traceNow();
+        deliverOutbound(message);
+        uint32_t commandHash =
+            message.binary ? 0 : traceCommandIdInText(message.text.c_str());
+        traceSpan(TRACE_WS_DELIVER, startUs, commandHash);
+      }
+      delivered++;
+    }
+
+    // Cheap unless a WiFi event or retry is due; runs every pass so a
+    // reconnect starts within a tick of the link dropping
+    updateWiFiStatus();
+
+    // UDP reply resends are due within tens of milliseconds
+    updateUdpTransport();
+
+    telemetryWritable.store(
+        transportBroadcastReady(TRANSPORT_TELEMETRY_BROADCAST));
+    connectedClients.store(transportClientCount());
+
+    unsigned long now = millis();
+    if (now - lastCleanup >= CLIENT_CLEANUP_INTERVAL) {
+      lastCleanup = now;
+      ws.cleanupClients();
+      wsControl.cleanupClients();
+      wsTelemetry.cleanupClients();
+      updateDiscovery();
+    }
+
+    // Keep going while busy, otherwise yield a tick
+    if (delivered < MAX_DELIVERIES_PER_PASS) vTaskDelay(1);
+  }
+}
+
+// --- Telemetry task ---
+
+static void telemetryTask(void *arg) {
+  uint64_t lastBusyUs = 0;
+  int64_t lastTimestampUs = 0;
+  unsigned long lastBroadcast = millis();
+
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(TELEMETRY_POLL_MS));
+    serviceTraceDump();
+    updateHealthMonitor();
+
+    unsigned long now = millis();
+    if (now - lastBroadcast < telemetryInterval) continue;
+    lastBroadcast = now;
+
+    ControlSnapshot snapshot = getControlSnapshot();
+    const SchedulerStats &stats = snapshot.scheduler;
+
+    // Share of core 1 spent in control ticks since the previous broadcast
+    float loadPct = 0;
+    if (lastTimestampUs != 0 && snapshot.timestampUs > lastTimestampUs) {
+      loadPct = 100.0f * (float)(stats.busyUs - lastBusyUs) /
+                (float)(snapshot.timestampUs - lastTimestampUs);
+    }
+    lastBusyUs = stats.busyUs;
+    lastTimestampUs = snapshot.timestampUs;
+
+    if (getConnectedClientCount() == 0) continue;
+
+    StaticJsonDocument<1536> msg;
+    msg["type"] = "controlStatus";
+    msg["componentGroup"] = "system";
+    msg["tickHz"] = controlTickHz;
+    msg["ticks"] = stats.ticks;
+    msg["lastTickUs"] = stats.lastTickUs;
+    msg["maxTickUs"] = stats.maxTickUs;
+    msg["overruns"] = stats.overruns;
+    msg["missedTicks"] = stats.missedTicks;
+    msg["loadPct"] = roundf(loadPct * 10) / 10;
+    msg["inboundDropped"] = snapshot.inboundDropped;
+    msg["outboundDropped"] = snapshot.outboundDropped;
+    msg["logDropped"] = snapshot.logDropped;
+
+    JsonArray subsystems = msg.createNestedArray("subsystems");
+    for (uint8_t i = 0; i < stats.subsystemCount; i++) {
+      const SubsystemStats &entry = stats.subsystems[i];
+      JsonObject item = subsystems.createNestedObject();
+      item["name"] = entry.name;
+      item["rateHz"] = entry.rateHz;
+      item["budgetUs"] = entry.budgetUs;
+      item["runs"] = entry.runs;
+      item["maxUs"] = entry.maxUs;
+      item["avgUs"] = entry.runs ? (uint32_t)(entry.totalUs / entry.runs) : 0;
+      item["overBudget"] = entry.overBudget;
+    }
+
+    String out;
+    serializeJson(msg, out);
+    broadcastTelemetryMessage(out);
+  }
+}
+
+// --- Logging task ---
+
+static void loggingTask(void *arg) {
+  LogEntry entry;
+  for (;;) {
+    bool printed = false;
+    while (controlLog.pop(entry) || networkLog.pop(entry) ||
+           telemetryLog.pop(entry)) {
+      {
+        ScopedLatency timer(serialLatency);
+        Serial.println(entry.text);
+      }
+      printed = true;
+    }
+    if (!printed) vTaskDelay(pdMS_TO_TICKS(5));
+  }
+}
+
+// The handle is written before the task first runs, so a task starting on
+// the other core already sees its own handle
+static void createTask(const TaskSpec &spec, void (*entry)(void *),
+                       TaskHandle_t *handle) {
+  if (xTaskCreatePinnedToCore(entry, spec.name, spec.stackBytes, nullptr,
+                              spec.priority, handle, spec.core) != pdPASS) {
+    Serial.printf("ERROR: Could not create task '%s'\n", spec.name);
+    return;
+  }
+  registerHealthTask(spec.name, *handle, spec.stackBytes);
+  Serial.printf("Task '%s' started on core %d (priority %u, stack %u)\n",
+                spec.name, spec.core, spec.priority, spec.stackBytes);
+}
+
+void startTasks() {
+  deliverLatency = registerLatencyMetric("io", "deliver");
+  serialLatency = registerLatencyMetric("io", "serial");
+
+  // Consumers first, so nothing produced early is stranded
+  createTask(loggingTaskSpec, loggingTask, &loggingTaskHandle);
+  createTask(networkTaskSpec, networkTask, &networkTaskHandle);
+  createTask(telemetryTaskSpec, telemetryTask, &telemetryTaskHandle);
+  createTask(controlTaskSpec, controlTask, &controlTaskHandle);
+  registerHealthTask("async_tcp", nullptr, 0);  // Created by AsyncTCP
+}
@@ -0,0 +1,106 @@
+#ifndef TASKS_H
+#define TASKS_H
+
+#include <Arduino.h>
+
+#include <vector>
+
+#include "../config.h"
+#include "scheduler.h"
+
+// --- Task Layout ---
+// control   (core 1) runs the tick scheduler (system/scheduler.h): inbound
+//                    commands and the pin, stepper and servo updates at
+//                    their configured rates.
+// network   (core 0) delivers outbound WebSocket messages, cleans up
+//                    clients and maintains WiFi.
+// telemetry (core 0) broadcasts the snapshot published by the control task,
+//                    sends trace dumps (system/trace.h) and samples heap
+//                    and stack health (system/health.h).
+// logging   (core 0) writes queued log lines to Serial.
+//
+// Priority lane: commands from /ws/control and any stop or estop command
+// (from any endpoint) go to their own inbound ring, which the control task
+// drains at the start of every tick, ahead of limits and queued commands.
+// Replies sent while handling them, and anything addressed to a /ws/control
+// client, go through a priority outbound ring the network task empties
+// before the others.
+//
+// Tasks only exchange data through single-producer rings (one per producing
+// task) and a double-buffered snapshot, so neither WiFi load nor a slow UART
+// can stretch the control cycle. Priorities, cores and stacks are set in
+// config.cpp.
+
+// Per-axis counters copied out of the stepper and servo configurations
+struct AxisCounters {
+  ComponentId id;
+  bool stepper;  // false = servo
+  uint64_t steps;
+  uint32_t movesCompleted;
+};
+
+// Published by the control task at snapshotSubsystem's rate
+struct ControlSnapshot {
+  SchedulerStats scheduler;
+  uint8_t axisCount;
+  AxisCounters axes[MAX_SNAPSHOT_AXES];
+  uint32_t inboundDropped;
+  uint32_t outboundDropped;
+  uint32_t logDropped;
+  uint32_t configHash;  // Changes whenever a component is (re)configured
+  int64_t timestampUs;
+};
+
+// Create the tasks (call once at the end of setup())
+void startTasks();
+
+// True when called from the control task
+bool isControlTask();
+
+// Queue a received text command for the control task, on the priority lane
+// for /ws/control clients and stop/estop commands. Called from the AsyncTCP
+// task only. Returns false if the command is too long or the queue is full.
+bool postInboundCommand(uint32_t clientId, const uint8_t *data, size_t len);
+
+// Queue a command received from a UDP peer (network/udp_transport.h) on
+// the priority lane. Called from the AsyncUDP task only. Returns false if the
+// command is too long or the queue is full.
+bool postUdpCommand(uint32_t address, const uint8_t *data, size_t len);
+
+// Drop every command still waiting in the inbound queues, priority and UDP
+// lanes included (control task only, used by estop). Returns how many were
+// dropped.
+uint32_t discardQueuedCommands();
+
+// Queue an outbound message for the network task (clientId is a transport
+// address, see hal/hal_transport.h; 0 = broadcast).
+// Returns false if the calling task has no outbound queue, in which case the
+// caller should send directly. A full queue counts a drop and returns true.
+bool postOutboundText(uint32_t clientId, const String &text);
+bool postOutboundBinary(uint32_t clientId, std::vector<uint8_t> &&payload);
+
+// Queue a log line for the logging task, or print it directly from tasks
+// without a log queue. Lines longer than LOG_LINE_MAX_BYTES are truncated.
+void logLine(const char *prefix, const String &text);
+
+// printf-style logLine for formatted messages; a trailing newline is dropped
+void logPrintf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+// Client state as of the network task's last pass, readable from any task:
+// whether a telemetry broadcast would go out without queueing, and how
+// many clients (UDP peers included) are connected
+bool isTelemetryWritable();
+uint32_t getConnectedClientCount();
+
+// Latest snapshot published by the control task
+ControlSnapshot getControlSnapshot();
+
+// Items currently waiting in each queue (approximate, any task)
+struct QueueDepths {
+  uint32_t inbound;   // Normal, priority and UDP lanes
+  uint32_t outbound;  // Priority, control and telemetry rings
+  uint32_t log;
+};
+QueueDepths getQueueDepths();
+
+#endif  // TASKS_H
@@ -0,0 +1,250 @@
+#include "trace.h"
+
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
+
+#include "tasks.h"
+
+struct TraceRecord {
+  uint32_t timestampUs;  // Start of a span, or time of an instant
+  uint32_t durationUs;   // 0 for instants
+  uint32_t commandHash;  // 0 = no commandId
+  uint16_t arg;
+  uint8_t event;
+  uint8_t reserved;
+};
+
+struct TraceEventInfo {
+  const char *name;
+  const char *category;
+  uint8_t track;  // Index into traceTracks
+  bool span;
+};
+
+static const char *const traceTracks[] = {"isr", "async_tcp", "control",
+                                          "network"};
+
+static const TraceEventInfo traceEvents[TRACE_EVENT_COUNT] = {
+    {"ws.receive", "network", 1, false},
+    {"parse", "handler", 2, true},
+    {"pins", "handler", 2, true},
+    {"servos", "handler", 2, true},
+    {"steppers", "handler", 2, true},
+    {"system", "handler", 2, true},
+    {"motion.start", "motion", 2, false},
+    {"completion", "motion", 2, false},
+    {"isr.edge", "isr", 0, false},
+    {"isr.pulseDone", "isr", 0, false},
+    {"isr.fadeDone", "isr", 0, false},
+    {"ws.deliver", "network", 3, true},
+};
+
+// Recently seen commandIds, so the export can show text instead of hashes
+static const uint8_t COMMAND_ID_SLOTS = 32;
+static const size_t TRACE_COMMAND_ID_CHARS = 31;
+struct CommandIdSlot {
+  uint32_t hash;
+  char text[TRACE_COMMAND_ID_CHARS + 1];
+};
+
+static DRAM_ATTR TraceRecord ring[TRACE_RING_SIZE];
+static std::atomic<uint32_t> head{0};  // Total records ever claimed
+static std::atomic<bool> paused{false};
+static std::atomic<uint32_t> droppedWhilePaused{0};
+static uint32_t dumpedUpTo = 0;  // Records before this were cleared
+static uint32_t dumpId = 0;
+
+static std::atomic<uint32_t> pendingDumpClient{0};
+static std::atomic<bool> pendingDumpClear{false};
+
+static CommandIdSlot commandIds[COMMAND_ID_SLOTS];
+static uint8_t nextCommandIdSlot = 0;
+static portMUX_TYPE commandIdMux = portMUX_INITIALIZER_UNLOCKED;
+
+// FNV-1a, never returning 0 (which means "no commandId")
+static uint32_t hashCommandId(const char *text, size_t len) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ (uint8_t)text[i]) * 16777619u;
+  }
+  return hash ? hash : 1;
+}
+
+static uint32_t internCommandId(const char *text, size_t len) {
+  if (!text || len == 0) return 0;
+  if (len > TRACE_COMMAND_ID_CHARS) len = TRACE_COMMAND_ID_CHARS;
+  uint32_t hash = hashCommandId(text, len);
+  if (paused.load(std::memory_order_relaxed)) return hash;  // Table in use
+
+  portENTER_CRITICAL(&commandIdMux);
+  bool known = false;
+  for (uint8_t i = 0; i < COMMAND_ID_SLOTS && !known; i++) {
+    known = commandIds[i].hash == hash;
+  }
+  if (!known) {
+    CommandIdSlot &slot = commandIds[nextCommandIdSlot];
+    nextCommandIdSlot = (nextCommandIdSlot + 1) % COMMAND_ID_SLOTS;
+    slot.hash = hash;
+    memcpy(slot.text, text, len);
+    slot.text[len] = 0;
+  }
+  portEXIT_CRITICAL(&commandIdMux);
+  return hash;
+}
+
+uint32_t traceCommandId(const char *commandId) {
+  return commandId ? internCommandId(commandId, strlen(commandId)) : 0;
+}
+
+uint32_t traceCommandIdInText(const char *json) {
+  static const char KEY[] = "\"commandId\":\"";
+  const char *start = json ? strstr(json, KEY) : nullptr;
+  if (!start) return 0;
+  start += sizeof(KEY) - 1;
+  const char *end = strchr(start, '"');
+  if (!end) return 0;
+  return internCommandId(start, end - start);
+}
+
+static void IRAM_ATTR writeRecord(TraceEvent event, uint32_t timestampUs,
+                                  uint32_t durationUs, uint32_t commandHash,
+                                  uint16_t arg) {
+  if (paused.load(std::memory_order_relaxed)) {
+    droppedWhilePaused.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  uint32_t index = head.fetch_add(1, std::memory_order_relaxed);
+  TraceRecord &record = ring[index & (TRACE_RING_SIZE - 1)];
+  record.timestampUs = timestampUs;
+  record.durationUs = durationUs;
+  record.commandHash = commandHash;
+  record.arg = arg;
+  record.event = event;
+}
+
+void IRAM_ATTR traceInstant(TraceEvent event, uint32_t commandHash,
+                            uint16_t arg) {
+  writeRecord(event, traceNow(), 0, commandHash, arg);
+}
+
+void traceSpan(TraceEvent event, uint32_t startUs, uint32_t commandHash,
+               uint16_t arg) {
+  uint32_t durationUs = traceNow() - startUs;
+  writeRecord(event, startUs, durationUs ? durationUs : 1, commandHash, arg);
+}
+
+bool requestTraceDump(uint32_t clientId, bool clear) {
+  uint32_t expected = 0;
+  if (!pendingDumpClient.compare_exchange_strong(expected, clientId)) {
+    return false;
+  }
+  pendingDumpClear.store(clear);
+  return true;
+}
+
+static const char *lookupCommandId(uint32_t hash) {
+  for (uint8_t i = 0; i < COMMAND_ID_SLOTS; i++) {
+    if (commandIds[i].hash == hash) return commandIds[i].text;
+  }
+  return nullptr;
+}
+
+static void addTrackNames(JsonArray events) {
+  for (uint8_t i = 0; i < sizeof(traceTracks) / sizeof(traceTracks[0]); i++) {
+    JsonObject meta = events.createNestedObject();
+    meta["name"] = "thread_name";
+    meta["ph"] = "M";
+    meta["pid"] = 1;
+    meta["tid"] = i;
+    meta["args"]["name"] = traceTracks[i];
+  }
+}
+
+static void addRecord(JsonArray events, const TraceRecord &record,
+                      uint32_t baseUs) {
+  if (record.event >= TRACE_EVENT_COUNT) return;
+  const TraceEventInfo &info = traceEvents[record.event];
+
+  JsonObject item = events.createNestedObject();
+  item["name"] = info.name;
+  item["cat"] = info.category;
+  item["pid"] = 1;
+  item["tid"] = info.track;
+  item["ts"] = record.timestampUs - baseUs;
+  if (info.span) {
+    item["ph"] = "X";
+    item["dur"] = record.durationUs;
+  } else {
+    item["ph"] = "i";
+    item["s"] = "t";
+  }
+
+  if (record.commandHash || record.arg) {
+    JsonObject args = item.createNestedObject("args");
+    if (record.commandHash) {
+      const char *text = lookupCommandId(record.commandHash);
+      if (text) {
+        args["commandId"] = text;
+      } else {
+        char hex[11];
+        snprintf(hex, sizeof(hex), "#%08x", record.commandHash);
+        args["commandId"] = hex;
+      }
+    }
+    if (record.arg) args["arg"] = record.arg;
+  }
+}
+
+void serviceTraceDump() {
+  uint32_t clientId = pendingDumpClient.load();
+  if (clientId == 0) return;
+
+  paused.store(true);
+  vTaskDelay(1);  // Let writers that already claimed a slot finish
+
+  uint32_t end = head.load();
+  uint32_t begin = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+  if (dumpedUpTo > begin && dumpedUpTo <= end) begin = dumpedUpTo;
+  uint32_t total = end - begin;
+  uint32_t chunks = max<uint32_t>(
+      1, (total + TRACE_DUMP_CHUNK_EVENTS - 1) / TRACE_DUMP_CHUNK_EVENTS);
+  uint32_t baseUs =
+      total ? ring[begin & (TRACE_RING_SIZE - 1)].timestampUs : 0;
+  dumpId++;
+
+  logPrintf("Trace: dumping %u records in %u chunks to client #%u", total,
+            chunks, clientId);
+
+  uint32_t next = begin;
+  for (uint32_t chunk = 0; chunk < chunks; chunk++) {
+    DynamicJsonDocument doc(1024 + TRACE_DUMP_CHUNK_EVENTS * 200);
+    doc["type"] = "traceChunk";
+    doc["componentGroup"] = "system";
+    doc["dumpId"] = dumpId;
+    doc["index"] = chunk;
+    doc["count"] = chunks;
+    JsonArray events = doc.createNestedArray("traceEvents");
+    if (chunk == 0) {
+      doc["records"] = total;
+      doc["droppedWhilePaused"] = droppedWhilePaused.load();
+      addTrackNames(events);
+    }
+
+    uint32_t chunkEnd = min(end, next + (uint32_t)TRACE_DUMP_CHUNK_EVENTS);
+    for (; next < chunkEnd; next++) {
+      addRecord(events, ring[next & (TRACE_RING_SIZE - 1)], baseUs);
+    }
+
+    String out;
+    serializeJson(doc, out);
+    postOutboundText(clientId, out);
+    vTaskDelay(pdMS_TO_TICKS(10));  // Leave room in the outbound queue
+  }
+
+  if (pendingDumpClear.load()) dumpedUpTo = end;
+  paused.store(false);
+  pendingDumpClient.store(0);
+}
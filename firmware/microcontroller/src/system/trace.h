@@ -0,0 +1,70 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+#include "../config.h"
+#include "../hal/hal_timer.h"
+
+// --- Event Trace ---
+// A fixed ring of 16-byte records (timestamp, duration, commandId hash,
+// event) written by any task or ISR. Writers claim a slot with one atomic
+// increment, so recording never blocks; the oldest records are overwritten.
+//
+// The `system` `traceDump` action asks the telemetry task to export the
+// ring as Chrome trace_event JSON, sent as a series of "traceChunk"
+// messages whose traceEvents arrays concatenate into one trace that
+// Perfetto or chrome://tracing can open. Recording pauses while a dump is
+// being read.
+
+enum TraceEvent : uint8_t {
+  TRACE_WS_RECEIVE = 0,  // Frame queued by the AsyncTCP task
+  TRACE_PARSE,           // JSON parse (span)
+  TRACE_HANDLE_PINS,     // Handler dispatch (spans)
+  TRACE_HANDLE_SERVOS,
+  TRACE_HANDLE_STEPPERS,
+  TRACE_HANDLE_SYSTEM,
+  TRACE_MOTION_START,    // Stepper/servo move, pulse or fade started
+  TRACE_COMPLETION,      // actionComplete sent
+  TRACE_ISR_EDGE,        // Input edge interrupt (arg = GPIO)
+  TRACE_ISR_PULSE_DONE,  // Pulse train finished (arg = slot)
+  TRACE_ISR_FADE_DONE,   // LEDC fade finished (arg = channel)
+  TRACE_WS_DELIVER,      // Outbound message written to the socket (span)
+  TRACE_EVENT_COUNT
+};
+
+// Current trace timestamp (microseconds, wraps after ~71 minutes)
+inline uint32_t traceNow() { return (uint32_t)halTimeUs(); }
+
+#ifdef EVERWOOD_NATIVE
+// The native build does not record; call sites compile to nothing
+inline uint32_t traceCommandId(const char* commandId) { return 0; }
+inline uint32_t traceCommandIdInText(const char* json) { return 0; }
+inline void traceInstant(TraceEvent event, uint32_t commandHash = 0,
+                         uint16_t arg = 0) {}
+inline void traceSpan(TraceEvent event, uint32_t startUs,
+                      uint32_t commandHash = 0, uint16_t arg = 0) {}
+#else
+// Hash a commandId for trace records and remember its text for the export.
+// Returns 0 for null or empty ids. Not for ISRs.
+uint32_t traceCommandId(const char* commandId);
+
+// traceCommandId for the "commandId" string inside raw JSON text
+uint32_t traceCommandIdInText(const char* json);
+
+// Record an instant (safe from ISRs)
+void traceInstant(TraceEvent event, uint32_t commandHash = 0,
+                  uint16_t arg = 0);
+
+// Record a span that started at startUs (from traceNow) and ends now
+void traceSpan(TraceEvent event, uint32_t startUs, uint32_t commandHash = 0,
+               uint16_t arg = 0);
+
+// Queue a dump for a client (clear = forget the dumped records afterwards).
+// Returns false if a dump is already pending.
+bool requestTraceDump(uint32_t clientId, bool clear);
+
+// Send a pending dump, if any (telemetry task)
+void serviceTraceDump();
+#endif  // EVERWOOD_NATIVE
+
+#endif  // TRACE_H
@@ -0,0 +1,118 @@
+#ifndef COMPONENT_POOL_H
+#define COMPONENT_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Fixed-capacity pool of components with stable addresses.
+//
+// Storage for all N objects is reserved statically; allocate() constructs an
+// object in the lowest free slot and release() destroys it in place. Nothing
+// ever moves, so pointers and slot indices stay valid until the slot is
+// released, and configuring and removing components never touches the heap.
+// Iteration visits the slots in use, in slot order.
+template <typename T, size_t N>
+class ComponentPool {
+  static_assert(N > 0 && N <= 0xFFFF, "ComponentPool capacity out of range");
+
+ public:
+  ComponentPool() {
+    for (size_t i = 0; i < N; i++) used_[i] = false;
+  }
+  ~ComponentPool() {
+    for (size_t i = 0; i < N; i++) {
+      if (used_[i]) slot(i)->~T();
+    }
+  }
+  ComponentPool(const ComponentPool&) = delete;
+  ComponentPool& operator=(const ComponentPool&) = delete;
+
+  // Construct a default T in the lowest free slot. Returns nullptr if full.
+  T* allocate() {
+    for (size_t i = 0; i < N; i++) {
+      if (!used_[i]) {
+        T* item = new (storage_[i]) T();
+        used_[i] = true;
+        count_++;
+        return item;
+      }
+    }
+    return nullptr;
+  }
+
+  // Destroy an item returned by allocate() and free its slot
+  void release(T* item) {
+    int index = indexOf(item);
+    if (index < 0) return;
+    item->~T();
+    used_[index] = false;
+    count_--;
+  }
+
+  // Slot index of an item in this pool, -1 if it is not one of ours
+  int indexOf(const T* item) const {
+    for (size_t i = 0; i < N; i++) {
+      if (used_[i] && slot(i) == item) return (int)i;
+    }
+    return -1;
+  }
+
+  bool inUse(size_t index) const { return index < N && used_[index]; }
+  T& operator[](size_t index) { return *slot(index); }
+  const T& operator[](size_t index) const { return *slot(index); }
+
+  size_t size() const { return count_; }
+  static constexpr size_t capacity() { return N; }
+  bool empty() const { return count_ == 0; }
+  bool full() const { return count_ == N; }
+
+  template <typename Pool, typename Item>
+  class Iterator {
+   public:
+    Iterator(Pool* pool, size_t index) : pool_(pool), index_(index) {
+      skipFree();
+    }
+    Item& operator*() const { return (*pool_)[index_]; }
+    Item* operator->() const { return &(*pool_)[index_]; }
+    Iterator& operator++() {
+      index_++;
+      skipFree();
+      return *this;
+    }
+    bool operator!=(const Iterator& other) const {
+      return index_ != other.index_;
+    }
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+
+   private:
+    void skipFree() {
+      while (index_ < N && !pool_->inUse(index_)) index_++;
+    }
+    Pool* pool_;
+    size_t index_;
+  };
+  typedef Iterator<ComponentPool, T> iterator;
+  typedef Iterator<const ComponentPool, const T> const_iterator;
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, N); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, N); }
+
+ private:
+  T* slot(size_t index) {
+    return std::launder(reinterpret_cast<T*>(storage_[index]));
+  }
+  const T* slot(size_t index) const {
+    return std::launder(reinterpret_cast<const T*>(storage_[index]));
+  }
+
+  alignas(T) unsigned char storage_[N][sizeof(T)];
+  bool used_[N];
+  size_t count_ = 0;
+};
+
+#endif  // COMPONENT_POOL_H
@@ -0,0 +1,54 @@
+#ifndef DOUBLE_BUFFER_H
+#define DOUBLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+// Single-writer snapshot that any number of readers can copy without locks.
+//
+// The writer always fills the slot readers are not pointed at, then flips
+// the published index. Each slot carries a sequence number that is odd
+// while the slot is being written; a reader that raced a write (which takes
+// two publishes in a row) sees the sequence change and retries.
+template <typename T>
+class DoubleBuffer {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "DoubleBuffer requires a trivially copyable type");
+
+ public:
+  DoubleBuffer() = default;
+  explicit DoubleBuffer(const T& initial) : slots_{initial, initial} {}
+
+  // Publish a new value (writer side)
+  void publish(const T& value) {
+    uint32_t slot = published_.load(std::memory_order_relaxed) ^ 1;
+    sequence_[slot].fetch_add(1, std::memory_order_acq_rel);  // Now odd
+    std::atomic_thread_fence(std::memory_order_release);
+    slots_[slot] = value;
+    sequence_[slot].fetch_add(1, std::memory_order_release);  // Even again
+    published_.store(slot, std::memory_order_release);
+  }
+
+  // Copy the latest published value (reader side)
+  T read() const {
+    T copy;
+    for (;;) {
+      uint32_t slot = published_.load(std::memory_order_acquire);
+      uint32_t before = sequence_[slot].load(std::memory_order_acquire);
+      if (before & 1) continue;
+      copy = slots_[slot];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_[slot].load(std::memory_order_relaxed) == before) {
+        return copy;
+      }
+    }
+  }
+
+ private:
+  T slots_[2] = {};
+  std::atomic<uint32_t> sequence_[2] = {{0}, {0}};
+  std::atomic<uint32_t> published_{0};
+};
+
+#endif  // DOUBLE_BUFFER_H
@@ -0,0 +1,67 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <Arduino.h>
+
+#include <cstddef>
+#include <cstring>
+
+// Inline, fixed-capacity string for component ids and names.
+//
+// Holds up to N characters plus the terminator inside the owning struct, so
+// a component never points at the heap and copying one never allocates.
+// Assigning a longer value truncates it; callers that must not truncate
+// (ids) check fits() first.
+template <size_t N>
+class FixedString {
+ public:
+  static const size_t MAX_LENGTH = N;
+
+  FixedString() { text_[0] = 0; }
+  FixedString(const char* text) { assign(text); }
+  FixedString(const String& text) { assign(text.c_str()); }
+
+  FixedString& operator=(const char* text) {
+    assign(text);
+    return *this;
+  }
+  FixedString& operator=(const String& text) {
+    assign(text.c_str());
+    return *this;
+  }
+
+  const char* c_str() const { return text_; }
+  size_t length() const { return strlen(text_); }
+  bool isEmpty() const { return text_[0] == 0; }
+  void clear() { text_[0] = 0; }
+
+  // True if `text` can be stored without truncation
+  static bool fits(const char* text) { return !text || strlen(text) <= N; }
+  static bool fits(const String& text) { return text.length() <= N; }
+
+  bool operator==(const char* text) const {
+    return strcmp(text_, text ? text : "") == 0;
+  }
+  bool operator==(const String& text) const {
+    return strcmp(text_, text.c_str()) == 0;
+  }
+  template <size_t M>
+  bool operator==(const FixedString<M>& other) const {
+    return strcmp(text_, other.c_str()) == 0;
+  }
+  template <typename T>
+  bool operator!=(const T& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  void assign(const char* text) {
+    size_t len = text ? strnlen(text, N) : 0;
+    memcpy(text_, text, len);
+    text_[len] = 0;
+  }
+
+  char text_[N + 1];
+};
+
+#endif  // FIXED_STRING_H
@@ -0,0 +1,87 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear latency histogram in the style of HdrHistogram.
+//
+// Values below SUB_BUCKETS get one bucket each; above that every power of
+// two is split into SUB_BUCKETS equal buckets, so the bucket width is at
+// most 1/8 of the value over the full 32-bit range. record() is a count
+// leading zeros and a few shifts, with no allocation and no floating point.
+//
+// Not thread safe: one context records, and readers on other cores may see
+// a sample half-applied (count updated before the bucket), which only
+// skews the reported statistics by that sample.
+class LatencyHistogram {
+ public:
+  static const uint8_t SUB_BUCKET_BITS = 3;
+  static const uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+  static const size_t BUCKET_COUNT = (32 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  void record(uint32_t value) {
+    counts_[bucketIndex(value)]++;
+    if (count_ == 0 || value < min_) min_ = value;
+    if (value > max_) max_ = value;
+    sum_ += value;
+    count_++;
+  }
+
+  void reset() {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) counts_[i] = 0;
+    count_ = 0;
+    min_ = 0;
+    max_ = 0;
+    sum_ = 0;
+  }
+
+  uint32_t count() const { return count_; }
+  uint32_t min() const { return count_ ? min_ : 0; }
+  uint32_t max() const { return max_; }
+  uint64_t sum() const { return sum_; }
+
+  // Smallest value such that `percent` of the samples are at or below it,
+  // reported as the top of its bucket (capped at the recorded maximum)
+  uint32_t percentile(float percent) const {
+    if (count_ == 0) return 0;
+    uint64_t target = (uint64_t)(percent / 100.0f * count_ + 0.5f);
+    if (target == 0) target = 1;
+    if (target > count_) target = count_;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+      seen += counts_[i];
+      if (seen >= target) {
+        uint32_t top = bucketUpperBound(i);
+        return top < max_ ? top : max_;
+      }
+    }
+    return max_;
+  }
+
+  static size_t bucketIndex(uint32_t value) {
+    if (value < SUB_BUCKETS) return value;
+    uint32_t msb = 31 - __builtin_clz(value);
+    uint32_t shift = msb - SUB_BUCKET_BITS;
+    uint32_t top = value >> shift;  // In [SUB_BUCKETS, 2 * SUB_BUCKETS)
+    return (shift + 1) * SUB_BUCKETS + (top - SUB_BUCKETS);
+  }
+
+  // Largest value that falls in bucket i
+  static uint32_t bucketUpperBound(size_t i) {
+    if (i < SUB_BUCKETS) return (uint32_t)i;
+    uint32_t shift = (uint32_t)(i / SUB_BUCKETS) - 1;
+    uint64_t top = SUB_BUCKETS + i % SUB_BUCKETS;
+    return (uint32_t)(((top + 1) << shift) - 1);
+  }
+
+ private:
+  uint32_t counts_[BUCKET_COUNT] = {};
+  uint32_t count_ = 0;
+  uint32_t min_ = 0;
+  uint32_t max_ = 0;
+  uint64_t sum_ = 0;
+};
+
+#endif  // LATENCY_HISTOGRAM_H
@@ -0,0 +1,72 @@
+#ifndef POLL_TABLES_H
+#define POLL_TABLES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Structure-of-arrays poll tables compiled from configuredPins.
+//
+// Each subsystem rebuilds its table only when its pins are reconfigured, so
+// the per-loop scan walks contiguous arrays of plain integers: no String
+// comparisons, no map lookups and no allocation. Storage is reserved when
+// the table is rebuilt and reused afterwards.
+
+// True once `now` has reached `deadline` (millis() wrap-around safe)
+inline bool deadlineReached(uint32_t now, uint32_t deadline) {
+  return (int32_t)(now - deadline) >= 0;
+}
+
+// Analog inputs read with single conversions at a fixed interval
+struct AnalogPollTable {
+  std::vector<uint16_t> pinIndex;  // Slot index in configuredPins
+  std::vector<uint8_t> gpio;
+  std::vector<uint16_t> deadband;  // Minimum change to report
+  std::vector<uint32_t> nextDeadlineMs;
+
+  size_t size() const { return pinIndex.size(); }
+
+  void clear() {
+    pinIndex.clear();
+    gpio.clear();
+    deadband.clear();
+    nextDeadlineMs.clear();
+  }
+
+  void add(uint16_t index, uint8_t pin, uint16_t band, uint32_t deadline) {
+    pinIndex.push_back(index);
+    gpio.push_back(pin);
+    deadband.push_back(band);
+    nextDeadlineMs.push_back(deadline);
+  }
+};
+
+// Hardware pulse counters reported at a fixed interval
+struct CounterPollTable {
+  std::vector<uint16_t> pinIndex;  // Slot index in configuredPins
+  std::vector<uint8_t> unit;       // PCNT unit
+  std::vector<uint16_t> intervalMs;
+  std::vector<uint8_t> reportsFrequency;  // 1 = value is Hz, 0 = count
+  std::vector<uint32_t> nextDeadlineMs;
+
+  size_t size() const { return pinIndex.size(); }
+
+  void clear() {
+    pinIndex.clear();
+    unit.clear();
+    intervalMs.clear();
+    reportsFrequency.clear();
+    nextDeadlineMs.clear();
+  }
+
+  void add(uint16_t index, uint8_t pcntUnit, uint16_t interval,
+           bool frequency, uint32_t deadline) {
+    pinIndex.push_back(index);
+    unit.push_back(pcntUnit);
+    intervalMs.push_back(interval);
+    reportsFrequency.push_back(frequency ? 1 : 0);
+    nextDeadlineMs.push_back(deadline);
+  }
+};
+
+#endif  // POLL_TABLES_H
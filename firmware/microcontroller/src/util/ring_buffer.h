@@ -0,0 +1,99 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Fixed-capacity single-producer / single-consumer ring buffer.
+//
+// The producer only writes `head` and the consumer only writes `tail`, so no
+// lock is needed as long as there is exactly one context pushing and one
+// context popping. The producer may be an ISR: push() never blocks and never
+// allocates. Capacity must be a power of two; one slot is kept free to tell
+// "full" from "empty".
+template <typename T, size_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0,
+                "SpscRing capacity must be a power of two");
+
+ public:
+  // Push an item (producer side). Returns false and counts a drop if full.
+  bool push(const T& item) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t next = (head + 1) & (N - 1);
+    if (next == tail_.load(std::memory_order_acquire)) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    buffer_[head] = item;
+    head_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Push by moving (producer side), so heap-backed payloads are not copied
+  bool push(T&& item) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t next = (head + 1) & (N - 1);
+    if (next == tail_.load(std::memory_order_acquire)) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    buffer_[head] = std::move(item);
+    head_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Pop the oldest item (consumer side). Returns false if empty.
+  bool pop(T& item) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) return false;
+    item = std::move(buffer_[tail]);
+    tail_.store((tail + 1) & (N - 1), std::memory_order_release);
+    return true;
+  }
+
+  // Drop every queued item without copying it out (consumer side).
+  // Returns how many were dropped.
+  size_t discard() {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+    tail_.store(head, std::memory_order_release);
+    return (head - tail) & (N - 1);
+  }
+
+  // Visit every queued item in place, oldest first (consumer side). The
+  // producer never writes a queued slot, so items may be modified; items
+  // pushed while this runs may or may not be visited.
+  template <typename F>
+  void forEachQueued(F&& visit) {
+    uint32_t head = head_.load(std::memory_order_acquire);
+    for (uint32_t i = tail_.load(std::memory_order_relaxed); i != head;
+         i = (i + 1) & (N - 1)) {
+      visit(buffer_[i]);
+    }
+  }
+
+  // Number of items currently queued (approximate while the producer runs)
+  size_t size() const {
+    uint32_t head = head_.load(std::memory_order_acquire);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    return (head - tail) & (N - 1);
+  }
+
+  bool empty() const { return size() == 0; }
+
+  static constexpr size_t capacity() { return N - 1; }
+
+  // Total number of items rejected because the ring was full
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  T buffer_[N];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+  std::atomic<uint32_t> dropped_{0};
+};
+
+#endif  // RING_BUFFER_H
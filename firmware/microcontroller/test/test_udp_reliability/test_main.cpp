@@ -0,0 +1,178 @@
+// Native tests for the UDP transport's sequence window, acks and commandId
+// dedup (src/network/udp_reliability.h). Run from firmware/:
+//   pio test -e native
+
+#include <unity.h>
+
+#include "network/udp_reliability.h"
+
+// Receive every seq in [first, last]
+static void receiveRange(UdpReceiveWindow &window, uint32_t first,
+                         uint32_t last) {
+  for (uint32_t seq = first; seq != last + 1; seq++) {
+    udpMarkReceived(window, seq);
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_nothing_received_yet() {
+  UdpReceiveWindow window;
+  TEST_ASSERT_FALSE(udpAlreadyReceived(window, 1));
+  udpMarkReceived(window, 1);
+  TEST_ASSERT_TRUE(udpAlreadyReceived(window, 1));
+  TEST_ASSERT_FALSE(udpAlreadyReceived(window, 2));
+}
+
+// 32 behind the newest is the last bit of the window; 33 behind is outside
+// it and counts as received
+static void test_window_edges() {
+  UdpReceiveWindow window;
+  udpMarkReceived(window, 100);
+  TEST_ASSERT_FALSE(udpAlreadyReceived(window, 100 - 31));
+  TEST_ASSERT_FALSE(udpAlreadyReceived(window, 100 - 32));
+  TEST_ASSERT_TRUE(udpAlreadyReceived(window, 100 - 33));
+
+  udpMarkReceived(window, 100 - 31);
+  udpMarkReceived(window, 100 - 32);
+  TEST_ASSERT_TRUE(udpAlreadyReceived(window, 100 - 31));
+  TEST_ASSERT_TRUE(udpAlreadyReceived(window, 100 - 32));
+  TEST_ASSERT_EQUAL_HEX32(0xC0000000u, window.bits);
+}
+
+// Older frames arriving late fill in their bit without moving the window
+static void test_out_of_order() {
+  UdpReceiveWindow window;
+  udpMarkReceived(window, 10);
+  udpMarkReceived(window, 12);
+  TEST_ASSERT_FALSE(udpAlreadyReceived(window, 11));
+  TEST_ASSERT_EQUAL_UINT32(12, window.newestSeq);
+  TEST_ASSERT_EQUAL_HEX32(0x2u, window.bits);  // 10 is 2 behind
+
+  udpMarkReceived(window, 11);
+  TEST_ASSERT_TRUE(udpAlreadyReceived(window, 11));
+  TEST_ASSERT_EQUAL_UINT32(12, window.newestSeq);
+  TEST_ASSERT_EQUAL_HEX32(0x3u, window.bits);
+}
+
+// Advancing by exactly 32 keeps the previous newest as the last bit; by 33
+// it falls out of the window
+static void test_advance_by_window_size() {
+  UdpReceiveWindow window;
+  udpMarkReceived(window, 50);
+  udpMarkReceived(window, 50 + 32);
+  TEST_ASSERT_EQUAL_HEX32(0x80000000u, window.bits);
+  TEST_ASSERT_TRUE(udpAlreadyReceived(window, 50));
+
+  UdpReceiveWindow farther;
+  udpMarkReceived(farther, 50);
+  udpMarkReceived(farther, 50 + 33);
+  TEST_ASSERT_EQUAL_HEX32(0u, farther.bits);
+}
+
+static void test_full_window() {
+  UdpReceiveWindow window;
+  receiveRange(window, 1, 33);
+  TEST_ASSERT_EQUAL_UINT32(33, window.newestSeq);
+  TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFFu, window.bits);
+}
+
+// Seqs are compared by signed distance, so the window carries across the
+// 32-bit wrap
+static void test_wraparound() {
+  UdpReceiveWindow window;
+  receiveRange(window, 0xFFFFFFF0u, 0xFFFFFFFFu);
+  udpMarkReceived(window, 2);  // Skips 0 and 1
+  TEST_ASSERT_EQUAL_UINT32(2, window.newestSeq);
+  TEST_ASSERT_TRUE(udpAlreadyReceived(window, 0xFFFFFFFFu));
+  TEST_ASSERT_TRUE(udpAlreadyReceived(window, 0xFFFFFFF0u));
+  TEST_ASSERT_FALSE(udpAlreadyReceived(window, 0));
+  TEST_ASSERT_FALSE(udpAlreadyReceived(window, 1));
+  TEST_ASSERT_FALSE(udpAlreadyReceived(window, 3));
+
+  udpMarkReceived(window, 1);
+  TEST_ASSERT_TRUE(udpAlreadyReceived(window, 1));
+  TEST_ASSERT_EQUAL_UINT32(2, window.newestSeq);
+}
+
+static void test_seq_acked() {
+  TEST_ASSERT_TRUE(udpSeqAcked(7, 7, 0));
+  TEST_ASSERT_FALSE(udpSeqAcked(8, 7, 0xFFFFFFFFu));  // Ahead of the ack
+  TEST_ASSERT_TRUE(udpSeqAcked(6, 7, 0x1u));
+  TEST_ASSERT_FALSE(udpSeqAcked(5, 7, 0x1u));
+  TEST_ASSERT_TRUE(udpSeqAcked(7 - 32, 7, 0x80000000u));
+  TEST_ASSERT_FALSE(udpSeqAcked(7 - 33, 7, 0xFFFFFFFFu));
+  TEST_ASSERT_TRUE(udpSeqAcked(0xFFFFFFFFu, 1, 0x2u));  // Across the wrap
+}
+
+// Only the replies the ack header covers are released; the rest stay
+// pending for the resend pass
+static void test_apply_acks_releases_covered_replies() {
+  PendingReply pending[4];
+  pending[0].seq = 10;
+  pending[0].payload = "ten";
+  pending[1].seq = 11;
+  pending[2].seq = 12;
+  pending[3].seq = 13;  // Sent after the ack was written
+
+  // ack 12 with ackBits bit 1 (seq 10) set; 11 was lost
+  size_t released = udpApplyAcks(pending, 4, 12, 0x2u);
+  TEST_ASSERT_EQUAL_UINT32(2, released);
+  TEST_ASSERT_EQUAL_UINT32(0, pending[0].seq);
+  TEST_ASSERT_TRUE(pending[0].payload.isEmpty());
+  TEST_ASSERT_EQUAL_UINT32(11, pending[1].seq);
+  TEST_ASSERT_EQUAL_UINT32(0, pending[2].seq);
+  TEST_ASSERT_EQUAL_UINT32(13, pending[3].seq);
+
+  // A later ack covering 11 releases it; free slots are skipped
+  released = udpApplyAcks(pending, 4, 13, 0x3u);
+  TEST_ASSERT_EQUAL_UINT32(2, released);
+  TEST_ASSERT_EQUAL_UINT32(0, pending[1].seq);
+  TEST_ASSERT_EQUAL_UINT32(0, pending[3].seq);
+}
+
+// A client that missed the ack resends the command under a new seq; the
+// window does not recognize it, the commandId does
+static void test_resent_command_id_under_new_seq() {
+  UdpReceiveWindow window;
+  const uint32_t hash = 0x1234abcdu;
+  udpMarkReceived(window, 5);
+  udpRememberCommandId(window, hash);
+
+  TEST_ASSERT_FALSE(udpAlreadyReceived(window, 6));
+  TEST_ASSERT_TRUE(udpRecentCommandId(window, hash));
+  TEST_ASSERT_FALSE(udpRecentCommandId(window, hash + 1));
+  TEST_ASSERT_FALSE(udpRecentCommandId(window, 0));  // No commandId
+}
+
+// Only the last UDP_RECENT_COMMAND_IDS commandIds are kept
+static void test_recent_command_ids_roll_over() {
+  UdpReceiveWindow window;
+  for (uint32_t i = 1; i <= UDP_RECENT_COMMAND_IDS; i++) {
+    udpRememberCommandId(window, i);
+  }
+  TEST_ASSERT_TRUE(udpRecentCommandId(window, 1));
+  udpRememberCommandId(window, UDP_RECENT_COMMAND_IDS + 1);
+  TEST_ASSERT_FALSE(udpRecentCommandId(window, 1));
+  TEST_ASSERT_TRUE(udpRecentCommandId(window, 2));
+  TEST_ASSERT_TRUE(udpRecentCommandId(window, UDP_RECENT_COMMAND_IDS + 1));
+
+  udpRememberCommandId(window, 0);  // Ignored
+  TEST_ASSERT_TRUE(udpRecentCommandId(window, 2));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_nothing_received_yet);
+  RUN_TEST(test_window_edges);
+  RUN_TEST(test_out_of_order);
+  RUN_TEST(test_advance_by_window_size);
+  RUN_TEST(test_full_window);
+  RUN_TEST(test_wraparound);
+  RUN_TEST(test_seq_acked);
+  RUN_TEST(test_apply_acks_releases_covered_replies);
+  RUN_TEST(test_resent_command_id_under_new_seq);
+  RUN_TEST(test_recent_command_ids_roll_over);
+  return UNITY_END();
+}
@@ -0,0 +1,18 @@
+# Count malloc, calloc and realloc in the native allocation counter
+# (microcontroller/src/system/allocation_counter.cpp) as well as operator
+# new, so ArduinoJson's DynamicJsonDocument pools are included. GNU ld's
+# --wrap is only used on Linux hosts; elsewhere the counts cover operator new
+# only and report that.
+Import("env")
+
+import sys
+
+if sys.platform.startswith("linux"):
+    env.Append(
+        CPPDEFINES=["EVERWOOD_COUNT_MALLOC"],
+        LINKFLAGS=[
+            "-Wl,--wrap=malloc",
+            "-Wl,--wrap=calloc",
+            "-Wl,--wrap=realloc",
+        ],
+    )
@@ -2,6 +2,8 @@ import { ipcMain, BrowserWindow } from "electron";
 import WebSocket from "ws";
 import { handleActionCompletionMessage } from "./sequence-handler";
 import createLogger from "../lib/logger";
+import { BinaryFrameDecoder } from "../lib/binary-frames";
+import { handleTraceChunk } from "../lib/trace-export";
 
 // Create a logger instance for the Connection Handler
 const logger = createLogger("Connection Handler");
@@ -17,6 +19,7 @@ let connectionState = {
 // The actual WebSocket connection
 let wsConnection: WebSocket | null = null;
 let pingInterval: NodeJS.Timeout | null = null;
+let binaryFrameDecoder = new BinaryFrameDecoder(); // Reset per connection
 
 // Function to establish WebSocket connection
 function connectWebSocket(url: string): Promise<boolean> {
@@ -27,6 +30,7 @@ function connectWebSocket(url: string): Promise<boolean> {
     try {
       logger.info(`Connecting to WebSocket: ${url}`);
       wsConnection = new WebSocket(url);
+      binaryFrameDecoder = new BinaryFrameDecoder();
 
       // Set a connection timeout
       const connectionTimeout = setTimeout(() => {
@@ -80,7 +84,12 @@ function connectWebSocket(url: string): Promise<boolean> {
         resolve(true);
       });
 
-      wsConnection.on("message", (data) => {
+      wsConnection.on("message", (data, isBinary) => {
+        if (isBinary) {
+          handleBinaryFrame(data as Buffer);
+          return;
+        }
+
         try {
           const message = data.toString();
           logger.debug("Received message:", message);
@@ -97,6 +106,8 @@ function connectWebSocket(url: string): Promise<boolean> {
               // If this is an action completion message, handle it
               if (jsonMessage.type === "actionComplete") {
                 handleActionCompletionMessage(jsonMessage);
+              } else if (jsonMessage.type === "traceChunk") {
+                handleTraceChunk(jsonMessage);
               }
             } catch (jsonError) {
               // If parsing fails, it's a plain text message, not an error
@@ -193,6 +204,29 @@ function connectWebSocket(url: string): Promise<boolean> {
   });
 }
 
+// Decode a binary frame (e.g. analog stream chunk) and forward it to renderers
+function handleBinaryFrame(data: Buffer) {
+  const frame = binaryFrameDecoder.decode(data);
+  if (!frame) {
+    if (!binaryFrameDecoder.capturePending) {
+      logger.warn(`Ignoring unknown binary frame (${data.length} bytes)`);
+    }
+    return;
+  }
+
+  if (frame.type === "analogStream" && frame.droppedChunks > 0) {
+    logger.warn(
+      `Stream ${frame.id}: device dropped ${frame.droppedChunks} chunk(s)`
+    );
+  }
+
+  BrowserWindow.getAllWindows().forEach((window) => {
+    if (!window.isDestroyed()) {
+      window.webContents.send("ws-binary-frame", frame);
+    }
+  });
+}
+
 // Function to disconnect WebSocket
 function disconnectWebSocket() {
   if (wsConnection) {
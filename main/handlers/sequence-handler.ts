@@ -338,6 +338,29 @@ async function handleActionStep(step: ActionStep): Promise<void> {
         commandId: mainCommandId,
       };
     }
+  } else if (step.deviceComponentGroup === "pins" && step.action === "pulse") {
+    // Timed pulse: value is a width in ms, or { widthMs, count, periodMs, activeLow }
+    const pulse =
+      typeof step.value === "object" && step.value !== null
+        ? step.value
+        : { widthMs: step.value };
+    message = {
+      action: "pulse",
+      componentGroup: "pins",
+      id: step.deviceId,
+      ...pulse,
+      commandId: mainCommandId,
+    };
+  } else if (step.deviceComponentGroup === "pins" && step.action === "fade") {
+    // Hardware fade: value is the target duty, speed the duration in ms
+    message = {
+      action: "fade",
+      componentGroup: "pins",
+      id: step.deviceId,
+      duty: step.value,
+      durationMs: step.speed !== undefined ? step.speed : 1000,
+      commandId: mainCommandId,
+    };
   } else {
     // Default format for other component types
     message = {
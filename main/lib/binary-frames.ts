@@ -0,0 +1,190 @@
+/**
+ * Decoders for the binary WebSocket frames sent by the firmware
+ * (see firmware/microcontroller/src/binary_frames.h). All multi-byte
+ * fields are little-endian.
+ */
+
+export const BINARY_FRAME_ANALOG_STREAM = 0x01;
+export const BINARY_FRAME_PIN_CAPTURE = 0x02;
+export const BINARY_FRAME_PIN_CAPTURE_DATA = 0x03;
+
+const ANALOG_STREAM_HEADER_BYTES = 24;
+const PIN_CAPTURE_HEADER_BYTES = 24;
+const PIN_CAPTURE_DATA_HEADER_BYTES = 8;
+
+export interface AnalogStreamChunk {
+  type: "analogStream";
+  id: string;
+  gpio: number;
+  sequence: number;
+  startUs: number; // Device esp_timer time of the first sample
+  sampleRateHz: number;
+  droppedChunks: number; // Chunks dropped on the device before this one
+  samples: Uint16Array;
+}
+
+export interface PinCaptureChannel {
+  id: string;
+  gpio: number;
+}
+
+export interface PinCapture {
+  type: "pinCapture";
+  sampleRateHz: number;
+  startUs: number; // Device esp_timer time of the first frame
+  triggerFrame: number; // Index of the frame that fired the trigger
+  digitalChannels: PinCaptureChannel[];
+  analogChannels: PinCaptureChannel[];
+  digital: Uint32Array; // One bitfield per frame, bit i = digitalChannels[i]
+  analog: Uint16Array[]; // One array per analog channel
+}
+
+export type BinaryFrame = AnalogStreamChunk | PinCapture;
+
+/**
+ * Reassembles pin captures, which arrive as a header frame followed by data
+ * frames holding consecutive runs of capture frames. Keep one per connection.
+ */
+export class BinaryFrameDecoder {
+  private capture: PinCapture | null = null;
+  private framesReceived = 0;
+
+  /**
+   * Decode a binary frame. Returns null for unknown or truncated frames and
+   * for capture frames until the capture is complete.
+   */
+  decode(buffer: Buffer): BinaryFrame | null {
+    if (buffer.length < 2) return null;
+
+    switch (buffer.readUInt8(0)) {
+      case BINARY_FRAME_ANALOG_STREAM:
+        return decodeAnalogStreamChunk(buffer);
+      case BINARY_FRAME_PIN_CAPTURE:
+        this.capture = decodePinCaptureHeader(buffer);
+        this.framesReceived = 0;
+        return this.completeCapture();
+      case BINARY_FRAME_PIN_CAPTURE_DATA:
+        return this.addCaptureData(buffer);
+      default:
+        return null;
+    }
+  }
+
+  /** True while a capture header has arrived but not all of its frames. */
+  get capturePending(): boolean {
+    return this.capture !== null;
+  }
+
+  private addCaptureData(buffer: Buffer): PinCapture | null {
+    const capture = this.capture;
+    if (!capture || buffer.length < PIN_CAPTURE_DATA_HEADER_BYTES) {
+      return null;
+    }
+
+    const frameCount = buffer.readUInt16LE(2);
+    const firstFrame = buffer.readUInt32LE(4);
+    const analogCount = capture.analogChannels.length;
+    const frameBytes = 4 + analogCount * 2;
+    if (
+      firstFrame !== this.framesReceived ||
+      firstFrame + frameCount > capture.digital.length ||
+      buffer.length < PIN_CAPTURE_DATA_HEADER_BYTES + frameCount * frameBytes
+    ) {
+      this.capture = null; // Out of order or truncated: drop the capture
+      return null;
+    }
+
+    for (let i = 0; i < frameCount; i++) {
+      const frameStart = PIN_CAPTURE_DATA_HEADER_BYTES + i * frameBytes;
+      const f = firstFrame + i;
+      capture.digital[f] = buffer.readUInt32LE(frameStart);
+      for (let a = 0; a < analogCount; a++) {
+        capture.analog[a][f] = buffer.readUInt16LE(frameStart + 4 + a * 2);
+      }
+    }
+    this.framesReceived += frameCount;
+    return this.completeCapture();
+  }
+
+  private completeCapture(): PinCapture | null {
+    const capture = this.capture;
+    if (!capture || this.framesReceived < capture.digital.length) return null;
+    this.capture = null;
+    return capture;
+  }
+}
+
+function decodeAnalogStreamChunk(buffer: Buffer): AnalogStreamChunk | null {
+  if (buffer.length < ANALOG_STREAM_HEADER_BYTES) return null;
+
+  const gpio = buffer.readUInt8(2);
+  const idLength = buffer.readUInt8(3);
+  const sequence = buffer.readUInt32LE(4);
+  const startUs = Number(buffer.readBigUInt64LE(8));
+  const sampleRateMilliHz = buffer.readUInt32LE(16);
+  const sampleCount = buffer.readUInt16LE(20);
+  const droppedChunks = buffer.readUInt16LE(22);
+
+  const idStart = ANALOG_STREAM_HEADER_BYTES;
+  const samplesStart = idStart + idLength;
+  if (buffer.length < samplesStart + sampleCount * 2) return null;
+
+  // Copy into an aligned array; the payload offset is not 2-byte aligned
+  const samples = new Uint16Array(sampleCount);
+  for (let i = 0; i < sampleCount; i++) {
+    samples[i] = buffer.readUInt16LE(samplesStart + i * 2);
+  }
+
+  return {
+    type: "analogStream",
+    id: buffer.toString("utf8", idStart, samplesStart),
+    gpio,
+    sequence,
+    startUs,
+    sampleRateHz: sampleRateMilliHz / 1000,
+    droppedChunks,
+    samples,
+  };
+}
+
+// Decode a capture header frame into a capture whose frames are still empty
+function decodePinCaptureHeader(buffer: Buffer): PinCapture | null {
+  if (buffer.length < PIN_CAPTURE_HEADER_BYTES) return null;
+
+  const digitalCount = buffer.readUInt8(2);
+  const analogCount = buffer.readUInt8(3);
+  const sampleRateHz = buffer.readUInt32LE(4);
+  const frameCount = buffer.readUInt32LE(8);
+  const triggerFrame = buffer.readUInt32LE(12);
+  const startUs = Number(buffer.readBigUInt64LE(16));
+
+  // Channel descriptors: gpio, idLength, id bytes
+  let offset = PIN_CAPTURE_HEADER_BYTES;
+  const channels: PinCaptureChannel[] = [];
+  for (let i = 0; i < digitalCount + analogCount; i++) {
+    if (buffer.length < offset + 2) return null;
+    const gpio = buffer.readUInt8(offset);
+    const idLength = buffer.readUInt8(offset + 1);
+    offset += 2;
+    if (buffer.length < offset + idLength) return null;
+    channels.push({
+      gpio,
+      id: buffer.toString("utf8", offset, offset + idLength),
+    });
+    offset += idLength;
+  }
+
+  return {
+    type: "pinCapture",
+    sampleRateHz,
+    startUs,
+    triggerFrame,
+    digitalChannels: channels.slice(0, digitalCount),
+    analogChannels: channels.slice(digitalCount),
+    digital: new Uint32Array(frameCount),
+    analog: Array.from(
+      { length: analogCount },
+      () => new Uint16Array(frameCount)
+    ),
+  };
+}
@@ -0,0 +1,135 @@
+import { app } from "electron";
+import fs from "fs";
+import path from "path";
+import createLogger from "./logger";
+
+/**
+ * Reassembles the "traceChunk" messages sent by the firmware's `system`
+ * `traceDump` action into one Chrome trace_event file that Perfetto
+ * (ui.perfetto.dev) or chrome://tracing can open.
+ */
+
+const logger = createLogger("Trace Export");
+
+export interface TraceChunkMessage {
+  type: "traceChunk";
+  dumpId: number;
+  index: number;
+  count: number;
+  records?: number;
+  droppedWhilePaused?: number;
+  traceEvents: object[];
+}
+
+interface PendingDump {
+  chunks: (object[] | undefined)[];
+  received: number;
+  records: number;
+  timeout: ReturnType<typeof setTimeout>;
+}
+
+// The firmware drops a chunk when its outbound queue is full, so a dump
+// that stops receiving chunks for this long is saved with what arrived
+const DUMP_TIMEOUT_MS = 10000;
+
+const pendingDumps = new Map<number, PendingDump>();
+
+// Missing chunk indices of a dump, empty once every chunk has arrived
+function missingChunks(dump: PendingDump): number[] {
+  const missing: number[] = [];
+  for (let i = 0; i < dump.chunks.length; i++) {
+    if (!dump.chunks[i]) missing.push(i);
+  }
+  return missing;
+}
+
+// Write a dump to the traces directory. An incomplete dump is still written,
+// flagged in the trace metadata with the chunks it lacks.
+function writeTraceFile(dumpId: number, dump: PendingDump): string | null {
+  const missing = missingChunks(dump);
+  const traceEvents = dump.chunks.flatMap((events) => events ?? []);
+  const directory = path.join(app.getPath("userData"), "traces");
+  const suffix = missing.length ? "-incomplete" : "";
+  const file = path.join(
+    directory,
+    `trace-${new Date().toISOString().replace(/[:.]/g, "-")}${suffix}.json`
+  );
+
+  try {
+    fs.mkdirSync(directory, { recursive: true });
+    fs.writeFileSync(
+      file,
+      JSON.stringify({
+        traceEvents,
+        displayTimeUnit: "ms",
+        metadata: {
+          dumpId,
+          records: dump.records,
+          complete: missing.length === 0,
+          missingChunks: missing,
+        },
+      })
+    );
+    if (missing.length) {
+      logger.warn(
+        `Trace dump ${dumpId} incomplete: ${missing.length} of ${dump.chunks.length} chunk(s) missing (${missing.join(", ")}); saved what arrived to ${file}`
+      );
+    } else {
+      logger.success(`Saved trace with ${dump.records} record(s) to ${file}`);
+    }
+    return file;
+  } catch (err) {
+    logger.error("Failed to write trace file:", err);
+    return null;
+  }
+}
+
+// Give up on a dump that stopped receiving chunks
+function expireDump(dumpId: number): void {
+  const dump = pendingDumps.get(dumpId);
+  if (!dump) return;
+  pendingDumps.delete(dumpId);
+  writeTraceFile(dumpId, dump);
+}
+
+// Collect one chunk; writes the trace file once every chunk has arrived, or
+// DUMP_TIMEOUT_MS after the last chunk if some never do.
+// Returns the file path when the dump is complete.
+export function handleTraceChunk(message: TraceChunkMessage): string | null {
+  let dump = pendingDumps.get(message.dumpId);
+  if (dump) clearTimeout(dump.timeout);
+  const timeout = setTimeout(
+    () => expireDump(message.dumpId),
+    DUMP_TIMEOUT_MS
+  );
+  if (dump) {
+    dump.timeout = timeout;
+  } else {
+    dump = {
+      chunks: new Array(message.count),
+      received: 0,
+      records: 0,
+      timeout,
+    };
+    pendingDumps.set(message.dumpId, dump);
+  }
+
+  if (message.index === 0) {
+    dump.records = message.records ?? 0;
+    if (message.droppedWhilePaused) {
+      logger.warn(
+        `Trace dump ${message.dumpId}: ${message.droppedWhilePaused} event(s) dropped while dumping`
+      );
+    }
+  }
+
+  if (!dump.chunks[message.index]) {
+    dump.chunks[message.index] = message.traceEvents;
+    dump.received++;
+  }
+
+  if (dump.received < dump.chunks.length) return null;
+  clearTimeout(dump.timeout);
+  pendingDumps.delete(message.dumpId);
+  return writeTraceFile(message.dumpId, dump);
+}
@@ -1223,6 +1223,23 @@ export const useConfigStore = create<ConfigState & ConfigActions>()(
                   configPayload.pullMode = component.pullMode;
                 if (component.debounceMs !== undefined)
                   configPayload.debounceMs = component.debounceMs;
+                if (component.interrupt !== undefined)
+                  configPayload.interrupt = component.interrupt;
+                for (const key of [
+                  "oversample",
+                  "filter",
+                  "filterWindow",
+                  "deadband",
+                  "adcReportIntervalMs",
+                  "edge",
+                  "glitchFilterNs",
+                  "counterReportIntervalMs",
+                  "frequency",
+                  "resolution",
+                ] as const) {
+                  if (component[key] !== undefined)
+                    configPayload[key] = component[key];
+                }
 
                 // Extract mode and pin type from the type field (e.g., "digital_input" -> mode="input", pinType="digital")
                 if (component.type && component.type.includes("_")) {
@@ -169,6 +169,17 @@ export default function Dashboard() {
             return;
           }
 
+          // Coalesced multi-pin update (e.g. from a pins writeMany)
+          if (data.type === "pinValues" && Array.isArray(data.values)) {
+            data.values.forEach((entry: { id: string; value: number }) => {
+              updateComponentState(entry.id, entry.value);
+              window.dispatchEvent(
+                new CustomEvent("websocket-message", { detail: entry })
+              );
+            });
+            return;
+          }
+
           let updateId: string | null = null;
           let stateValue: number | boolean | string | undefined = undefined;
 
@@ -0,0 +1,824 @@
+#!/usr/bin/env node
+
+// WebSocket load generator and latency harness for the firmware.
+// Connects N clients to a board on the LAN (ws://<ip>/ws) or to the native
+// simulator build (pio run -e native), replays a mix of UI traffic and
+// reports command-to-ack and command-to-actionComplete latency percentiles,
+// throughput and drops.
+//
+//   npm run load:ws -- --clients 8 --duration 60
+//   npm run load:ws -- --native firmware/.pio/build/native/program
+//
+// Run with --help for every option.
+
+import WebSocket from "ws";
+import { spawn, ChildProcessWithoutNullStreams } from "child_process";
+import readline from "readline";
+import fs from "fs";
+import path from "path";
+
+const USAGE = `Usage: tsx scripts/ws-load.ts [options]
+
+Target (default: ws://<.ip_address>/ws):
+  --url <ws://host/ws>       Board WebSocket endpoint
+  --native <program>         Spawn the native simulator instead of a board
+
+Load:
+  --clients <n>              Connected clients (default 4)
+  --duration <s>             Test length in seconds (default 30)
+  --rate <n>                 Commands per second per client (default 20)
+  --mix <k=w,...>            Weights for slider, sequence and config
+                             (default slider=6,sequence=3,config=1)
+  --burst <n>                Messages per configuration burst (default 5)
+
+Link emulation:
+  --latency <ms>             Delay added to each direction (default 0)
+  --jitter <ms>              Extra random delay, order preserved (default 0)
+  --loss <fraction>          Share of outbound commands dropped (default 0)
+
+Components:
+  --steppers <n>             Load steppers to configure (default 2)
+  --stepper-pins <p,d;...>   PUL,DIR pin pairs (default 12,13;14,15;16,17;18,19)
+  --servo-pin <pin>          Load servo pin (default 21)
+  --no-configure             Use already configured load-stepper-<k> and
+                             load-servo components (boards with hardware)
+
+Reporting:
+  --timeout <ms>             Ack and actionComplete timeout (default 5000)
+  --json <file>              Also write the report as JSON
+  --max-ack-p99 <ms>         Exit 1 when the ack p99 is above this
+`;
+
+type CommandKind = "slider" | "sequence" | "config" | "setup";
+
+interface Options {
+  url: string | null;
+  native: string | null;
+  clients: number;
+  durationS: number;
+  rate: number;
+  mix: Record<"slider" | "sequence" | "config", number>;
+  burst: number;
+  latencyMs: number;
+  jitterMs: number;
+  loss: number;
+  steppers: number;
+  stepperPins: [number, number][];
+  servoPin: number;
+  configure: boolean;
+  timeoutMs: number;
+  jsonPath: string | null;
+  maxAckP99Ms: number | null;
+}
+
+// Transport-independent view of one connection
+interface LoadConnection {
+  send(text: string): void;
+  close(): void;
+  onMessage: ((text: string) => void) | null;
+}
+
+interface PendingAck {
+  kind: CommandKind;
+  sentAt: number;
+}
+
+interface PendingCompletion {
+  client: LoadClient;
+  stepperIndex: number;
+  sentAt: number;
+}
+
+interface LoadClient {
+  index: number;
+  connection: LoadConnection;
+  pendingAcks: PendingAck[];
+  sequenceInFlight: boolean;
+  // Latest scheduled delivery per direction, so jitter never reorders frames
+  lastOutboundAt: number;
+  lastInboundAt: number;
+}
+
+const stats = {
+  sent: { slider: 0, sequence: 0, config: 0, setup: 0 } as Record<
+    CommandKind,
+    number
+  >,
+  injectedDrops: 0,
+  acked: 0,
+  ackErrors: 0,
+  ackTimeouts: 0,
+  completed: 0,
+  completionFailures: 0,
+  completionTimeouts: 0,
+  completionsSuperseded: 0,
+  received: 0,
+  receivedBytes: 0,
+  connectFailures: 0,
+  disconnects: 0,
+  ackLatency: { slider: [], sequence: [], config: [], setup: [] } as Record<
+    CommandKind,
+    number[]
+  >,
+  completionLatency: [] as number[],
+};
+
+const pendingCompletions = new Map<string, PendingCompletion>();
+const stepperBusy: boolean[] = [];
+let commandCounter = 0;
+let measuring = false;
+
+// Parse command line options
+function parseOptions(argv: string[]): Options {
+  const options: Options = {
+    url: null,
+    native: null,
+    clients: 4,
+    durationS: 30,
+    rate: 20,
+    mix: { slider: 6, sequence: 3, config: 1 },
+    burst: 5,
+    latencyMs: 0,
+    jitterMs: 0,
+    loss: 0,
+    steppers: 2,
+    stepperPins: [
+      [12, 13],
+      [14, 15],
+      [16, 17],
+      [18, 19],
+    ],
+    servoPin: 21,
+    configure: true,
+    timeoutMs: 5000,
+    jsonPath: null,
+    maxAckP99Ms: null,
+  };
+
+  for (let i = 0; i < argv.length; i++) {
+    const arg = argv[i];
+    const value = () => {
+      if (i + 1 >= argv.length) throw new Error(`Missing value for ${arg}`);
+      return argv[++i];
+    };
+    switch (arg) {
+      case "--url":
+        options.url = value();
+        break;
+      case "--native":
+        options.native = value();
+        break;
+      case "--clients":
+        options.clients = parseInt(value(), 10);
+        break;
+      case "--duration":
+        options.durationS = parseFloat(value());
+        break;
+      case "--rate":
+        options.rate = parseFloat(value());
+        break;
+      case "--mix":
+        options.mix = { slider: 0, sequence: 0, config: 0 };
+        for (const part of value().split(",")) {
+          const [key, weight] = part.split("=");
+          if (!(key in options.mix)) throw new Error(`Unknown mix '${key}'`);
+          options.mix[key as keyof Options["mix"]] = parseFloat(weight ?? "1");
+        }
+        break;
+      case "--burst":
+        options.burst = parseInt(value(), 10);
+        break;
+      case "--latency":
+        options.latencyMs = parseFloat(value());
+        break;
+      case "--jitter":
+        options.jitterMs = parseFloat(value());
+        break;
+      case "--loss":
+        options.loss = parseFloat(value());
+        break;
+      case "--steppers":
+        options.steppers = parseInt(value(), 10);
+        break;
+      case "--stepper-pins":
+        options.stepperPins = value()
+          .split(";")
+          .map((pair) => pair.split(",").map(Number) as [number, number]);
+        break;
+      case "--servo-pin":
+        options.servoPin = parseInt(value(), 10);
+        break;
+      case "--no-configure":
+        options.configure = false;
+        break;
+      case "--timeout":
+        options.timeoutMs = parseFloat(value());
+        break;
+      case "--json":
+        options.jsonPath = value();
+        break;
+      case "--max-ack-p99":
+        options.maxAckP99Ms = parseFloat(value());
+        break;
+      case "--help":
+        console.log(USAGE);
+        process.exit(0);
+      default:
+        throw new Error(`Unknown option ${arg}`);
+    }
+  }
+
+  if (options.configure && options.steppers > options.stepperPins.length) {
+    throw new Error(
+      `--steppers ${options.steppers} needs as many --stepper-pins pairs`
+    );
+  }
+  if (!options.url && !options.native) {
+    // Same file the IP finder writes in development
+    const ipFilePath = path.join(process.cwd(), ".ip_address");
+    if (!fs.existsSync(ipFilePath)) {
+      throw new Error("No --url or --native given and no .ip_address file");
+    }
+    const ip = fs.readFileSync(ipFilePath, "utf8").trim();
+    if (ip.startsWith("ERROR")) throw new Error(`.ip_address holds '${ip}'`);
+    options.url = `ws://${ip}/ws`;
+  }
+  return options;
+}
+
+// --- Transports ---
+
+// Open one WebSocket connection to a board
+function connectWebSocket(url: string): Promise<LoadConnection> {
+  return new Promise((resolve, reject) => {
+    const socket = new WebSocket(url);
+    const connection: LoadConnection = {
+      send: (text) => {
+        if (socket.readyState === WebSocket.OPEN) socket.send(text);
+      },
+      close: () => socket.close(),
+      onMessage: null,
+    };
+    socket.on("open", () => resolve(connection));
+    socket.on("error", (err) => reject(err));
+    socket.on("message", (data, isBinary) => {
+      // Binary frames (trace dumps, pin streams) only count as traffic
+      const text = isBinary ? "" : data.toString();
+      if (isBinary) stats.receivedBytes += (data as Buffer).length;
+      if (connection.onMessage) connection.onMessage(text);
+    });
+    socket.on("close", () => {
+      if (measuring) stats.disconnects++;
+    });
+  });
+}
+
+// Drives the native simulator: every client is an "IN <id>" line prefix on
+// its stdin, and virtual time follows the wall clock
+class NativeLink {
+  private child: ChildProcessWithoutNullStreams;
+  private connections = new Map<number, LoadConnection>();
+  private clock: NodeJS.Timeout;
+  private lastAdvance = Date.now();
+
+  constructor(program: string, clientCount: number) {
+    this.child = spawn(program, [], { stdio: ["pipe", "pipe", "inherit"] });
+    this.child.on("error", (err) => {
+      console.error(`[WS Load] Failed to start ${program}:`, err.message);
+      process.exit(1);
+    });
+    this.child.on("exit", (code) => {
+      if (measuring) {
+        console.error(`[WS Load] Native simulator exited with code ${code}`);
+        stats.disconnects += this.connections.size;
+      }
+    });
+
+    readline
+      .createInterface({ input: this.child.stdout })
+      .on("line", (line) => this.handleLine(line));
+
+    this.write(JSON.stringify({ sim: "clients", count: clientCount }));
+    this.clock = setInterval(() => this.advance(), 5);
+  }
+
+  connect(clientId: number): LoadConnection {
+    const connection: LoadConnection = {
+      send: (text) => this.write(`IN ${clientId} ${text}`),
+      close: () => this.connections.delete(clientId),
+      onMessage: null,
+    };
+    this.connections.set(clientId, connection);
+    return connection;
+  }
+
+  close() {
+    clearInterval(this.clock);
+    this.child.stdin.end();
+  }
+
+  private write(line: string) {
+    if (this.child.stdin.writable) this.child.stdin.write(line + "\n");
+  }
+
+  // Run the control tick for the wall time since the last advance
+  private advance() {
+    const now = Date.now();
+    const elapsed = now - this.lastAdvance;
+    if (elapsed <= 0) return;
+    this.lastAdvance = now;
+    this.write(JSON.stringify({ sim: "advance", ms: elapsed }));
+  }
+
+  // "OUT <clientId> <message>"; client 0 is a broadcast
+  private handleLine(line: string) {
+    const match = /^OUT (\d+) (.*)$/.exec(line);
+    if (!match) return; // Firmware logging
+    const clientId = parseInt(match[1], 10);
+    if (clientId === 0) {
+      this.connections.forEach((connection) => {
+        if (connection.onMessage) connection.onMessage(match[2]);
+      });
+    } else {
+      const connection = this.connections.get(clientId);
+      if (connection && connection.onMessage) connection.onMessage(match[2]);
+    }
+  }
+}
+
+// --- Link Emulation ---
+
+// Delay before a frame is delivered, never earlier than the previous frame
+// in the same direction so the stream stays ordered like TCP
+function deliveryTime(options: Options, previous: number): number {
+  const delay = options.latencyMs + Math.random() * options.jitterMs;
+  return Math.max(previous, Date.now() + delay);
+}
+
+function runAt(time: number, fn: () => void) {
+  const wait = time - Date.now();
+  if (wait <= 0) fn();
+  else setTimeout(fn, wait);
+}
+
+// Send a command, recording it for ack matching unless the emulated link
+// drops it
+function sendCommand(
+  options: Options,
+  client: LoadClient,
+  kind: CommandKind,
+  message: object
+) {
+  if (measuring || kind === "setup") stats.sent[kind]++;
+  if (kind !== "setup" && Math.random() < options.loss) {
+    stats.injectedDrops++;
+    return false;
+  }
+  const text = JSON.stringify(message);
+  client.pendingAcks.push({ kind, sentAt: Date.now() });
+  client.lastOutboundAt = deliveryTime(options, client.lastOutboundAt);
+  runAt(client.lastOutboundAt, () => client.connection.send(text));
+  return true;
+}
+
+// --- Reply Matching ---
+
+// Replies to the sender are plain "OK:"/"ERROR:" strings or JSON with a
+// status field and come back in command order; everything else is a
+// broadcast
+function handleMessage(options: Options, client: LoadClient, text: string) {
+  stats.received++;
+  stats.receivedBytes += Buffer.byteLength(text);
+  const now = Date.now();
+
+  let json: any = null;
+  if (text.startsWith("{")) {
+    try {
+      json = JSON.parse(text);
+    } catch {
+      json = null;
+    }
+  }
+
+  if (json && json.type === "actionComplete") {
+    const pending = pendingCompletions.get(json.commandId);
+    // Broadcast to every client; count it once, on the one that sent it.
+    // Completions for superseded or unknown commandIds are dropped.
+    if (!pending || pending.client !== client) return;
+    if (json.componentId !== stepperId(pending.stepperIndex)) return;
+    pendingCompletions.delete(json.commandId);
+    finishSequence(pending);
+    stats.completed++;
+    if (!json.success) stats.completionFailures++;
+    stats.completionLatency.push(now - pending.sentAt);
+    return;
+  }
+
+  const isReply =
+    text.startsWith("OK") ||
+    text.startsWith("ERROR") ||
+    (json !== null && json.status !== undefined && json.type === undefined);
+  if (!isReply) return;
+
+  expireAcks(options, client, now);
+  const pending = client.pendingAcks.shift();
+  if (!pending) return; // Reply to a command that already timed out
+  if (pending.kind !== "setup" && !measuring) return;
+  if (pending.kind !== "setup") stats.acked++;
+  if (text.startsWith("ERROR") || (json && json.status === "ERROR")) {
+    stats.ackErrors++;
+    if (pending.kind === "setup") {
+      console.error(`[WS Load] Setup failed: ${text}`);
+    }
+  }
+  stats.ackLatency[pending.kind].push(now - pending.sentAt);
+}
+
+// Drop acks that are past the timeout so a lost reply cannot shift the
+// matching of every later one
+function expireAcks(options: Options, client: LoadClient, now: number) {
+  while (
+    client.pendingAcks.length > 0 &&
+    now - client.pendingAcks[0].sentAt > options.timeoutMs
+  ) {
+    client.pendingAcks.shift();
+    if (measuring) stats.ackTimeouts++;
+  }
+}
+
+function expireCompletions(options: Options, now: number) {
+  pendingCompletions.forEach((pending, commandId) => {
+    if (now - pending.sentAt <= options.timeoutMs) return;
+    pendingCompletions.delete(commandId);
+    finishSequence(pending);
+    stats.completionTimeouts++;
+  });
+}
+
+// A slider move to a stepper replaces the move it is running, but the
+// firmware keeps reporting the earlier commandId, so the actionComplete that
+// arrives belongs to the slider move. Stop waiting for the superseded one.
+function supersedeCompletion(stepperIndex: number) {
+  pendingCompletions.forEach((pending, commandId) => {
+    if (pending.stepperIndex !== stepperIndex) return;
+    pendingCompletions.delete(commandId);
+    finishSequence(pending);
+    if (measuring) stats.completionsSuperseded++;
+  });
+}
+
+function finishSequence(pending: PendingCompletion) {
+  pending.client.sequenceInFlight = false;
+  stepperBusy[pending.stepperIndex] = false;
+}
+
+// --- Command Mixes ---
+
+function stepperId(index: number) {
+  return `load-stepper-${index}`;
+}
+
+// Slider drag: a servo angle or stepper position with no commandId
+function sendSlider(options: Options, client: LoadClient) {
+  if (Math.random() < 0.5) {
+    sendCommand(options, client, "slider", {
+      action: "control",
+      componentGroup: "servos",
+      id: "load-servo",
+      command: "move",
+      angle: Math.floor(Math.random() * 181),
+    });
+  } else {
+    const stepperIndex = client.index % options.steppers;
+    const sent = sendCommand(options, client, "slider", {
+      action: "control",
+      componentGroup: "steppers",
+      id: stepperId(stepperIndex),
+      command: "move",
+      value: Math.floor(Math.random() * 4000) - 2000,
+    });
+    if (sent) supersedeCompletion(stepperIndex);
+  }
+}
+
+// Sequence step: a tracked stepper move, one in flight per stepper so
+// commandIds are not overwritten; returns false when every stepper is busy
+function sendSequenceStep(options: Options, client: LoadClient) {
+  if (client.sequenceInFlight) return false;
+  const stepperIndex = stepperBusy.findIndex((busy) => !busy);
+  if (stepperIndex < 0) return false;
+
+  const commandId = `load-${client.index}-${++commandCounter}`;
+  const sent = sendCommand(options, client, "sequence", {
+    action: "control",
+    componentGroup: "steppers",
+    id: stepperId(stepperIndex),
+    command: "move",
+    value: Math.floor(Math.random() * 2000) - 1000,
+    commandId,
+  });
+  if (!sent) return true;
+
+  client.sequenceInFlight = true;
+  stepperBusy[stepperIndex] = true;
+  pendingCompletions.set(commandId, {
+    client,
+    stepperIndex,
+    sentAt: Date.now(),
+  });
+  return true;
+}
+
+// Configuration burst: back-to-back parameter updates, as a settings page
+// sends when it is saved
+function sendConfigBurst(options: Options, client: LoadClient) {
+  for (let i = 0; i < options.burst; i++) {
+    sendCommand(options, client, "config", {
+      action: "control",
+      componentGroup: "steppers",
+      id: stepperId((client.index + i) % options.steppers),
+      command: "setParams",
+      speed: 4000,
+      acceleration: 8000,
+    });
+  }
+}
+
+function pickKind(options: Options): keyof Options["mix"] {
+  const total = options.mix.slider + options.mix.sequence + options.mix.config;
+  let roll = Math.random() * total;
+  for (const kind of ["slider", "sequence", "config"] as const) {
+    roll -= options.mix[kind];
+    if (roll < 0) return kind;
+  }
+  return "slider";
+}
+
+function tickClient(options: Options, client: LoadClient) {
+  const kind = pickKind(options);
+  if (kind === "sequence" && sendSequenceStep(options, client)) return;
+  if (kind === "config") sendConfigBurst(options, client);
+  else sendSlider(options, client);
+}
+
+// Configure the load steppers and servo from the first client and wait for
+// their replies
+async function configureComponents(options: Options, client: LoadClient) {
+  for (let k = 0; k < options.steppers; k++) {
+    const [pulPin, dirPin] = options.stepperPins[k];
+    sendCommand(options, client, "setup", {
+      action: "configure",
+      componentGroup: "steppers",
+      config: {
+        id: stepperId(k),
+        name: `Load Stepper ${k}`,
+        pulPin,
+        dirPin,
+        maxSpeed: 4000,
+        acceleration: 8000,
+        minPosition: -5000,
+        maxPosition: 5000,
+      },
+    });
+  }
+  sendCommand(options, client, "setup", {
+    action: "configure",
+    componentGroup: "servos",
+    config: { id: "load-servo", name: "Load Servo", pin: options.servoPin },
+  });
+
+  const deadline = Date.now() + options.timeoutMs;
+  while (client.pendingAcks.length > 0 && Date.now() < deadline) {
+    await new Promise((resolve) => setTimeout(resolve, 20));
+  }
+  if (client.pendingAcks.length > 0) {
+    throw new Error("Timed out configuring the load components");
+  }
+}
+
+// Ask a board for its queue drop counters (the native runner has no system
+// group)
+function requestFirmwareStats(client: LoadClient): Promise<any> {
+  return new Promise((resolve) => {
+    const timer = setTimeout(() => resolve(null), 2000);
+    const previous = client.connection.onMessage;
+    client.connection.onMessage = (text) => {
+      if (text.includes('"action":"stats"')) {
+        clearTimeout(timer);
+        client.connection.onMessage = previous;
+        resolve(JSON.parse(text));
+      }
+    };
+    client.connection.send(
+      JSON.stringify({ action: "stats", componentGroup: "system" })
+    );
+  });
+}
+
+// --- Report ---
+
+function percentiles(samples: number[]) {
+  if (samples.length === 0) return null;
+  const sorted = [...samples].sort((a, b) => a - b);
+  const at = (p: number) =>
+    sorted[Math.min(sorted.length - 1, Math.ceil(p * sorted.length) - 1)];
+  return {
+    count: sorted.length,
+    p50: at(0.5),
+    p90: at(0.9),
+    p99: at(0.99),
+    max: sorted[sorted.length - 1],
+  };
+}
+
+function formatRow(label: string, summary: ReturnType<typeof percentiles>) {
+  if (!summary) return `  ${label.padEnd(16)} no samples`;
+  return (
+    `  ${label.padEnd(16)} n=${String(summary.count).padEnd(7)}` +
+    ` p50=${summary.p50}ms p90=${summary.p90}ms` +
+    ` p99=${summary.p99}ms max=${summary.max}ms`
+  );
+}
+
+async function main() {
+  let options: Options;
+  try {
+    options = parseOptions(process.argv.slice(2));
+  } catch (err) {
+    console.error(`[WS Load] ${(err as Error).message}\n\n${USAGE}`);
+    process.exit(2);
+  }
+
+  const target = options.native ? `native:${options.native}` : options.url;
+  console.log(
+    `[WS Load] ${options.clients} clients -> ${target}, ${options.rate} cmd/s each for ${options.durationS}s`
+  );
+
+  const link = options.native
+    ? new NativeLink(options.native, options.clients)
+    : null;
+  const clients: LoadClient[] = [];
+  for (let i = 0; i < options.clients; i++) {
+    let connection: LoadConnection;
+    try {
+      connection = link
+        ? link.connect(i + 1)
+        : await connectWebSocket(options.url);
+    } catch (err) {
+      stats.connectFailures++;
+      console.error(
+        `[WS Load] Client ${i} failed to connect:`,
+        (err as Error).message
+      );
+      continue;
+    }
+    const client: LoadClient = {
+      index: i,
+      connection,
+      pendingAcks: [],
+      sequenceInFlight: false,
+      lastOutboundAt: 0,
+      lastInboundAt: 0,
+    };
+    connection.onMessage = (text) => {
+      client.lastInboundAt = deliveryTime(options, client.lastInboundAt);
+      runAt(client.lastInboundAt, () => handleMessage(options, client, text));
+    };
+    clients.push(client);
+  }
+  if (clients.length === 0) {
+    console.error("[WS Load] No clients connected");
+    process.exit(1);
+  }
+
+  for (let k = 0; k < options.steppers; k++) stepperBusy.push(false);
+  if (options.configure) await configureComponents(options, clients[0]);
+
+  // Open loop: each client sends at its rate whatever the firmware does
+  measuring = true;
+  const startedAt = Date.now();
+  const periodMs = 1000 / options.rate;
+  const timers = clients.map((client) =>
+    setInterval(() => tickClient(options, client), periodMs)
+  );
+  const housekeeping = setInterval(() => {
+    const now = Date.now();
+    clients.forEach((client) => expireAcks(options, client, now));
+    expireCompletions(options, now);
+  }, 100);
+
+  await new Promise((resolve) => setTimeout(resolve, options.durationS * 1000));
+  timers.forEach(clearInterval);
+
+  // Let replies to the last commands arrive before counting
+  const drainUntil = Date.now() + options.timeoutMs;
+  while (
+    Date.now() < drainUntil &&
+    (pendingCompletions.size > 0 ||
+      clients.some((client) => client.pendingAcks.length > 0))
+  ) {
+    await new Promise((resolve) => setTimeout(resolve, 50));
+  }
+  const elapsedS = (Date.now() - startedAt) / 1000;
+  clearInterval(housekeeping);
+  clients.forEach((client) => expireAcks(options, client, Infinity));
+  expireCompletions(options, Infinity);
+  measuring = false;
+
+  const firmware = link ? null : await requestFirmwareStats(clients[0]);
+  clients.forEach((client) => client.connection.close());
+  if (link) link.close();
+
+  const sentTotal = stats.sent.slider + stats.sent.sequence + stats.sent.config;
+  const report = {
+    target,
+    clients: clients.length,
+    connectFailures: stats.connectFailures,
+    disconnects: stats.disconnects,
+    durationS: elapsedS,
+    options: {
+      rate: options.rate,
+      mix: options.mix,
+      burst: options.burst,
+      latencyMs: options.latencyMs,
+      jitterMs: options.jitterMs,
+      loss: options.loss,
+    },
+    sent: { ...stats.sent, total: sentTotal },
+    throughput: {
+      commandsPerS: sentTotal / elapsedS,
+      acksPerS: stats.acked / elapsedS,
+      messagesInPerS: stats.received / elapsedS,
+      bytesInPerS: stats.receivedBytes / elapsedS,
+    },
+    drops: {
+      injected: stats.injectedDrops,
+      ackTimeouts: stats.ackTimeouts,
+      completionTimeouts: stats.completionTimeouts,
+      completionsSuperseded: stats.completionsSuperseded,
+      firmwareInbound: firmware?.queues?.inboundDropped ?? null,
+      firmwareOutbound: firmware?.queues?.outboundDropped ?? null,
+    },
+    errors: {
+      ackErrors: stats.ackErrors,
+      completionFailures: stats.completionFailures,
+    },
+    ackLatencyMs: {
+      slider: percentiles(stats.ackLatency.slider),
+      sequence: percentiles(stats.ackLatency.sequence),
+      config: percentiles(stats.ackLatency.config),
+      all: percentiles([
+        ...stats.ackLatency.slider,
+        ...stats.ackLatency.sequence,
+        ...stats.ackLatency.config,
+      ]),
+    },
+    completionLatencyMs: percentiles(stats.completionLatency),
+  };
+
+  console.log(`\n[WS Load] Results over ${elapsedS.toFixed(1)}s`);
+  console.log(
+    `  sent ${sentTotal} (slider ${stats.sent.slider}, sequence ${stats.sent.sequence}, config ${stats.sent.config}),` +
+      ` ${report.throughput.commandsPerS.toFixed(1)} cmd/s`
+  );
+  console.log(
+    `  received ${stats.received} messages, ${(
+      report.throughput.bytesInPerS / 1024
+    ).toFixed(1)} KiB/s`
+  );
+  console.log(
+    `  drops: injected ${stats.injectedDrops}, ack timeouts ${stats.ackTimeouts},` +
+      ` completion timeouts ${stats.completionTimeouts},` +
+      ` superseded ${stats.completionsSuperseded}` +
+      (firmware
+        ? `, firmware inbound ${report.drops.firmwareInbound} outbound ${report.drops.firmwareOutbound}`
+        : "")
+  );
+  console.log(
+    `  errors: ack ${stats.ackErrors}, failed completions ${stats.completionFailures},` +
+      ` disconnects ${stats.disconnects}`
+  );
+  console.log("Ack latency:");
+  console.log(formatRow("slider", report.ackLatencyMs.slider));
+  console.log(formatRow("sequence", report.ackLatencyMs.sequence));
+  console.log(formatRow("config", report.ackLatencyMs.config));
+  console.log(formatRow("all", report.ackLatencyMs.all));
+  console.log("actionComplete latency:");
+  console.log(formatRow("sequence", report.completionLatencyMs));
+
+  if (options.jsonPath) {
+    fs.writeFileSync(options.jsonPath, JSON.stringify(report, null, 2));
+    console.log(`[WS Load] Report written to ${options.jsonPath}`);
+  }
+
+  const ackP99 = report.ackLatencyMs.all?.p99 ?? Infinity;
+  if (options.maxAckP99Ms !== null && ackP99 > options.maxAckP99Ms) {
+    console.error(
+      `[WS Load] Ack p99 ${ackP99}ms is above --max-ack-p99 ${options.maxAckP99Ms}ms`
+    );
+    process.exit(1);
+  }
+  process.exit(0);
+}
+
+main();